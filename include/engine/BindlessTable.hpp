@@ -0,0 +1,131 @@
+#pragma once
+
+#include "engine/LogicalDevice.hpp"
+
+// libs
+#include <vulkan/vulkan.h>
+
+// std
+#include <vector>
+#include <deque>
+#include <mutex>
+
+namespace vk_engine{
+	/**
+	 * @brief a global array of combined image samplers indexed by the shaders, see res/shaders/bindless.glsl.
+	 * the images register themselves and keep the same index until their destruction, the set is bound once per frame
+	 * and updated while bound (descriptor indexing, vulkan 1.2)
+	 */
+	class BindlessTable{
+		public:
+			static constexpr uint32_t INVALID_INDEX = ~0U;
+
+			BindlessTable(LogicalDevice &device);
+			~BindlessTable();
+
+			// avoid copy
+			BindlessTable(const BindlessTable &) = delete;
+			BindlessTable &operator=(const BindlessTable &) = delete;
+
+			/**
+			 * @brief require the descriptor indexing features if the physical device support them, must be called before the build of the logical device
+			 */
+			void require();
+
+			/**
+			 * @brief set the count of descriptors of the table, limited by the device
+			 * @param capacity the max count of images
+			 */
+			void setCapacity(uint32_t capacity) noexcept {this->capacity = capacity;}
+
+			/**
+			 * @brief set the count of frames in flight, a removed index is reused once the frames using it are finished
+			 * @param count the count of frames in flight
+			 */
+			void setFramesInFlight(uint32_t count) noexcept {framesInFlight = count;}
+
+			/**
+			 * @brief create the layout, the pool and the set if the features are enabled, see isSupported. Must be called after the build of the logical device
+			 */
+			void build();
+
+			/**
+			 * @brief get if the descriptor indexing features used by the table are enabled, the table can only be used if true. Valid after the build
+			 */
+			bool isSupported() const noexcept {return supported;}
+
+			/**
+			 * @brief add an image to the table, the table must be supported
+			 * @param info the sampler, view and layout of the image
+			 * @return uint32_t the index of the image in the table
+			 */
+			uint32_t add(const VkDescriptorImageInfo &info);
+
+			/**
+			 * @brief replace the image at the given index
+			 * @param index an index returned by add
+			 * @param info the sampler, view and layout of the image
+			 */
+			void update(uint32_t index, const VkDescriptorImageInfo &info);
+
+			/**
+			 * @brief remove an image from the table, the index is reused after the frames in flight
+			 * @param index an index returned by add
+			 */
+			void remove(uint32_t index);
+
+			/**
+			 * @brief advance the frame counter used to reuse the removed indices, call once per frame
+			 */
+			void beginFrame();
+
+			/**
+			 * @brief bind the table
+			 * 
+			 * @param commandBuffer the command buffer
+			 * @param layout a pipeline layout using getLayout() at the given set
+			 * @param set the index of the set in the pipeline layout
+			 * @param bindPoint the bind point of the pipeline
+			 */
+			void bind(VkCommandBuffer commandBuffer, VkPipelineLayout layout, uint32_t set, VkPipelineBindPoint bindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS) const noexcept;
+
+			/**
+			 * @brief get the layout of the table, to use in the pipeline layouts
+			 * @return VkDescriptorSetLayout 
+			 */
+			VkDescriptorSetLayout getLayout() const noexcept {return layout;}
+
+			/**
+			 * @brief get the descriptor set of the table
+			 * @return VkDescriptorSet 
+			 */
+			VkDescriptorSet getSet() const noexcept {return set;}
+
+			/**
+			 * @brief get the count of descriptors of the table
+			 * @return uint32_t 
+			 */
+			uint32_t getCapacity() const noexcept {return capacity;}
+
+		private:
+			struct RemovedIndex{
+				uint32_t index;
+				uint64_t frame;
+			};
+
+			LogicalDevice &device;
+
+			VkDescriptorSetLayout layout = VK_NULL_HANDLE;
+			VkDescriptorPool pool = VK_NULL_HANDLE;
+			VkDescriptorSet set = VK_NULL_HANDLE;
+
+			uint32_t capacity = 16384;
+			uint32_t framesInFlight = 2;
+			bool supported = false;
+
+			uint32_t nextIndex = 0;
+			uint64_t frame = 0;
+			std::deque<RemovedIndex> removedIndices;
+			std::mutex mutex;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,247 @@
+#pragma once
+
+#include "engine/ThreadPool.hpp"
+#include "engine/Frustum.hpp"
+
+// libs
+#include <glm/vec3.hpp>
+
+// std
+#include <vector>
+#include <cstdint>
+#include <cfloat>
+#include <cassert>
+#include <atomic>
+
+namespace vk_engine{
+	/**
+	 * @brief a tree of axis aligned boxes over the boxes of the objects, queried by frustum, by ray for the picking and by box.
+	 * The tree is built with the surface area heuristic on binned centroids and stored in a flat array, the children of a node
+	 * are consecutive. The moved objects are refitted, only their branches when they are few, and the tree is rebuilt when the
+	 * refits made it too costly. The build and the full refits are split on the workers of the thread pool, which must not be
+	 * the caller. The queries are const and can run on several threads at once
+	 */
+	class BoundingVolumeHierarchy{
+		public:
+			static constexpr uint32_t NO_OBJECT = ~0U;
+			static constexpr uint32_t MAX_BINS = 32;
+
+			struct Node{
+				glm::vec3 min;
+
+				// the index of the left child, the right one follows, or the first object of a leaf in the sorted objects
+				uint32_t first;
+				glm::vec3 max;
+
+				// the count of objects of a leaf, 0 for an inner node
+				uint32_t count;
+			};
+
+			struct Hit{
+				uint32_t object = NO_OBJECT;
+				float distance = FLT_MAX;
+			};
+
+			BoundingVolumeHierarchy() = default;
+
+			// avoid copy
+			BoundingVolumeHierarchy(const BoundingVolumeHierarchy &) = delete;
+			BoundingVolumeHierarchy &operator=(const BoundingVolumeHierarchy &) = delete;
+
+			/**
+			 * @brief split the build and the refits on the workers of the thread pool
+			 * @param threadPool the thread pool, must outlive the tree
+			 */
+			void setThreadPool(ThreadPool &threadPool) noexcept {this->threadPool = &threadPool;}
+
+			/**
+			 * @brief set the count of objects below which a node is always a leaf
+			 * @param size the count of objects, at least 1
+			 */
+			void setLeafSize(uint32_t size) noexcept {
+				assert(size > 0 && "the leaves need at least an object");
+				leafSize = size;
+			}
+
+			/**
+			 * @brief set the count of bins along each axis tested for the split of a node
+			 * @param count the count of bins, in [2, MAX_BINS]
+			 */
+			void setBinCount(uint32_t count) noexcept {
+				assert(count >= 2 && count <= MAX_BINS && "invalid bin count");
+				binCount = count;
+			}
+
+			/**
+			 * @brief set how much the cost of the tree can grow with the refits before update rebuilds it
+			 * @param ratio the maximum cost over the cost of the build
+			 */
+			void setRebuildRatio(float ratio) noexcept {rebuildRatio = ratio;}
+
+			/**
+			 * @brief reserve the arrays for the given count of objects
+			 * @param count the count of objects
+			 */
+			void reserve(uint32_t count);
+
+			/**
+			 * @brief add an object, the tree must be built again before it can be found
+			 *
+			 * @param min the minimum corner of the box of the object
+			 * @param max the maximum corner of the box of the object
+			 * @return uint32_t the index of the object
+			 */
+			uint32_t add(const glm::vec3 &min, const glm::vec3 &max);
+
+			/**
+			 * @brief move an object, the tree must be refitted before the queries find it at its new place
+			 *
+			 * @param object the index of the object
+			 * @param min the minimum corner of the box of the object
+			 * @param max the maximum corner of the box of the object
+			 */
+			void set(uint32_t object, const glm::vec3 &min, const glm::vec3 &max);
+
+			/**
+			 * @brief remove all the objects and the nodes
+			 */
+			void clear() noexcept;
+
+			/**
+			 * @brief build the tree from all the objects
+			 */
+			void build();
+
+			/**
+			 * @brief fit the boxes of the nodes to the moved objects, without changing the tree
+			 */
+			void refit();
+
+			/**
+			 * @brief build the tree if objects were added or if the refits made it too costly, refit it otherwise
+			 */
+			void update();
+
+			/**
+			 * @brief find the objects whose box is at least partially inside the frustum
+			 *
+			 * @param frustum the frustum
+			 * @param found the indices of the found objects, cleared first, in no particular order
+			 */
+			void cull(const Frustum &frustum, std::vector<uint32_t> &found) const;
+
+			/**
+			 * @brief find the objects whose box overlaps the given box
+			 *
+			 * @param min the minimum corner of the box
+			 * @param max the maximum corner of the box
+			 * @param found the indices of the found objects, cleared first, in no particular order
+			 */
+			void overlap(const glm::vec3 &min, const glm::vec3 &max, std::vector<uint32_t> &found) const;
+
+			/**
+			 * @brief find the nearest object whose box is hit by a ray, the box of an object containing the origin is hit at 0
+			 *
+			 * @param origin the origin of the ray
+			 * @param direction the direction of the ray, its length is the unit of the distances
+			 * @param maxDistance the distance beyond which the boxes are ignored
+			 * @return Hit the object and the distance of the hit, NO_OBJECT if none is hit
+			 */
+			Hit raycast(const glm::vec3 &origin, const glm::vec3 &direction, float maxDistance = FLT_MAX) const;
+
+			/**
+			 * @brief get the count of objects
+			 * @return uint32_t
+			 */
+			uint32_t size() const noexcept {return static_cast<uint32_t>(objects.size());}
+
+			/**
+			 * @brief get the nodes, the root is the first one
+			 * @return const std::vector<Node>&
+			 */
+			const std::vector<Node> &getNodes() const noexcept {return nodes;}
+
+			/**
+			 * @brief get the cost of the tree, the expected count of nodes visited and objects tested by a query
+			 * @return float
+			 */
+			float getCost() const noexcept;
+
+			/**
+			 * @brief get the cost of the tree after its last build
+			 * @return float
+			 */
+			float getBuildCost() const noexcept {return buildCost;}
+
+		private:
+			static constexpr uint32_t NO_NODE = ~0U;
+
+			// the nodes above the subtrees are split one after the other, the subtrees are built by the workers
+			static constexpr uint32_t MIN_SUBTREE_SIZE = 1024;
+
+			// the count of objects binned on a single thread
+			static constexpr uint32_t CHUNK_SIZE = 16384;
+
+			// the refit is limited to the branches of the moved objects when they are at most one in BRANCH_REFIT_RATIO
+			static constexpr uint32_t BRANCH_REFIT_RATIO = 64;
+
+			struct Box{
+				glm::vec3 min;
+				glm::vec3 max;
+			};
+
+			struct Reference{
+				Box box;
+				glm::vec3 centroid;
+				uint32_t object;
+			};
+
+			// the references of a node, with their bounds and the bounds of their centroids
+			struct Range{
+				uint32_t node;
+				uint32_t begin;
+				uint32_t end;
+				Box bounds;
+				Box centroidBounds;
+			};
+
+			bool split(const Range &range, bool parallel, Range &left, Range &right);
+			void buildSubtree(const Range &range);
+			void makeLeaf(const Range &range) noexcept;
+			void refitNode(uint32_t node) noexcept;
+			void refitSubtree(uint32_t node) noexcept;
+			void refitBranch(uint32_t object) noexcept;
+			bool isRefitPartial() const noexcept {return movedObjects.size() <= objects.size() / BRANCH_REFIT_RATIO;}
+
+			ThreadPool *threadPool = nullptr;
+			uint32_t leafSize = 4;
+			uint32_t binCount = 16;
+			float rebuildRatio = 1.5f;
+
+			std::vector<Box> objects;
+
+			// the objects partitioned by the build, copied so the nodes are split reading contiguous memory
+			std::vector<Reference> references;
+
+			// the objects sorted by leaf with their boxes, and the slot in the sorted objects and the leaf of each object
+			std::vector<uint32_t> sortedObjects;
+			std::vector<Box> sortedBoxes;
+			std::vector<uint32_t> objectSlots;
+			std::vector<uint32_t> objectLeaves;
+
+			std::vector<Node> nodes;
+			std::vector<uint32_t> parents;
+			std::atomic<uint32_t> nodeCount{0};
+
+			// the nodes split before the subtrees, each one after its parent, and the roots of the subtrees
+			std::vector<uint32_t> upperNodes;
+			std::vector<uint32_t> subtrees;
+
+			// the objects moved since the last refit
+			std::vector<uint32_t> movedObjects;
+			std::vector<bool> moved;
+
+			bool built = false;
+			float buildCost = 0.f;
+	};
+}
\ No newline at end of file
@@ -28,6 +28,12 @@ namespace vk_engine{
 			 */
 			void setFamily(Family family) noexcept {this->family = family;}
 
+			/**
+			 * @brief get the family of the pool
+			 * @return Family
+			 */
+			Family getFamily() const noexcept {return family;}
+
 			/**
 			 * @brief set the command pool flags
 			 * @param flags the flags CommandPool::Flags or VKCommandPoolCreateFlags
@@ -39,12 +45,18 @@ namespace vk_engine{
 			 */
 			void build();
 
+			/**
+			 * @brief reset the pool, all the command buffers allocated from it return to the initial state
+			 * @param releaseResources give the memory of the pool back to the system
+			 */
+			void reset(bool releaseResources = false);
+
 			// operators
 			operator VkCommandPool() const noexcept {return commandPool;}
 		
 		private:
 			LogicalDevice &device;
-			VkCommandPool commandPool;
+			VkCommandPool commandPool = VK_NULL_HANDLE;
 
 			Family family;
 			int flags;
@@ -0,0 +1,187 @@
+#pragma once
+
+#include "engine/LogicalDevice.hpp"
+#include "engine/PipelineCache.hpp"
+#include "engine/ShaderModuleCache.hpp"
+#include "engine/PipelineLayoutCache.hpp"
+#include "engine/ShaderReflection.hpp"
+#include "engine/SpecializationConstants.hpp"
+
+// libs
+#include <vulkan/vulkan.h>
+
+// std
+#include <array>
+#include <string>
+#include <vector>
+#include <cassert>
+
+namespace vk_engine{
+	class ComputePipeline{
+		public:
+			ComputePipeline(LogicalDevice &device);
+			~ComputePipeline();
+
+			// avoid copy
+			ComputePipeline(const ComputePipeline &) = delete;
+			ComputePipeline &operator=(const ComputePipeline &) = delete;
+
+			/**
+			 * @brief set the path to the compute shader
+			 * @param filepath the path to the SPIR-V file
+			 */
+			void setShaderFile(const std::string &filepath) noexcept {this->filepath = filepath;}
+
+			/**
+			 * @brief set the layout of the pipeline
+			 * @param layout the pipeline layout
+			 */
+			void setPipelineLayout(VkPipelineLayout layout) noexcept {pipelineLayout = layout;}
+
+			/**
+			 * @brief set the layout cache used to create the pipeline layout from the reflection of the shader, only used if no layout is set
+			 * @param cache the pipeline layout cache, must outlive the build
+			 */
+			void setPipelineLayoutCache(PipelineLayoutCache &cache) noexcept {layoutCache = &cache;}
+
+			/**
+			 * @brief use the given layout for a set of the reflected layout instead of reflecting it, required by the sets with an unbounded array
+			 *
+			 * @param set the index of the set
+			 * @param layout the layout of the set, e.g. BindlessTable::getLayout(), must outlive the pipeline
+			 */
+			void setSetLayout(uint32_t set, VkDescriptorSetLayout layout){
+				if (fixedSetLayouts.size() <= set) fixedSetLayouts.resize(set + 1, VK_NULL_HANDLE);
+				fixedSetLayouts[set] = layout;
+			}
+
+			/**
+			 * @brief set the pipeline cache used on the build
+			 * @param cache the pipeline cache, must outlive the build
+			 */
+			void setPipelineCache(PipelineCache &cache) noexcept {this->cache = &cache;}
+
+			/**
+			 * @brief set the shader module cache used to load the compute shader
+			 * @param cache the shader module cache, must outlive the build
+			 */
+			void setShaderModuleCache(ShaderModuleCache &cache) noexcept {moduleCache = &cache;}
+
+			/**
+			 * @brief set the value of a specialization constant of the compute shader
+			 *
+			 * @param constantID the constant_id of the constant in the shader
+			 * @param value the value of the constant (bool, int32_t, uint32_t, float, double)
+			 */
+			template<typename T> void setSpecializationConstant(uint32_t constantID, const T &value){
+				assert(!builded && "cannot set a specialization constant of a builded pipeline");
+				constants.set(constantID, value);
+			}
+
+			/**
+			 * @brief build the pipeline
+			 */
+			void build();
+
+			/**
+			 * @brief return true if the pipeline is builded, false if not
+			 */
+			bool isBuilded() const noexcept {return builded;}
+
+			/**
+			 * @brief get the hash of the shader, the specialization constants and the layout
+			 * @return uint64_t
+			 */
+			uint64_t getHash() const noexcept;
+
+			/**
+			 * @brief get the workgroup size of the shader, with the specialization constants applied
+			 * @return std::array<uint32_t, 3>
+			 */
+			std::array<uint32_t, 3> getLocalSize() const noexcept {return localSize;}
+
+			/**
+			 * @brief get the reflection of the compute shader, available after the build
+			 * @return const ShaderReflection&
+			 */
+			const ShaderReflection &getReflection() const noexcept {return reflection;}
+
+			/**
+			 * @brief bind the pipeline to the compute bind point
+			 * @param commandBuffer the command buffer
+			 */
+			void bind(VkCommandBuffer commandBuffer);
+
+			/**
+			 * @brief dispatch enough workgroups to cover the given problem size
+			 *
+			 * @param commandBuffer the command buffer
+			 * @param width the count of invocations on the x axis
+			 * @param height the count of invocations on the y axis
+			 * @param depth the count of invocations on the z axis
+			 */
+			void dispatch(VkCommandBuffer commandBuffer, uint32_t width, uint32_t height = 1, uint32_t depth = 1);
+
+			/**
+			 * @brief dispatch the given count of workgroups
+			 *
+			 * @param commandBuffer the command buffer
+			 * @param groupCountX the count of workgroups on the x axis
+			 * @param groupCountY the count of workgroups on the y axis
+			 * @param groupCountZ the count of workgroups on the z axis
+			 */
+			void dispatchGroups(VkCommandBuffer commandBuffer, uint32_t groupCountX, uint32_t groupCountY = 1, uint32_t groupCountZ = 1);
+
+			/**
+			 * @brief dispatch with the workgroup counts read from a VkDispatchIndirectCommand
+			 *
+			 * @param commandBuffer the command buffer
+			 * @param buffer the buffer containing the command
+			 * @param offset the offset of the command in the buffer
+			 */
+			void dispatchIndirect(VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize offset = 0);
+
+			/**
+			 * @brief get the count of workgroups needed to cover the given size
+			 *
+			 * @param size the count of invocations
+			 * @param localSize the size of a workgroup
+			 * @return uint32_t
+			 */
+			static uint32_t getGroupCount(uint32_t size, uint32_t localSize) noexcept {return (size + localSize - 1) / localSize;}
+
+			/**
+			 * @brief get the vulkan pipeline
+			 * @return VkPipeline
+			 */
+			VkPipeline getPipeline() const noexcept {return pipeline;}
+
+			/**
+			 * @brief get the layout of the pipeline
+			 * @return VkPipelineLayout
+			 */
+			VkPipelineLayout getPipelineLayout() const noexcept {return pipelineLayout;}
+
+			// operators
+			operator VkPipeline() const noexcept {return pipeline;}
+
+		private:
+			void resolveLocalSize();
+
+			LogicalDevice &device;
+			PipelineCache *cache = nullptr;
+			ShaderModuleCache *moduleCache = nullptr;
+			PipelineLayoutCache *layoutCache = nullptr;
+
+			VkPipeline pipeline = VK_NULL_HANDLE;
+			VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
+
+			std::string filepath;
+			std::vector<VkDescriptorSetLayout> fixedSetLayouts;
+			SpecializationConstants constants;
+			ShaderReflection reflection;
+			std::array<uint32_t, 3> localSize = {1, 1, 1};
+
+			bool builded = false;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,171 @@
+#pragma once
+
+#include "engine/ThreadPool.hpp"
+#include "engine/Frustum.hpp"
+
+// libs
+#include <glm/mat4x4.hpp>
+#include <glm/vec4.hpp>
+
+// std
+#include <vector>
+#include <new>
+#include <cstdint>
+#include <cstddef>
+#include <cassert>
+
+namespace vk_engine{
+	/**
+	 * @brief test bounding spheres against a frustum on the cpu. The spheres are stored as structure of arrays so the planes are tested
+	 * against 4 spheres at once with SSE, or 8 with AVX, the instruction set is chosen at runtime. The arrays are split in chunks of whole
+	 * cache lines taken by the workers of the thread pool, each chunk writes its visible indices at its own offset before they are compacted
+	 */
+	class CpuCulling{
+		public:
+			enum InstructionSet{
+				INSTRUCTION_SET_SCALAR,
+				INSTRUCTION_SET_SSE,
+				INSTRUCTION_SET_AVX
+			};
+
+			// the spheres of a cache line, the arrays are padded to a multiple of it with spheres never visible
+			static constexpr uint32_t BLOCK_SIZE = 16;
+
+			// the spheres tested by a worker at once, a multiple of BLOCK_SIZE
+			static constexpr uint32_t CHUNK_SIZE = 4096;
+
+			CpuCulling();
+
+			// avoid copy
+			CpuCulling(const CpuCulling &) = delete;
+			CpuCulling &operator=(const CpuCulling &) = delete;
+
+			/**
+			 * @brief split the culling of more than a chunk of spheres on the workers of the thread pool
+			 * @param threadPool the thread pool, must outlive the culling
+			 */
+			void setThreadPool(ThreadPool &threadPool) noexcept {this->threadPool = &threadPool;}
+
+			/**
+			 * @brief set the instruction set of the tests, the best supported one is used by default
+			 * @param set the instruction set, must be supported
+			 */
+			void setInstructionSet(InstructionSet set) noexcept {
+				assert(isSupported(set) && "unsupported instruction set");
+				instructionSet = set;
+			}
+
+			/**
+			 * @brief get the instruction set of the tests
+			 * @return InstructionSet
+			 */
+			InstructionSet getInstructionSet() const noexcept {return instructionSet;}
+
+			/**
+			 * @brief get if the processor support the instruction set
+			 * @param set the instruction set
+			 */
+			static bool isSupported(InstructionSet set) noexcept;
+
+			/**
+			 * @brief reserve the arrays for the given count of spheres
+			 * @param count the count of spheres
+			 */
+			void reserve(uint32_t count);
+
+			/**
+			 * @brief add a sphere
+			 * @param sphere the center in xyz and the radius in w, the radius must be positive
+			 * @return uint32_t the index of the sphere, in the visible indices
+			 */
+			uint32_t add(const glm::vec4 &sphere);
+
+			/**
+			 * @brief change a sphere
+			 *
+			 * @param index the index of the sphere
+			 * @param sphere the center in xyz and the radius in w, the radius must be positive
+			 */
+			void set(uint32_t index, const glm::vec4 &sphere) noexcept {
+				assert(index < count && "invalid sphere index");
+				centersX[index] = sphere.x;
+				centersY[index] = sphere.y;
+				centersZ[index] = sphere.z;
+				radii[index] = sphere.w;
+			}
+
+			/**
+			 * @brief get a sphere
+			 * @param index the index of the sphere
+			 * @return glm::vec4
+			 */
+			glm::vec4 get(uint32_t index) const noexcept {
+				assert(index < count && "invalid sphere index");
+				return glm::vec4(centersX[index], centersY[index], centersZ[index], radii[index]);
+			}
+
+			/**
+			 * @brief remove all the spheres
+			 */
+			void clear() noexcept;
+
+			/**
+			 * @brief get the count of spheres
+			 * @return uint32_t
+			 */
+			uint32_t size() const noexcept {return count;}
+
+			/**
+			 * @brief find the spheres at least partially inside the frustum
+			 * @param frustum the frustum
+			 * @return const std::vector<uint32_t>& the increasing indices of the visible spheres, valid until the next cull
+			 */
+			const std::vector<uint32_t> &cull(const Frustum &frustum);
+
+			/**
+			 * @brief find the spheres at least partially inside the frustum of a view projection
+			 * @param viewProjection the view projection matrix
+			 * @return const std::vector<uint32_t>& the increasing indices of the visible spheres, valid until the next cull
+			 */
+			const std::vector<uint32_t> &cull(const glm::mat4 &viewProjection) {return cull(Frustum::fromMatrix(viewProjection));}
+
+			/**
+			 * @brief get the visible spheres of the last cull
+			 * @return const std::vector<uint32_t>&
+			 */
+			const std::vector<uint32_t> &getVisible() const noexcept {return visible;}
+
+		private:
+			// allocate on cache lines so the blocks are aligned for the vector loads
+			template<typename T> struct AlignedAllocator{
+				using value_type = T;
+
+				AlignedAllocator() noexcept = default;
+				template<typename U> AlignedAllocator(const AlignedAllocator<U> &) noexcept {}
+
+				T *allocate(size_t n) {return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(64)));}
+				void deallocate(T *p, size_t) noexcept {::operator delete(p, std::align_val_t(64));}
+
+				template<typename U> bool operator==(const AlignedAllocator<U> &) const noexcept {return true;}
+				template<typename U> bool operator!=(const AlignedAllocator<U> &) const noexcept {return false;}
+			};
+
+			using FloatArray = std::vector<float, AlignedAllocator<float>>;
+
+			uint32_t cullChunk(const Frustum &frustum, uint32_t chunk, uint32_t *output) const noexcept;
+
+			ThreadPool *threadPool = nullptr;
+			InstructionSet instructionSet = INSTRUCTION_SET_SCALAR;
+
+			uint32_t count = 0;
+			FloatArray centersX;
+			FloatArray centersY;
+			FloatArray centersZ;
+			FloatArray radii;
+
+			// the visible indices of each chunk at the offset of the chunk, before the compaction
+			std::vector<uint32_t> chunkIndices;
+			std::vector<uint32_t> chunkCounts;
+			std::vector<uint32_t> visible;
+	};
+}
\ No newline at end of file
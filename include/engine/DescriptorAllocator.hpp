@@ -0,0 +1,119 @@
+#pragma once
+
+#include "engine/LogicalDevice.hpp"
+#include "engine/DescriptorPoolFactory.hpp"
+#include "engine/DescriptorSetLayoutCache.hpp"
+
+// libs
+#include <vulkan/vulkan.h>
+
+// std
+#include <vector>
+#include <mutex>
+
+namespace vk_engine{
+	/**
+	 * @brief allocate transient descriptor sets valid for one frame. Each frame in flight has its own list of pools, a new pool is added
+	 * when the current one is full and all the pools of a frame are reset together when the frame begins again
+	 */
+	class DescriptorAllocator{
+		public:
+			using PoolSize = DescriptorPoolFactory::PoolSize;
+
+			DescriptorAllocator(LogicalDevice &device);
+			~DescriptorAllocator();
+
+			// avoid copy
+			DescriptorAllocator(const DescriptorAllocator &) = delete;
+			DescriptorAllocator &operator=(const DescriptorAllocator &) = delete;
+
+			/**
+			 * @brief set the count of frames in flight, each frame has its own pools
+			 * @param count the count of frames
+			 */
+			void setFramesInFlight(uint32_t count) noexcept {framesInFlight = count;}
+
+			/**
+			 * @brief set the count of sets of the first pool, the next pools are twice bigger until the max
+			 * @param count the count of sets of the first pool
+			 * @param maxCount the max count of sets of a pool
+			 */
+			void setSetsPerPool(uint32_t count, uint32_t maxCount = 4096) noexcept {poolFactory.setSetsPerPool(count, maxCount);}
+
+			/**
+			 * @brief set the descriptors of the pools, relatively to the count of sets
+			 * @param sizes the count of descriptors of each type for one set
+			 */
+			void setPoolSizes(const std::vector<PoolSize> &sizes) {poolFactory.setPoolSizes(sizes);}
+
+			/**
+			 * @brief create the pools with VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT, required to allocate the layouts created with
+			 * VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT. Require the descriptor indexing features, see BindlessTable::require
+			 * @param enable true to allow the update after bind layouts
+			 */
+			void setUpdateAfterBind(bool enable) noexcept {poolFactory.setFlags(enable ? VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT : 0);}
+
+			/**
+			 * @brief size a dedicated pool from the bindings of a layout when one of its sets does not fit in a new pool
+			 * @param cache the cache of the allocated layouts, must outlive the allocator
+			 */
+			void setSetLayoutCache(DescriptorSetLayoutCache &cache) noexcept {setLayoutCache = &cache;}
+
+			/**
+			 * @brief build the allocator
+			 */
+			void build();
+
+			/**
+			 * @brief reset the pools of the given frame, the sets allocated during the previous use of the frame are freed.
+			 * the fence of the frame must be signaled
+			 * 
+			 * @param frameIndex the index of the frame in flight
+			 */
+			void beginFrame(uint32_t frameIndex);
+
+			/**
+			 * @brief allocate a descriptor set for the current frame
+			 * @param layout the layout of the set
+			 * @return VkDescriptorSet valid until the next begin of the frame
+			 */
+			VkDescriptorSet allocate(VkDescriptorSetLayout layout);
+
+			/**
+			 * @brief allocate a descriptor set with a variable descriptor count for the current frame
+			 * @param layout the layout of the set, the last binding must be variable sized
+			 * @param variableCount the count of descriptors of the variable sized binding
+			 * @return VkDescriptorSet valid until the next begin of the frame
+			 */
+			VkDescriptorSet allocate(VkDescriptorSetLayout layout, uint32_t variableCount);
+
+			/**
+			 * @brief get the count of pools created
+			 * @return size_t 
+			 */
+			size_t getPoolCount() const noexcept {return poolFactory.getPoolCount();}
+
+		private:
+			struct Frame{
+				std::vector<VkDescriptorPool> pools;
+			};
+
+			VkDescriptorSet allocate(VkDescriptorSetLayout layout, const void *pNext, uint32_t variableCount);
+			VkDescriptorPool getPool();
+			VkDescriptorPool addPool();
+			VkDescriptorPool addPool(VkDescriptorSetLayout layout, uint32_t variableCount);
+
+			LogicalDevice &device;
+
+			DescriptorPoolFactory poolFactory;
+			DescriptorSetLayoutCache *setLayoutCache = nullptr;
+			uint32_t framesInFlight = 2;
+
+			std::vector<Frame> frames;
+			uint32_t currentFrame = 0;
+
+			// the reset pools, shared by the frames
+			std::vector<VkDescriptorPool> freePools;
+			std::mutex mutex;
+	};
+}
\ No newline at end of file
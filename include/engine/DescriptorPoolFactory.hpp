@@ -0,0 +1,92 @@
+#pragma once
+
+#include "engine/LogicalDevice.hpp"
+
+// libs
+#include <vulkan/vulkan.h>
+
+// std
+#include <vector>
+
+namespace vk_engine{
+	/**
+	 * @brief create the descriptor pools of the allocators, sized relatively to their count of sets. Each pool is twice bigger than
+	 * the previous one until the max. The created pools are owned by the caller
+	 */
+	class DescriptorPoolFactory{
+		public:
+			// the count of descriptors of a type for one set
+			struct PoolSize{
+				VkDescriptorType type;
+				float ratio;
+			};
+
+			/**
+			 * @brief create a factory
+			 * @param device the logical device
+			 * @param flags the flags of the created pools
+			 * @param setsPerPool the default count of sets of the first pool
+			 */
+			DescriptorPoolFactory(LogicalDevice &device, VkDescriptorPoolCreateFlags flags, uint32_t setsPerPool);
+
+			/**
+			 * @brief set the count of sets of the first pool, the next pools are twice bigger until the max
+			 * @param count the count of sets of the first pool
+			 * @param maxCount the max count of sets of a pool
+			 */
+			void setSetsPerPool(uint32_t count, uint32_t maxCount = 4096) noexcept {nextPoolSize = count; maxSetsPerPool = maxCount;}
+
+			/**
+			 * @brief set the descriptors of the pools, relatively to the count of sets
+			 * @param sizes the count of descriptors of each type for one set
+			 */
+			void setPoolSizes(const std::vector<PoolSize> &sizes) {poolSizes = sizes;}
+
+			/**
+			 * @brief set the flags of the next pools
+			 * @param flags the creation flags of the pools
+			 */
+			void setFlags(VkDescriptorPoolCreateFlags flags) noexcept {this->flags = flags;}
+
+			/**
+			 * @brief create the next pool
+			 * @return VkDescriptorPool
+			 */
+			VkDescriptorPool create();
+
+			/**
+			 * @brief create the next pool, with at least the given descriptors
+			 * @param minSizes the min count of descriptors of each type, for a set bigger than the usual pools
+			 * @return VkDescriptorPool
+			 */
+			VkDescriptorPool create(const std::vector<VkDescriptorPoolSize> &minSizes);
+
+			/**
+			 * @brief get the count of pools created
+			 * @return size_t
+			 */
+			size_t getPoolCount() const noexcept {return poolCount;}
+
+		private:
+			LogicalDevice &device;
+			VkDescriptorPoolCreateFlags flags;
+
+			uint32_t nextPoolSize;
+			uint32_t maxSetsPerPool = 4096;
+			std::vector<PoolSize> poolSizes = {
+				{VK_DESCRIPTOR_TYPE_SAMPLER, 0.5f},
+				{VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 4.f},
+				{VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, 4.f},
+				{VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1.f},
+				{VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER, 1.f},
+				{VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER, 1.f},
+				{VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 2.f},
+				{VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 2.f},
+				{VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1.f},
+				{VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, 1.f},
+				{VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT, 0.5f}
+			};
+
+			size_t poolCount = 0;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,129 @@
+#pragma once
+
+#include "engine/LogicalDevice.hpp"
+#include "engine/DescriptorPoolFactory.hpp"
+
+// libs
+#include <vulkan/vulkan.h>
+
+// std
+#include <vector>
+#include <unordered_map>
+#include <mutex>
+#include <atomic>
+
+namespace vk_engine{
+	/**
+	 * @brief cache the descriptor sets by content, the sets written with the same layout and the same resources are allocated and written once.
+	 * the sets referencing a destroyed Buffer or Image are freed from the cache
+	 */
+	class DescriptorSetCache{
+		public:
+			// a descriptor of the set
+			struct Write{
+				uint32_t binding = 0;
+				uint32_t arrayElement = 0;
+				VkDescriptorType type = VK_DESCRIPTOR_TYPE_MAX_ENUM;
+				VkDescriptorBufferInfo bufferInfo{};
+				VkDescriptorImageInfo imageInfo{};
+
+				static Write buffer(uint32_t binding, VkDescriptorType type, const VkDescriptorBufferInfo &info, uint32_t arrayElement = 0) noexcept;
+				static Write image(uint32_t binding, VkDescriptorType type, const VkDescriptorImageInfo &info, uint32_t arrayElement = 0) noexcept;
+
+				bool isImage() const noexcept;
+			};
+
+			DescriptorSetCache(LogicalDevice &device);
+			~DescriptorSetCache();
+
+			// avoid copy
+			DescriptorSetCache(const DescriptorSetCache &) = delete;
+			DescriptorSetCache &operator=(const DescriptorSetCache &) = delete;
+
+			/**
+			 * @brief set the count of sets of the first pool, the next pools are twice bigger until the max
+			 * @param count the count of sets of the first pool
+			 * @param maxCount the max count of sets of a pool
+			 */
+			void setSetsPerPool(uint32_t count, uint32_t maxCount = 4096) noexcept {poolFactory.setSetsPerPool(count, maxCount);}
+
+			/**
+			 * @brief set the descriptors of the pools, relatively to the count of sets
+			 * @param sizes the count of descriptors of each type for one set
+			 */
+			void setPoolSizes(const std::vector<DescriptorPoolFactory::PoolSize> &sizes) {poolFactory.setPoolSizes(sizes);}
+
+			/**
+			 * @brief get a descriptor set of the given layout written with the given descriptors, the set is only allocated and written
+			 * if no set with the same content is in the cache.
+			 * the set must not be updated by the caller, it is shared by all the users of the same content
+			 *
+			 * @param layout the layout of the set
+			 * @param writes the descriptors of the set
+			 * @return VkDescriptorSet valid until a resource of the set is destroyed or the cache is cleared
+			 */
+			VkDescriptorSet get(VkDescriptorSetLayout layout, std::vector<Write> writes);
+
+			/**
+			 * @brief free the sets referencing the given resource
+			 * @param handle the handle key of the resource, see LogicalDevice::getHandleKey
+			 */
+			void invalidate(uint64_t handle);
+
+			/**
+			 * @brief free all the sets of the cache, the sets must not be used by the device anymore
+			 */
+			void clear();
+
+			/**
+			 * @brief get the count of sets in the cache
+			 * @return size_t
+			 */
+			size_t size() const noexcept {return sets.size();}
+
+			/**
+			 * @brief get the count of sets written since the creation of the cache, it should not grow on the steady state frames
+			 * @return size_t
+			 */
+			size_t getUpdateCount() const noexcept {return updateCount.load(std::memory_order_relaxed);}
+
+		private:
+			struct Key{
+				VkDescriptorSetLayout layout = VK_NULL_HANDLE;
+				std::vector<Write> writes;
+
+				bool operator==(const Key &other) const noexcept;
+			};
+
+			struct KeyHash{
+				size_t operator()(const Key &key) const noexcept;
+			};
+
+			struct Entry{
+				VkDescriptorSet set = VK_NULL_HANDLE;
+				VkDescriptorPool pool = VK_NULL_HANDLE;
+				std::vector<uint64_t> resources;
+			};
+
+			static void normalize(std::vector<Write> &writes);
+			static std::vector<uint64_t> getResources(const std::vector<Write> &writes);
+
+			VkDescriptorSet allocate(VkDescriptorSetLayout layout, VkDescriptorPool &pool);
+			void write(VkDescriptorSet set, const Key &key);
+
+			LogicalDevice &device;
+			uint32_t destroyCallback;
+
+			// the sets are freed one by one when a resource is destroyed
+			DescriptorPoolFactory poolFactory;
+			std::vector<VkDescriptorPool> pools;
+
+			std::unordered_map<Key, Entry, KeyHash> sets;
+
+			// the keys of the sets referencing a resource
+			std::unordered_map<uint64_t, std::vector<const Key*>> resourceSets;
+
+			std::atomic<size_t> updateCount{0};
+			std::mutex mutex;
+	};
+}
\ No newline at end of file
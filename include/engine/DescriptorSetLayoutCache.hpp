@@ -0,0 +1,76 @@
+#pragma once
+
+#include "engine/LogicalDevice.hpp"
+
+// libs
+#include <vulkan/vulkan.h>
+
+// std
+#include <vector>
+#include <unordered_map>
+#include <mutex>
+
+namespace vk_engine{
+	class DescriptorSetLayoutCache{
+		public:
+			struct Binding{
+				uint32_t binding = 0;
+				VkDescriptorType type = VK_DESCRIPTOR_TYPE_MAX_ENUM;
+				uint32_t count = 1;
+				VkShaderStageFlags stages = 0;
+
+				// VkDescriptorBindingFlags, require the descriptor indexing features if not 0
+				VkDescriptorBindingFlags flags = 0;
+			};
+
+			DescriptorSetLayoutCache(LogicalDevice &device);
+			~DescriptorSetLayoutCache();
+
+			// avoid copy
+			DescriptorSetLayoutCache(const DescriptorSetLayoutCache &) = delete;
+			DescriptorSetLayoutCache &operator=(const DescriptorSetLayoutCache &) = delete;
+
+			/**
+			 * @brief get the descriptor set layout of the given bindings, identical bindings always return the same layout.
+			 * the bindings are sorted and the stages of duplicated bindings are merged
+			 *
+			 * @param bindings the bindings of the set
+			 * @param flags the creation flags of the layout
+			 * @return VkDescriptorSetLayout
+			 */
+			VkDescriptorSetLayout get(std::vector<Binding> bindings, VkDescriptorSetLayoutCreateFlags flags = 0);
+
+			/**
+			 * @brief get the bindings used to create the given layout
+			 * @param layout a layout created by this cache
+			 * @return const std::vector<Binding>&
+			 */
+			const std::vector<Binding> &getBindings(VkDescriptorSetLayout layout);
+
+			/**
+			 * @brief get the count of layouts in the cache
+			 * @return size_t
+			 */
+			size_t size() const noexcept {return layouts.size();}
+
+		private:
+			struct Key{
+				std::vector<Binding> bindings;
+				VkDescriptorSetLayoutCreateFlags flags = 0;
+
+				bool operator==(const Key &other) const noexcept;
+			};
+
+			struct KeyHash{
+				size_t operator()(const Key &key) const noexcept;
+			};
+
+			static void normalize(std::vector<Binding> &bindings);
+			VkDescriptorSetLayout create(const Key &key);
+
+			LogicalDevice &device;
+			std::unordered_map<Key, VkDescriptorSetLayout, KeyHash> layouts;
+			std::unordered_map<VkDescriptorSetLayout, const Key*> keys;
+			std::mutex mutex;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,104 @@
+#pragma once
+
+#include "engine/LogicalDevice.hpp"
+#include "engine/DescriptorSetLayoutCache.hpp"
+
+// libs
+#include <vulkan/vulkan.h>
+
+// std
+#include <vector>
+#include <type_traits>
+#include <cassert>
+
+namespace vk_engine{
+	/**
+	 * @brief update a descriptor set from a packed struct with a VkDescriptorUpdateTemplate, without building the VkWriteDescriptorSet arrays.
+	 * the struct contains the descriptors in binding order : a VkDescriptorBufferInfo for the buffers (Buffer::descriptorInfo), a VkDescriptorImageInfo
+	 * for the images and samplers (Image::getDescriptorInfo) and a VkBufferView for the texel buffers, an array binding takes count consecutive elements
+	 */
+	class DescriptorUpdateTemplate{
+		public:
+			DescriptorUpdateTemplate(LogicalDevice &device, DescriptorSetLayoutCache &setLayoutCache);
+			~DescriptorUpdateTemplate();
+
+			// avoid copy
+			DescriptorUpdateTemplate(const DescriptorUpdateTemplate &) = delete;
+			DescriptorUpdateTemplate &operator=(const DescriptorUpdateTemplate &) = delete;
+
+			/**
+			 * @brief require VK_KHR_descriptor_update_template if the physical device support it, must be called before the build of the logical device.
+			 * without the extension the sets are updated with vkUpdateDescriptorSets
+			 *
+			 * @param device the logical device
+			 */
+			static void require(LogicalDevice &device);
+
+			/**
+			 * @brief set the layout of the updated sets
+			 * @param layout a layout created by the set layout cache, reflected or not
+			 */
+			void setSetLayout(VkDescriptorSetLayout layout) noexcept {setLayout = layout;}
+
+			/**
+			 * @brief create the template from the bindings of the set layout
+			 */
+			void build();
+
+			/**
+			 * @brief update the given set
+			 * @param set the descriptor set, allocated with the layout of the template
+			 * @param data the packed descriptors, getDataSize() bytes
+			 */
+			void update(VkDescriptorSet set, const void *data) const;
+
+			/**
+			 * @brief update the given set from a struct
+			 * @param set the descriptor set, allocated with the layout of the template
+			 * @param data the struct of the descriptors, in binding order
+			 */
+			template<typename T> void update(VkDescriptorSet set, const T &data) const{
+				static_assert(std::is_trivially_copyable<T>::value && !std::is_pointer<T>::value, "the descriptors must be a packed struct");
+				assert(sizeof(T) == dataSize && "the struct does not match the bindings of the layout");
+				update(set, static_cast<const void*>(&data));
+			}
+
+			/**
+			 * @brief get the offset of the given binding in the packed struct
+			 * @param binding the binding
+			 * @return size_t
+			 */
+			size_t getOffset(uint32_t binding) const;
+
+			/**
+			 * @brief get the size of the packed struct
+			 * @return size_t
+			 */
+			size_t getDataSize() const noexcept {return dataSize;}
+
+			/**
+			 * @brief get if the sets are updated with a VkDescriptorUpdateTemplate, false if vkUpdateDescriptorSets is used instead
+			 */
+			bool isSupported() const noexcept {return updateTemplate != VK_NULL_HANDLE;}
+
+			/**
+			 * @brief get the size of a descriptor of the given type in the packed struct
+			 * @param type the type of the descriptor
+			 * @return size_t
+			 */
+			static size_t getDescriptorSize(VkDescriptorType type) noexcept;
+
+		private:
+			LogicalDevice &device;
+			DescriptorSetLayoutCache &setLayoutCache;
+
+			VkDescriptorSetLayout setLayout = VK_NULL_HANDLE;
+			std::vector<VkDescriptorUpdateTemplateEntry> entries;
+			size_t dataSize = 0;
+
+			VkDescriptorUpdateTemplate updateTemplate = VK_NULL_HANDLE;
+			PFN_vkCreateDescriptorUpdateTemplateKHR createDescriptorUpdateTemplate = nullptr;
+			PFN_vkDestroyDescriptorUpdateTemplateKHR destroyDescriptorUpdateTemplate = nullptr;
+			PFN_vkUpdateDescriptorSetWithTemplateKHR updateDescriptorSetWithTemplate = nullptr;
+	};
+}
\ No newline at end of file
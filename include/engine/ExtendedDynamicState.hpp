@@ -0,0 +1,83 @@
+#pragma once
+
+#include "engine/LogicalDevice.hpp"
+
+// libs
+#include <vulkan/vulkan.h>
+
+// std
+#include <vector>
+
+namespace vk_engine{
+	/**
+	 * @brief the VK_EXT_extended_dynamic_state and VK_EXT_extended_dynamic_state2 support of a device.
+	 * the extensions are optional, isSupported() tells if the states can be set in the command buffer
+	 */
+	class ExtendedDynamicState{
+		public:
+			ExtendedDynamicState(LogicalDevice &device);
+
+			// avoid copy
+			ExtendedDynamicState(const ExtendedDynamicState &) = delete;
+			ExtendedDynamicState &operator=(const ExtendedDynamicState &) = delete;
+
+			/**
+			 * @brief require the extensions and the features if the physical device support them, must be called before the build of the logical device
+			 */
+			void require();
+
+			/**
+			 * @brief load the commands of the enabled extensions, must be called after the build of the logical device
+			 */
+			void build();
+
+			/**
+			 * @brief get if VK_EXT_extended_dynamic_state is enabled (cull mode, front face, topology, depth test, depth write, depth compare op)
+			 */
+			bool isSupported() const noexcept {return supported;}
+
+			/**
+			 * @brief get if VK_EXT_extended_dynamic_state2 is enabled (depth bias enable, primitive restart enable, rasterizer discard enable)
+			 */
+			bool isSupported2() const noexcept {return supported2;}
+
+			/**
+			 * @brief get the pipeline states set in the command buffer
+			 * @return const std::vector<VkDynamicState>&
+			 */
+			const std::vector<VkDynamicState> &getDynamicStates() const noexcept {return dynamicStates;}
+
+			/**
+			 * @brief get if the given state is set in the command buffer
+			 * @param state the dynamic state
+			 */
+			bool isDynamic(VkDynamicState state) const noexcept;
+
+			void setCullMode(VkCommandBuffer commandBuffer, VkCullModeFlags cullMode) const noexcept {cmdSetCullMode(commandBuffer, cullMode);}
+			void setFrontFace(VkCommandBuffer commandBuffer, VkFrontFace frontFace) const noexcept {cmdSetFrontFace(commandBuffer, frontFace);}
+			void setPrimitiveTopology(VkCommandBuffer commandBuffer, VkPrimitiveTopology topology) const noexcept {cmdSetPrimitiveTopology(commandBuffer, topology);}
+			void setDepthTestEnable(VkCommandBuffer commandBuffer, bool enable) const noexcept {cmdSetDepthTestEnable(commandBuffer, enable ? VK_TRUE : VK_FALSE);}
+			void setDepthWriteEnable(VkCommandBuffer commandBuffer, bool enable) const noexcept {cmdSetDepthWriteEnable(commandBuffer, enable ? VK_TRUE : VK_FALSE);}
+			void setDepthCompareOp(VkCommandBuffer commandBuffer, VkCompareOp compareOp) const noexcept {cmdSetDepthCompareOp(commandBuffer, compareOp);}
+			void setDepthBiasEnable(VkCommandBuffer commandBuffer, bool enable) const noexcept {cmdSetDepthBiasEnable(commandBuffer, enable ? VK_TRUE : VK_FALSE);}
+			void setPrimitiveRestartEnable(VkCommandBuffer commandBuffer, bool enable) const noexcept {cmdSetPrimitiveRestartEnable(commandBuffer, enable ? VK_TRUE : VK_FALSE);}
+			void setRasterizerDiscardEnable(VkCommandBuffer commandBuffer, bool enable) const noexcept {cmdSetRasterizerDiscardEnable(commandBuffer, enable ? VK_TRUE : VK_FALSE);}
+
+		private:
+			LogicalDevice &device;
+
+			bool supported = false;
+			bool supported2 = false;
+			std::vector<VkDynamicState> dynamicStates;
+
+			PFN_vkCmdSetCullModeEXT cmdSetCullMode = nullptr;
+			PFN_vkCmdSetFrontFaceEXT cmdSetFrontFace = nullptr;
+			PFN_vkCmdSetPrimitiveTopologyEXT cmdSetPrimitiveTopology = nullptr;
+			PFN_vkCmdSetDepthTestEnableEXT cmdSetDepthTestEnable = nullptr;
+			PFN_vkCmdSetDepthWriteEnableEXT cmdSetDepthWriteEnable = nullptr;
+			PFN_vkCmdSetDepthCompareOpEXT cmdSetDepthCompareOp = nullptr;
+			PFN_vkCmdSetDepthBiasEnableEXT cmdSetDepthBiasEnable = nullptr;
+			PFN_vkCmdSetPrimitiveRestartEnableEXT cmdSetPrimitiveRestartEnable = nullptr;
+			PFN_vkCmdSetRasterizerDiscardEnableEXT cmdSetRasterizerDiscardEnable = nullptr;
+	};
+}
\ No newline at end of file
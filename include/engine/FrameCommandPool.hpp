@@ -0,0 +1,61 @@
+#pragma once
+
+#include "engine/LogicalDevice.hpp"
+#include "engine/CommandPool.hpp"
+
+// libs
+#include <vulkan/vulkan.h>
+
+// std
+#include <vector>
+#include <array>
+
+namespace vk_engine{
+	/**
+	 * @brief a transient command pool used by a single frame in flight, the command buffers are not reset one by one but all together with the pool.
+	 * the allocated command buffers are kept and handed out again after the reset
+	 */
+	class FrameCommandPool{
+		public:
+			FrameCommandPool(LogicalDevice &device);
+
+			// avoid copy
+			FrameCommandPool(const FrameCommandPool &) = delete;
+			FrameCommandPool &operator=(const FrameCommandPool &) = delete;
+
+			/**
+			 * @brief set the family of the pool
+			 * @param family the family
+			 */
+			void setFamily(Family family) noexcept {pool.setFamily(family);}
+
+			/**
+			 * @brief create the pool
+			 */
+			void build();
+
+			/**
+			 * @brief reset the pool, the command buffers can be handed out again. The command buffers must not be used by the device anymore
+			 */
+			void reset();
+
+			/**
+			 * @brief get a command buffer in the initial state, valid until the next reset
+			 * @param level the level of the command buffer
+			 * @return VkCommandBuffer
+			 */
+			VkCommandBuffer get(VkCommandBufferLevel level = VK_COMMAND_BUFFER_LEVEL_PRIMARY);
+
+		private:
+			struct Level{
+				std::vector<VkCommandBuffer> commandBuffers;
+				size_t used = 0;
+			};
+
+			LogicalDevice &device;
+			CommandPool pool;
+
+			// indexed by VkCommandBufferLevel
+			std::array<Level, 2> levels;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,78 @@
+#pragma once
+
+// libs
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+
+// std
+#include <cmath>
+
+namespace vk_engine{
+	/**
+	 * @brief the planes of a view projection, the normals point inside and are normalized so the distances are in world units.
+	 * the clip volume is the vulkan one, -w <= x, y <= w and 0 <= z <= w
+	 */
+	struct Frustum{
+		// left, right, bottom, top, near, far
+		glm::vec4 planes[6];
+
+		/**
+		 * @brief extract the planes of the given matrix
+		 * @param viewProjection the view projection matrix
+		 * @return Frustum
+		 */
+		static Frustum fromMatrix(const glm::mat4 &viewProjection) noexcept{
+			glm::vec4 rows[4];
+			for (int i=0; i<4; i++)
+				rows[i] = glm::vec4(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]);
+
+			Frustum frustum;
+			frustum.planes[0] = rows[3] + rows[0];
+			frustum.planes[1] = rows[3] - rows[0];
+			frustum.planes[2] = rows[3] + rows[1];
+			frustum.planes[3] = rows[3] - rows[1];
+			frustum.planes[4] = rows[2];
+			frustum.planes[5] = rows[3] - rows[2];
+
+			for (auto &plane : frustum.planes){
+				float length = std::sqrt(plane.x * plane.x + plane.y * plane.y + plane.z * plane.z);
+				if (length > 0.f) plane /= length;
+			}
+
+			return frustum;
+		}
+
+		/**
+		 * @brief get if a sphere is at least partially inside
+		 *
+		 * @param center the center of the sphere
+		 * @param radius the radius of the sphere
+		 */
+		bool intersectsSphere(const glm::vec3 &center, float radius) const noexcept{
+			for (const auto &plane : planes)
+				if (plane.x * center.x + plane.y * center.y + plane.z * center.z + plane.w < -radius) return false;
+
+			return true;
+		}
+
+		/**
+		 * @brief get if an axis aligned box may be inside, the box is only tested against the planes
+		 *
+		 * @param min the minimum corner of the box
+		 * @param max the maximum corner of the box
+		 */
+		bool intersectsBox(const glm::vec3 &min, const glm::vec3 &max) const noexcept{
+			for (const auto &plane : planes){
+				// the corner the farthest along the normal
+				float x = plane.x >= 0.f ? max.x : min.x;
+				float y = plane.y >= 0.f ? max.y : min.y;
+				float z = plane.z >= 0.f ? max.z : min.z;
+
+				if (plane.x * x + plane.y * y + plane.z * z + plane.w < 0.f) return false;
+			}
+
+			return true;
+		}
+	};
+}
\ No newline at end of file
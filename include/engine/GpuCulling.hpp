@@ -0,0 +1,189 @@
+#pragma once
+
+#include "engine/LogicalDevice.hpp"
+#include "engine/IndirectScene.hpp"
+#include "engine/MultiDrawIndirect.hpp"
+#include "engine/ComputePipeline.hpp"
+#include "engine/PipelineLayoutCache.hpp"
+#include "engine/DescriptorAllocator.hpp"
+#include "engine/Synchronization2.hpp"
+#include "engine/Buffer.hpp"
+#include "engine/Frustum.hpp"
+
+// libs
+#include <vulkan/vulkan.h>
+#include <glm/mat4x4.hpp>
+#include <glm/vec4.hpp>
+#include <glm/vec2.hpp>
+
+// std
+#include <vector>
+#include <memory>
+#include <string>
+
+namespace vk_engine{
+	/**
+	 * @brief cull the commands of an indirect scene in compute shaders. Each object is tested against the frustum and a depth pyramid
+	 * built from the depth of the previous frame, the visible commands of a batch are compacted at the beginning of the batch
+	 * with an atomic counter read by vkCmdDrawIndexedIndirectCountKHR. Without VK_KHR_draw_indirect_count the culled commands
+	 * are kept with no instance. The depth is expected in [0, 1] with the near plane at 0, require drawIndirectFirstInstance
+	 */
+	class GpuCulling{
+		public:
+			// the variant names of the shaders in the archive written by the shaders make target, res/shaders/shaders.pak
+			static constexpr const char *DEFAULT_CULL_SHADER = "cull.comp";
+			static constexpr const char *DEFAULT_PYRAMID_SHADER = "depth_pyramid.comp";
+
+			GpuCulling(LogicalDevice &device, IndirectScene &scene, const MultiDrawIndirect &multiDrawIndirect, PipelineLayoutCache &layoutCache, DescriptorAllocator &descriptorAllocator);
+			~GpuCulling();
+
+			// avoid copy
+			GpuCulling(const GpuCulling &) = delete;
+			GpuCulling &operator=(const GpuCulling &) = delete;
+
+			/**
+			 * @brief set the shaders of res/shaders/cull.comp and res/shaders/depth_pyramid.comp, the defaults are their names in the
+			 * archive written by the shaders make target, loaded through a shader module cache using that archive
+			 *
+			 * @param cullFile the culling shader, a SPIR-V file or a variant name of the archive of the module cache
+			 * @param pyramidFile the depth pyramid shader, a SPIR-V file or a variant name of the archive of the module cache
+			 */
+			void setShaderFiles(const std::string &cullFile, const std::string &pyramidFile) noexcept {this->cullFile = cullFile; this->pyramidFile = pyramidFile;}
+
+			/**
+			 * @brief set the shader module cache used to load the shaders, required by the default shaders which are only in the archive
+			 * @param cache the shader module cache, must outlive the build
+			 */
+			void setShaderModuleCache(ShaderModuleCache &cache) noexcept {moduleCache = &cache;}
+
+			/**
+			 * @brief set the pipeline cache used on the build
+			 * @param cache the pipeline cache, must outlive the build
+			 */
+			void setPipelineCache(PipelineCache &cache) noexcept {pipelineCache = &cache;}
+
+			/**
+			 * @brief record the barriers with vkCmdPipelineBarrier2KHR if the device support it
+			 * @param synchronization2 the built synchronization2 support, must outlive the culling
+			 */
+			void setSynchronization2(const Synchronization2 &synchronization2) noexcept {this->synchronization2 = &synchronization2;}
+
+			/**
+			 * @brief set the maximum count of batches of the scene, the size of the count buffers
+			 * @param count the count of batches
+			 */
+			void setMaxBatches(uint32_t count) noexcept {maxBatches = count;}
+
+			/**
+			 * @brief enable the test against the depth pyramid, only used once a pyramid is built
+			 * @param enable true to test the occlusion
+			 */
+			void setOcclusion(bool enable) noexcept {occlusion = enable;}
+
+			/**
+			 * @brief create the pipelines and the buffers of the frames, the scene must be built
+			 */
+			void build();
+
+			/**
+			 * @brief record the culling of the current frame of the scene, after IndirectScene::beginFrame and outside of a render pass
+			 *
+			 * @param commandBuffer the command buffer
+			 * @param viewProjection the view projection matrix of the camera
+			 */
+			void cull(VkCommandBuffer commandBuffer, const glm::mat4 &viewProjection);
+
+			/**
+			 * @brief record the visible commands of the scene, after cull
+			 * @param commandBuffer the command buffer, in a render pass compatible with the pipelines of the scene
+			 */
+			void draw(VkCommandBuffer commandBuffer);
+
+			/**
+			 * @brief record the depth pyramid used by the culling of the next frame, outside of a render pass.
+			 * the depth must be readable by the compute shaders, the pyramid is recreated when the size changes and must not be in use
+			 *
+			 * @param commandBuffer the command buffer
+			 * @param depthView a view of the depth aspect of the depth image
+			 * @param depthLayout the layout of the depth image
+			 * @param extent the size of the depth image
+			 */
+			void buildDepthPyramid(VkCommandBuffer commandBuffer, VkImageView depthView, VkImageLayout depthLayout, VkExtent2D extent);
+
+			/**
+			 * @brief get the culled commands of a frame
+			 * @param frameIndex the index of the frame in flight
+			 * @return Buffer&
+			 */
+			Buffer &getCommandBuffer(uint32_t frameIndex) const {
+				assert(frameIndex < frames.size() && "invalid frame index");
+				return *frames[frameIndex].commands;
+			}
+
+			/**
+			 * @brief get the counts of visible commands of each batch of a frame, only written if the commands are compacted
+			 * @param frameIndex the index of the frame in flight
+			 * @return Buffer&
+			 */
+			Buffer &getCountBuffer(uint32_t frameIndex) const {
+				assert(frameIndex < frames.size() && "invalid frame index");
+				return *frames[frameIndex].counts;
+			}
+
+			/**
+			 * @brief get if the visible commands are compacted and counted, with VK_KHR_draw_indirect_count
+			 */
+			bool isCompacting() const noexcept {return compact;}
+
+		private:
+			// the uniform buffer of cull.comp
+			struct CullData{
+				glm::mat4 viewProjection;
+				glm::vec4 planes[6];
+				glm::vec2 pyramidSize;
+				uint32_t pyramidLevels;
+				uint32_t occlusion;
+			};
+
+			struct Frame{
+				std::unique_ptr<Buffer> commands;
+				std::unique_ptr<Buffer> counts;
+				std::unique_ptr<Buffer> cullData;
+			};
+
+			void createPyramid(VkExtent2D extent);
+			void destroyPyramid();
+			void pipelineBarrier(VkCommandBuffer commandBuffer, const std::vector<VkImageMemoryBarrier2KHR> &imageBarriers, const std::vector<VkBufferMemoryBarrier2KHR> &bufferBarriers) const;
+			VkImageMemoryBarrier2KHR getPyramidBarrier(uint32_t baseLevel, uint32_t levelCount, VkImageLayout oldLayout, VkPipelineStageFlags2KHR srcStages, VkAccessFlags2KHR srcAccess, VkAccessFlags2KHR dstAccess) const noexcept;
+
+			LogicalDevice &device;
+			IndirectScene &scene;
+			const MultiDrawIndirect &multiDrawIndirect;
+			PipelineLayoutCache &layoutCache;
+			DescriptorAllocator &descriptorAllocator;
+			const Synchronization2 *synchronization2 = nullptr;
+			ShaderModuleCache *moduleCache = nullptr;
+			PipelineCache *pipelineCache = nullptr;
+
+			std::string cullFile = DEFAULT_CULL_SHADER;
+			std::string pyramidFile = DEFAULT_PYRAMID_SHADER;
+			uint32_t maxBatches = 256;
+			bool occlusion = true;
+			bool compact = false;
+
+			std::unique_ptr<ComputePipeline> cullPipeline;
+			std::unique_ptr<ComputePipeline> pyramidPipeline;
+			std::vector<Frame> frames;
+
+			// the pyramid is in the general layout once initialized, valid once built from a depth image
+			VkImage pyramid = VK_NULL_HANDLE;
+			VkDeviceMemory pyramidMemory = VK_NULL_HANDLE;
+			VkImageView pyramidView = VK_NULL_HANDLE;
+			std::vector<VkImageView> levelViews;
+			VkSampler sampler = VK_NULL_HANDLE;
+			VkExtent2D pyramidExtent = {0, 0};
+			uint32_t pyramidLevels = 0;
+			bool pyramidInitialized = false;
+			bool pyramidValid = false;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,151 @@
+#pragma once
+
+#include "engine/LogicalDevice.hpp"
+#include "engine/PipelineCache.hpp"
+#include "engine/ThreadPool.hpp"
+
+// libs
+#include <vulkan/vulkan.h>
+
+// std
+#include <array>
+#include <unordered_map>
+#include <mutex>
+
+// VK_EXT_graphics_pipeline_library is more recent than the bundled vulkan headers
+#ifndef VK_EXT_graphics_pipeline_library
+#define VK_EXT_graphics_pipeline_library 1
+#define VK_EXT_GRAPHICS_PIPELINE_LIBRARY_SPEC_VERSION 1
+#define VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME "VK_EXT_graphics_pipeline_library"
+
+#define VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT static_cast<VkStructureType>(1000320000)
+#define VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_PROPERTIES_EXT static_cast<VkStructureType>(1000320001)
+#define VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_LIBRARY_CREATE_INFO_EXT static_cast<VkStructureType>(1000320002)
+
+#define VK_PIPELINE_CREATE_RETAIN_LINK_TIME_OPTIMIZATION_INFO_BIT_EXT static_cast<VkPipelineCreateFlagBits>(0x00800000)
+#define VK_PIPELINE_CREATE_LINK_TIME_OPTIMIZATION_BIT_EXT static_cast<VkPipelineCreateFlagBits>(0x00000400)
+
+typedef enum VkGraphicsPipelineLibraryFlagBitsEXT {
+	VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT = 0x00000001,
+	VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT = 0x00000002,
+	VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT = 0x00000004,
+	VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT = 0x00000008,
+	VK_GRAPHICS_PIPELINE_LIBRARY_FLAG_BITS_MAX_ENUM_EXT = 0x7FFFFFFF
+} VkGraphicsPipelineLibraryFlagBitsEXT;
+typedef VkFlags VkGraphicsPipelineLibraryFlagsEXT;
+
+typedef struct VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT {
+	VkStructureType sType;
+	void *pNext;
+	VkBool32 graphicsPipelineLibrary;
+} VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT;
+
+typedef struct VkPhysicalDeviceGraphicsPipelineLibraryPropertiesEXT {
+	VkStructureType sType;
+	void *pNext;
+	VkBool32 graphicsPipelineLibraryFastLinking;
+	VkBool32 graphicsPipelineLibraryIndependentInterpolationDecoration;
+} VkPhysicalDeviceGraphicsPipelineLibraryPropertiesEXT;
+
+typedef struct VkGraphicsPipelineLibraryCreateInfoEXT {
+	VkStructureType sType;
+	void *pNext;
+	VkGraphicsPipelineLibraryFlagsEXT flags;
+} VkGraphicsPipelineLibraryCreateInfoEXT;
+#endif
+
+namespace vk_engine{
+	/**
+	 * @brief the VK_EXT_graphics_pipeline_library support of a device and the libraries shared between the pipelines.
+	 * the pipelines are split into four parts (vertex input, pre-rasterization, fragment shader, fragment output) compiled once
+	 * and linked together, the link being much faster than a complete pipeline creation
+	 */
+	class GraphicsPipelineLibrary{
+		public:
+			static constexpr uint32_t PART_COUNT = 4;
+			using Parts = std::array<VkPipeline, PART_COUNT>;
+
+			GraphicsPipelineLibrary(LogicalDevice &device);
+			~GraphicsPipelineLibrary();
+
+			// avoid copy
+			GraphicsPipelineLibrary(const GraphicsPipelineLibrary &) = delete;
+			GraphicsPipelineLibrary &operator=(const GraphicsPipelineLibrary &) = delete;
+
+			/**
+			 * @brief require the extensions and the features if the physical device support them, must be called before the build of the logical device
+			 */
+			void require();
+
+			/**
+			 * @brief check the enabled features, must be called after the build of the logical device
+			 */
+			void build();
+
+			/**
+			 * @brief get if the pipelines can be created from libraries, if not the pipelines are created in one piece
+			 */
+			bool isSupported() const noexcept {return supported;}
+
+			/**
+			 * @brief get if the link of the libraries is fast, if not the pipelines are directly linked with the link time optimizations
+			 */
+			bool isFastLinkingSupported() const noexcept {return fastLinking;}
+
+			/**
+			 * @brief set the pipeline cache used to create the libraries and the linked pipelines
+			 * @param cache the pipeline cache, must outlive the library
+			 */
+			void setPipelineCache(PipelineCache &cache) noexcept {this->cache = &cache;}
+
+			/**
+			 * @brief set the thread pool used to link the optimized pipelines in the background, without pool the fast linked pipelines are kept
+			 * @param threadPool the thread pool, must outlive the library
+			 */
+			void setThreadPool(ThreadPool &threadPool) noexcept {this->threadPool = &threadPool;}
+
+			/**
+			 * @brief get the thread pool used to link the optimized pipelines
+			 * @return ThreadPool* nullptr if not set
+			 */
+			ThreadPool *getThreadPool() const noexcept {return threadPool;}
+
+			/**
+			 * @brief get the library of the given part, created on the first use. The create info must only contain the states of the part
+			 * 
+			 * @param part the part of the pipeline
+			 * @param hash the hash of the states of the part, identical hashes return the same library
+			 * @param createInfo the create info of the part
+			 * @return VkPipeline the library
+			 */
+			VkPipeline getPart(VkGraphicsPipelineLibraryFlagBitsEXT part, uint64_t hash, const VkGraphicsPipelineCreateInfo &createInfo);
+
+			/**
+			 * @brief link the parts into a complete pipeline, owned by the caller
+			 * 
+			 * @param parts the libraries of the four parts, in the part bits order
+			 * @param layout the pipeline layout
+			 * @param optimize if true, the pipeline is linked with the link time optimizations
+			 * @return VkPipeline 
+			 */
+			VkPipeline link(const Parts &parts, VkPipelineLayout layout, bool optimize);
+
+			/**
+			 * @brief get the count of libraries
+			 * @return size_t 
+			 */
+			size_t size() const noexcept {return libraries.size();}
+
+		private:
+			LogicalDevice &device;
+			PipelineCache *cache = nullptr;
+			ThreadPool *threadPool = nullptr;
+
+			bool supported = false;
+			bool fastLinking = false;
+
+			// the keys combine the part and the hash of its states
+			std::unordered_map<uint64_t, VkPipeline> libraries;
+			std::mutex mutex;
+	};
+}
\ No newline at end of file
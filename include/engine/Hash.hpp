@@ -0,0 +1,45 @@
+#pragma once
+
+// std
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <type_traits>
+
+namespace vk_engine{
+	static constexpr uint64_t HASH_SEED = 14695981039346656037ULL;
+
+	/**
+	 * @brief hash the given bytes with fnv-1a
+	 *
+	 * @param data the bytes to hash
+	 * @param size the count of bytes
+	 * @param seed the previous hash value
+	 * @return uint64_t
+	 */
+	inline uint64_t hashBytes(const void *data, size_t size, uint64_t seed = HASH_SEED) noexcept{
+		const unsigned char *bytes = static_cast<const unsigned char*>(data);
+		for (size_t i=0; i<size; i++){
+			seed ^= bytes[i];
+			seed *= 1099511628211ULL;
+		}
+		return seed;
+	}
+
+	/**
+	 * @brief combine the hash of the given value into the seed
+	 * @warning the value must not contain padding or pointers, hash the fields one by one instead
+	 *
+	 * @param seed the hash to update
+	 * @param value the value to combine
+	 */
+	template<typename T> inline void hashCombine(uint64_t &seed, const T &value) noexcept{
+		static_assert(std::is_trivially_copyable<T>::value, "only trivially copyable types can be hashed");
+		seed = hashBytes(&value, sizeof(T), seed);
+	}
+
+	inline void hashCombine(uint64_t &seed, const std::string &value) noexcept{
+		seed = hashBytes(value.data(), value.size(), seed);
+		hashCombine(seed, value.size());
+	}
+}
\ No newline at end of file
@@ -2,12 +2,15 @@
 
 #include "engine/LogicalDevice.hpp"
 #include "engine/CommandPool.hpp"
+#include "engine/BindlessTable.hpp"
+#include "engine/ImageStateTracker.hpp"
 
 // libs
 #include <vulkan/vulkan.h>
 
 // std
 #include <string>
+#include <cassert>
 
 namespace vk_engine{
 	class Image{
@@ -85,6 +88,25 @@ namespace vk_engine{
 			 */
 			VkDescriptorImageInfo getDescriptorInfo() const noexcept {return {sampler, imageView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL};}
 
+			/**
+			 * @brief register the image into the bindless table on the build, the image keeps its index until its destruction or its next load.
+			 * the image is not registered if the table is not supported
+			 * @param table the bindless table, must outlive the image
+			 */
+			void setBindlessTable(BindlessTable &table);
+
+			/**
+			 * @brief track the layout of the image in the given tracker, the image is added on the build in VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+			 * @param tracker the state tracker, the upload records its transitions apart and keeps the pending barriers of the tracker, must outlive the image
+			 */
+			void setStateTracker(ImageStateTracker &tracker) noexcept {assert(!isLoaded() && "the state tracker must be set before the build"); stateTracker = &tracker;}
+
+			/**
+			 * @brief get the index of the image in the bindless table
+			 * @return uint32_t BindlessTable::INVALID_INDEX if not registered
+			 */
+			uint32_t getBindlessIndex() const noexcept {return bindlessIndex;}
+
 			/**
 			 * @brief set the format of the image
 			 * @param format the new format of the image
@@ -118,6 +140,7 @@ namespace vk_engine{
 			void createImage(void *pixels, uint32_t width, uint32_t height, uint32_t layerCount);
 			void createImageView();
 			void createSampler();
+			void upload(VkBuffer stagingBuffer);
 			static uint32_t formatToLayerCount(Format format) noexcept;
 
 			LogicalDevice &device;
@@ -134,5 +157,10 @@ namespace vk_engine{
 			Format srcFormat = FORMAT_RGB;
 			Filter filter = FILTER_LINEAR;
 			bool normalizeCoordonates = true;
+
+			BindlessTable *bindlessTable = nullptr;
+			uint32_t bindlessIndex = BindlessTable::INVALID_INDEX;
+
+			ImageStateTracker *stateTracker = nullptr;
 	};
 }
\ No newline at end of file
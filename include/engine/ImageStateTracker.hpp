@@ -0,0 +1,183 @@
+#pragma once
+
+#include "engine/LogicalDevice.hpp"
+#include "engine/Synchronization2.hpp"
+
+// libs
+#include <vulkan/vulkan.h>
+
+// std
+#include <vector>
+#include <unordered_map>
+#include <mutex>
+
+namespace vk_engine{
+	/**
+	 * @brief track the layout, the last accesses and stages of each subresource (mip level and layer) of the registered images.
+	 * the users require the state needed by their next commands, the tracker derives the barriers from the current state
+	 * and batches them until the flush, recorded as a single pipeline barrier with the stages of each barrier.
+	 * The states follow the recording order, the command buffers must be submitted in the same order
+	 */
+	class ImageStateTracker{
+		public:
+			// the state of a subresource
+			struct State{
+				VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+				VkAccessFlags access = 0;
+				VkPipelineStageFlags stages = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+			};
+
+			// the accesses handled as writes, the other ones are reads
+			static constexpr VkAccessFlags WRITE_ACCESS = VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT |
+				VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_HOST_WRITE_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+
+			// all the mip levels and layers of an image
+			static constexpr VkImageSubresourceRange WHOLE_RANGE = {0, 0, VK_REMAINING_MIP_LEVELS, 0, VK_REMAINING_ARRAY_LAYERS};
+
+			ImageStateTracker(LogicalDevice &device);
+			~ImageStateTracker();
+
+			// avoid copy
+			ImageStateTracker(const ImageStateTracker &) = delete;
+			ImageStateTracker &operator=(const ImageStateTracker &) = delete;
+
+			/**
+			 * @brief record the barriers with vkCmdPipelineBarrier2KHR if the device support it
+			 * @param synchronization2 the built synchronization2 support, must outlive the tracker
+			 */
+			void setSynchronization2(const Synchronization2 &synchronization2) noexcept {this->synchronization2 = &synchronization2;}
+
+			/**
+			 * @brief track the given image, the image is removed on its destruction (LogicalDevice::notifyDestroyed)
+			 *
+			 * @param image the image
+			 * @param aspect the aspects of the image, used by the barriers
+			 * @param mipLevels the count of mip levels
+			 * @param layers the count of array layers
+			 * @param state the current state of all the subresources
+			 */
+			void add(VkImage image, VkImageAspectFlags aspect, uint32_t mipLevels = 1, uint32_t layers = 1, const State &state = {VK_IMAGE_LAYOUT_UNDEFINED, 0, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT});
+
+			/**
+			 * @brief stop tracking the given image, the pending barriers of the image are kept
+			 * @param image the image
+			 */
+			void remove(VkImage image);
+
+			/**
+			 * @brief get if the image is tracked
+			 * @param image the image
+			 */
+			bool contains(VkImage image) const;
+
+			/**
+			 * @brief require a state for the next commands on the image, a barrier is added if the subresources are not already in the given state
+			 *
+			 * @param image a tracked image
+			 * @param layout the layout used by the commands
+			 * @param access the accesses of the commands
+			 * @param stages the stages of the commands
+			 * @param range the used subresources, the aspect mask is ignored
+			 */
+			void require(VkImage image, VkImageLayout layout, VkAccessFlags access, VkPipelineStageFlags stages, const VkImageSubresourceRange &range = WHOLE_RANGE);
+
+			/**
+			 * @brief require a layout for the next commands on the image, with the usual accesses and stages of the layout (see getLayoutState)
+			 *
+			 * @param image a tracked image
+			 * @param layout the layout used by the commands
+			 * @param range the used subresources, the aspect mask is ignored
+			 */
+			void require(VkImage image, VkImageLayout layout, const VkImageSubresourceRange &range = WHOLE_RANGE);
+
+			/**
+			 * @brief set the state after an access not done through the tracker, like the final layout of a render pass or the acquire of a swap chain image.
+			 * the access is handled as a write, the next uses wait for it
+			 *
+			 * @param image a tracked image
+			 * @param state the new state
+			 * @param range the changed subresources, the aspect mask is ignored
+			 */
+			void setState(VkImage image, const State &state, const VkImageSubresourceRange &range = WHOLE_RANGE);
+
+			/**
+			 * @brief get the state of a subresource, the access is the last write or the synchronized reads after it
+			 *
+			 * @param image a tracked image
+			 * @param mipLevel the mip level
+			 * @param layer the array layer
+			 * @return State
+			 */
+			State getState(VkImage image, uint32_t mipLevel = 0, uint32_t layer = 0) const;
+
+			/**
+			 * @brief record the pending barriers in a single vkCmdPipelineBarrier2KHR, or vkCmdPipelineBarrier without synchronization2
+			 * @param commandBuffer the command buffer
+			 * @return true if a barrier has been recorded
+			 */
+			bool flush(VkCommandBuffer commandBuffer);
+
+			/**
+			 * @brief get if barriers are waiting for the flush
+			 */
+			bool hasPendingBarriers() const;
+
+			/**
+			 * @brief get the usual accesses and stages of the given layout, used when only the layout is known
+			 * @param layout the layout
+			 * @return State
+			 */
+			static State getLayoutState(VkImageLayout layout) noexcept;
+
+			/**
+			 * @brief get the aspects of the given format, depth and stencil for the combined formats
+			 * @param format the format of the image
+			 * @return VkImageAspectFlags
+			 */
+			static VkImageAspectFlags getFormatAspect(VkFormat format) noexcept;
+
+		private:
+			struct Subresource{
+				VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+				// the last write (or layout transition) and the reads synchronized with it
+				VkPipelineStageFlags writeStages = 0;
+				VkAccessFlags writeAccess = 0;
+				VkPipelineStageFlags readStages = 0;
+				VkAccessFlags readAccess = 0;
+
+				// the index of the pending barrier of the subresource, valid if batch is the current batch of the tracker
+				int barrier = -1;
+				uint32_t batch = 0;
+			};
+
+			struct TrackedImage{
+				VkImage image;
+				VkImageAspectFlags aspect;
+				uint32_t mipLevels;
+				uint32_t layers;
+
+				// indexed by mipLevel * layers + layer
+				std::vector<Subresource> subresources;
+			};
+
+			TrackedImage &getImage(VkImage image);
+			const TrackedImage &getImage(VkImage image) const;
+			VkImageSubresourceRange resolveRange(const TrackedImage &image, const VkImageSubresourceRange &range) const;
+			int addBarrier(const TrackedImage &image, uint32_t mipLevel, uint32_t baseLayer, uint32_t layerCount, VkImageLayout oldLayout, VkImageLayout layout, VkAccessFlags access, VkPipelineStageFlags stages, VkPipelineStageFlags srcStages, VkAccessFlags srcAccess);
+			int getPendingBarrier(const Subresource &subresource) const noexcept;
+			bool sameState(const Subresource &a, const Subresource &b) const noexcept;
+			static bool needsBarrier(const Subresource &subresource, VkImageLayout layout, VkAccessFlags access, VkPipelineStageFlags stages, VkPipelineStageFlags &srcStages, VkAccessFlags &srcAccess) noexcept;
+			static void apply(Subresource &subresource, VkImageLayout layout, VkAccessFlags access, VkPipelineStageFlags stages) noexcept;
+
+			LogicalDevice &device;
+			uint32_t destroyCallback;
+
+			std::unordered_map<uint64_t, TrackedImage> images;
+			mutable std::mutex mutex;
+
+			const Synchronization2 *synchronization2 = nullptr;
+			std::vector<VkImageMemoryBarrier2KHR> barriers;
+			uint32_t batch = 1;
+	};
+}
\ No newline at end of file
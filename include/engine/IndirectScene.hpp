@@ -0,0 +1,239 @@
+#pragma once
+
+#include "engine/LogicalDevice.hpp"
+#include "engine/MultiDrawIndirect.hpp"
+#include "engine/MeshBuffer.hpp"
+#include "engine/Pipeline.hpp"
+#include "engine/Buffer.hpp"
+
+// libs
+#include <vulkan/vulkan.h>
+#include <glm/mat4x4.hpp>
+#include <glm/vec4.hpp>
+
+// std
+#include <vector>
+#include <memory>
+#include <cassert>
+
+namespace vk_engine{
+	/**
+	 * @brief the objects of a scene drawn with indirect commands. The meshes of the objects are in a MeshBuffer, the objects are grouped
+	 * in batches of the same pipeline and material and each batch is recorded with a single vkCmdDrawIndexedIndirect.
+	 * The commands and the transforms stay in buffers of each frame in flight and only the changes are written, so the cost of a frame
+	 * depends on the count of batches and changed objects. The transform of an object is read with gl_InstanceIndex (see res/shaders/instancing.glsl)
+	 */
+	class IndirectScene{
+		public:
+			IndirectScene(LogicalDevice &device, const MultiDrawIndirect &multiDrawIndirect, MeshBuffer &meshes);
+
+			// avoid copy
+			IndirectScene(const IndirectScene &) = delete;
+			IndirectScene &operator=(const IndirectScene &) = delete;
+
+			/**
+			 * @brief set the maximum count of objects
+			 * @param count the count of objects
+			 */
+			void setCapacity(uint32_t count) noexcept {capacity = count;}
+
+			/**
+			 * @brief set the count of frames in flight, each frame has its own buffers
+			 * @param count the count of frames
+			 */
+			void setFramesInFlight(uint32_t count) noexcept {framesInFlight = count;}
+
+			/**
+			 * @brief set the index of the descriptor set bound with the set of the batches
+			 * @param set the index of the set in the pipeline layouts
+			 */
+			void setMaterialSet(uint32_t set) noexcept {materialSet = set;}
+
+			/**
+			 * @brief create the buffers of the frames, the multi draw indirect support must be built
+			 */
+			void build();
+
+			/**
+			 * @brief add a batch, the batches are recorded in the order of their creation
+			 *
+			 * @param pipeline the pipeline of the objects, must outlive the scene
+			 * @param descriptorSet the set bound at the material set index, VK_NULL_HANDLE to keep the bound set
+			 * @return uint32_t the index of the batch
+			 */
+			uint32_t addBatch(Pipeline &pipeline, VkDescriptorSet descriptorSet = VK_NULL_HANDLE);
+
+			/**
+			 * @brief add an object
+			 *
+			 * @param batch the index of the batch
+			 * @param mesh the mesh of the object, in the mesh buffer of the scene
+			 * @param transform the transform of the object
+			 * @param bounds the bounding sphere of the mesh (center, radius), used by the culling. an object with a negative radius is never culled
+			 * @return uint32_t the id of the object, its index in the object buffer
+			 */
+			uint32_t add(uint32_t batch, const MeshBuffer::Mesh &mesh, const glm::mat4 &transform, const glm::vec4 &bounds = glm::vec4(0.f, 0.f, 0.f, -1.f));
+
+			/**
+			 * @brief remove an object, its id can be given to the next added object
+			 * @param object the id of the object
+			 */
+			void remove(uint32_t object);
+
+			/**
+			 * @brief set the transform of an object
+			 *
+			 * @param object the id of the object
+			 * @param transform the new transform
+			 */
+			void setTransform(uint32_t object, const glm::mat4 &transform);
+
+			/**
+			 * @brief write the changes since the last use of the frame into its buffers, the fence of the frame must be signaled
+			 * @param frameIndex the index of the frame in flight
+			 */
+			void beginFrame(uint32_t frameIndex);
+
+			/**
+			 * @brief bind the mesh buffer and record the batches, the objects added or removed after beginFrame are recorded from the next frame
+			 * @param commandBuffer the command buffer, in a render pass compatible with the pipelines
+			 */
+			void record(VkCommandBuffer commandBuffer);
+
+			/**
+			 * @brief bind the mesh buffer and record the batches with the commands of the given buffers, like the output of the culling (see GpuCulling).
+			 * the commands of a batch are at the same offset as in the command buffer of the scene. require drawIndirectFirstInstance, and VK_KHR_draw_indirect_count with a count buffer
+			 *
+			 * @param commandBuffer the command buffer, in a render pass compatible with the pipelines
+			 * @param commands the buffer of the commands
+			 * @param counts the uint32_t count of commands of each batch, VK_NULL_HANDLE to record all the commands of the batches
+			 */
+			void record(VkCommandBuffer commandBuffer, VkBuffer commands, VkBuffer counts);
+
+			/**
+			 * @brief get the transforms of the objects of a frame, indexed by the object ids
+			 * @param frameIndex the index of the frame in flight
+			 * @return Buffer&
+			 */
+			Buffer &getObjectBuffer(uint32_t frameIndex) const {
+				assert(frameIndex < frames.size() && "invalid frame index");
+				return *frames[frameIndex].objects;
+			}
+
+			/**
+			 * @brief get the bounding spheres of the objects of a frame, in the space of the objects and indexed by the object ids
+			 * @param frameIndex the index of the frame in flight
+			 * @return Buffer&
+			 */
+			Buffer &getBoundsBuffer(uint32_t frameIndex) const {
+				assert(frameIndex < frames.size() && "invalid frame index");
+				return *frames[frameIndex].bounds;
+			}
+
+			/**
+			 * @brief get the VkDrawIndexedIndirectCommand of a frame, the commands of a batch are consecutive
+			 * @param frameIndex the index of the frame in flight
+			 * @return Buffer&
+			 */
+			Buffer &getCommandBuffer(uint32_t frameIndex) const {
+				assert(frameIndex < frames.size() && "invalid frame index");
+				return *frames[frameIndex].commands;
+			}
+
+			/**
+			 * @brief get the count of objects
+			 * @return uint32_t
+			 */
+			uint32_t getObjectCount() const noexcept {return objectCount;}
+
+			/**
+			 * @brief get the count of batches
+			 * @return uint32_t
+			 */
+			uint32_t getBatchCount() const noexcept {return static_cast<uint32_t>(batches.size());}
+
+			/**
+			 * @brief get the index of the first command of a batch, written by the last beginFrame
+			 * @param batch the index of the batch
+			 * @return uint32_t
+			 */
+			uint32_t getBatchFirstCommand(uint32_t batch) const noexcept {return batches[batch].firstCommand;}
+
+			/**
+			 * @brief get the count of commands of a batch, written by the last beginFrame
+			 * @param batch the index of the batch
+			 * @return uint32_t
+			 */
+			uint32_t getBatchCommandCount(uint32_t batch) const noexcept {return batches[batch].commandCount;}
+
+			/**
+			 * @brief get the capacity of the scene, the size of the buffers in objects and commands
+			 * @return uint32_t
+			 */
+			uint32_t getCapacity() const noexcept {return capacity;}
+
+			/**
+			 * @brief get the count of frames in flight
+			 * @return uint32_t
+			 */
+			uint32_t getFramesInFlight() const noexcept {return framesInFlight;}
+
+			/**
+			 * @brief get the index of the frame given to the last beginFrame
+			 * @return uint32_t
+			 */
+			uint32_t getCurrentFrame() const noexcept {return currentFrame;}
+
+		private:
+			static constexpr uint32_t NO_BATCH = ~0U;
+
+			struct Object{
+				uint32_t batch = NO_BATCH;
+				uint32_t batchIndex = 0;
+				MeshBuffer::Mesh mesh;
+			};
+
+			struct Batch{
+				Pipeline *pipeline;
+				VkDescriptorSet descriptorSet;
+				std::vector<uint32_t> objects;
+				// the commands written by the last beginFrame
+				uint32_t firstCommand = 0;
+				uint32_t commandCount = 0;
+			};
+
+			struct Frame{
+				std::unique_ptr<Buffer> objects;
+				std::unique_ptr<Buffer> bounds;
+				std::unique_ptr<Buffer> commands;
+
+				// the objects changed since the last use of the frame
+				std::vector<uint32_t> changedObjects;
+				std::vector<bool> changed;
+				bool changedCommands = true;
+			};
+
+			void writeCommands();
+
+			LogicalDevice &device;
+			const MultiDrawIndirect &multiDrawIndirect;
+			MeshBuffer &meshes;
+
+			uint32_t capacity = 0;
+			uint32_t framesInFlight = 2;
+			uint32_t materialSet = 0;
+			uint32_t currentFrame = 0;
+
+			std::vector<Object> objects;
+			std::vector<glm::mat4> transforms;
+			std::vector<glm::vec4> bounds;
+			std::vector<uint32_t> freeObjects;
+			uint32_t objectCount = 0;
+
+			std::vector<Batch> batches;
+			std::vector<VkDrawIndexedIndirectCommand> commands;
+			bool changedCommands = false;
+
+			std::vector<Frame> frames;
+	};
+}
\ No newline at end of file
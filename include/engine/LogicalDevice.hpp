@@ -10,6 +10,12 @@
 #include <array>
 #include <vector>
 #include <string>
+#include <memory>
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <type_traits>
 
 namespace vk_engine{
 	class LogicalDevice{
@@ -27,6 +33,54 @@ namespace vk_engine{
 			 */
 			void requireExtension(const char *extension) {requiredExtensions.push_back(extension);}
 
+			/**
+			 * @brief require the given extension only if the physical device support it
+			 * @param extension the vulkan extension
+			 * @return true if the extension is supported and will be enabled, false if not
+			 */
+			bool requireOptionalExtension(const char *extension);
+
+			/**
+			 * @brief get if the given extension has been required
+			 * @param extension the vulkan extension
+			 */
+			bool isExtensionEnabled(const std::string &extension) const noexcept;
+
+			/**
+			 * @brief require an extension features structure, the structure is chained to the device create info on the build.
+			 * requiring the same structure type twice return the same structure
+			 * 
+			 * @param sType the structure type of T
+			 * @return T& the structure to fill with the required features
+			 */
+			template<typename T> T &requireFeatures(VkStructureType sType){
+				if (T *features = getEnabledFeatures<T>(sType)) return *features;
+
+				std::shared_ptr<T> features = std::make_shared<T>();
+				features->sType = sType;
+				featuresChain.push_back(std::shared_ptr<VkBaseOutStructure>(features, reinterpret_cast<VkBaseOutStructure*>(features.get())));
+				return *features;
+			}
+
+			/**
+			 * @brief get a required extension features structure
+			 * @param sType the structure type of T
+			 * @return T* the structure, nullptr if not required
+			 */
+			template<typename T> T *getEnabledFeatures(VkStructureType sType) const noexcept{
+				for (auto &features : featuresChain){
+					if (features->sType == sType) return reinterpret_cast<T*>(features.get());
+				}
+				return nullptr;
+			}
+
+			/**
+			 * @brief get a device level function
+			 * @param name the name of the function
+			 * @return T the function pointer, nullptr if not available
+			 */
+			template<typename T> T getProcAddr(const char *name) const noexcept {return reinterpret_cast<T>(vkGetDeviceProcAddr(device, name));}
+
 			/**
 			 * @brief set the priority of the queu used by the logical device
 			 * @param priority the priority level
@@ -91,20 +145,59 @@ namespace vk_engine{
 			 */
 			void createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer &buffer,VkDeviceMemory &bufferMemory);
 
+			/**
+			 * @brief add a function called when a resource of the device is destroyed, used by the caches referencing the resources
+			 * @param callback the function, called with the handle key of the destroyed resource
+			 * @return uint32_t the id of the callback
+			 */
+			uint32_t addDestroyCallback(std::function<void(uint64_t)> callback);
+
+			/**
+			 * @brief remove a destroy callback
+			 * @param id the id returned by addDestroyCallback
+			 */
+			void removeDestroyCallback(uint32_t id);
+
+			/**
+			 * @brief notify the destroy callbacks that the given resource is destroyed, must be called before the destruction of the handle
+			 * @param handle the vulkan handle of the resource
+			 */
+			template<typename T> void notifyDestroyed(T handle) {if (handle != VK_NULL_HANDLE) callDestroyCallbacks(getHandleKey(handle));}
+
+			/**
+			 * @brief get an integer key of the given vulkan handle, the non dispatchable handles are not pointers on 32 bits targets
+			 * @param handle the vulkan handle
+			 * @return uint64_t
+			 */
+			template<typename T> static uint64_t getHandleKey(T handle) noexcept{
+				if constexpr (std::is_pointer<T>::value){
+					return static_cast<uint64_t>(reinterpret_cast<uintptr_t>(handle));
+				} else {
+					return static_cast<uint64_t>(handle);
+				}
+			}
+
 
 			// operators
 			operator VkDevice() {return device;}
 			void operator<<(const char *extension) noexcept {requireExtension(extension);}
 		
 		private:
+			void callDestroyCallbacks(uint64_t handle);
+
 			Instance &instance;
 			PhysicalDevice &physicalDevice;
 			VkDevice device;
 
 			std::vector<const char *> requiredExtensions;
+			std::vector<std::shared_ptr<VkBaseOutStructure>> featuresChain;
 			std::vector<float> queuePriorities;
 			uint32_t queueCount = 0;
 
 			std::vector<std::array<VkQueue, FAMILY_TYPE_COUNT>> queues;
+
+			std::map<uint32_t, std::function<void(uint64_t)>> destroyCallbacks;
+			uint32_t nextCallbackId = 0;
+			std::mutex destroyCallbacksMutex;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,81 @@
+#pragma once
+
+// std
+#include <string>
+#include <cstdint>
+
+namespace vk_engine{
+	/**
+	 * @brief a read only file mapped in memory, the content is loaded by the system on access without copy.
+	 * the mapping starts on a page boundary, the data is aligned for any type
+	 */
+	class MappedFile{
+		public:
+			MappedFile() = default;
+
+			/**
+			 * @brief map the given file, throw if the file cannot be opened
+			 * @param filepath the path to the file
+			 */
+			MappedFile(const std::string &filepath);
+			~MappedFile();
+
+			// avoid copy
+			MappedFile(const MappedFile &) = delete;
+			MappedFile &operator=(const MappedFile &) = delete;
+
+			MappedFile(MappedFile &&other) noexcept;
+			MappedFile &operator=(MappedFile &&other) noexcept;
+
+			/**
+			 * @brief map the given file, the previous file is unmapped
+			 * @param filepath the path to the file
+			 */
+			void open(const std::string &filepath);
+
+			/**
+			 * @brief unmap the file, the pointers to the data are invalidated
+			 */
+			void close() noexcept;
+
+			/**
+			 * @brief get if a file is mapped
+			 */
+			bool isOpen() const noexcept {return mapped != nullptr || opened;}
+
+			/**
+			 * @brief get the content of the file, nullptr for an empty file
+			 * @return const void* 
+			 */
+			const void *data() const noexcept {return mapped;}
+
+			/**
+			 * @brief get the content of the file at the given offset
+			 * @param offset the offset in bytes, must be aligned for T
+			 * @return const T* 
+			 */
+			template<typename T> const T *as(size_t offset = 0) const noexcept {return reinterpret_cast<const T*>(static_cast<const char*>(mapped) + offset);}
+
+			/**
+			 * @brief get the size of the file
+			 * @return size_t the size in bytes
+			 */
+			size_t size() const noexcept {return fileSize;}
+
+			/**
+			 * @brief get the path of the mapped file
+			 * @return const std::string& 
+			 */
+			const std::string &getFilepath() const noexcept {return filepath;}
+
+		private:
+			void *mapped = nullptr;
+			size_t fileSize = 0;
+			bool opened = false;
+			std::string filepath;
+
+			// the handles of the file and of the mapping object on windows
+			void *fileHandle = nullptr;
+			void *mappingHandle = nullptr;
+	};
+}
\ No newline at end of file
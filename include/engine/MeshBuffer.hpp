@@ -0,0 +1,108 @@
+#pragma once
+
+#include "engine/LogicalDevice.hpp"
+#include "engine/CommandPool.hpp"
+#include "engine/Buffer.hpp"
+
+// libs
+#include <vulkan/vulkan.h>
+
+// std
+#include <memory>
+
+namespace vk_engine{
+	/**
+	 * @brief shared vertex and index buffers holding the meshes one after the other, all the meshes are drawn with the same bound buffers.
+	 * the vertices of all the meshes have the same size, the indices are uint32_t relative to the first vertex of their mesh
+	 */
+	class MeshBuffer{
+		public:
+			// the location of a mesh in the buffers, the parameters of its indexed draws
+			struct Mesh{
+				uint32_t firstIndex = 0;
+				uint32_t indexCount = 0;
+				int32_t vertexOffset = 0;
+				uint32_t vertexCount = 0;
+			};
+
+			MeshBuffer(LogicalDevice &device, CommandPool &commandPool);
+
+			// avoid copy
+			MeshBuffer(const MeshBuffer &) = delete;
+			MeshBuffer &operator=(const MeshBuffer &) = delete;
+
+			/**
+			 * @brief set the size of a vertex
+			 * @param size the size in bytes
+			 */
+			void setVertexSize(uint32_t size) noexcept {vertexSize = size;}
+
+			/**
+			 * @brief set the count of vertices and indices of the buffers
+			 *
+			 * @param vertexCount the count of vertices
+			 * @param indexCount the count of indices
+			 */
+			void setCapacity(uint32_t vertexCount, uint32_t indexCount) noexcept {vertexCapacity = vertexCount; indexCapacity = indexCount;}
+
+			/**
+			 * @brief create the buffers
+			 */
+			void build();
+
+			/**
+			 * @brief copy a mesh at the end of the buffers, the copy is done when the function returns
+			 *
+			 * @param vertices the vertices, of the vertex size
+			 * @param vertexCount the count of vertices
+			 * @param indices the indices, relative to the first vertex
+			 * @param indexCount the count of indices
+			 * @return Mesh the location of the mesh
+			 */
+			Mesh add(const void *vertices, uint32_t vertexCount, const uint32_t *indices, uint32_t indexCount);
+
+			/**
+			 * @brief bind the vertex buffer at the binding 0 and the index buffer
+			 * @param commandBuffer the command buffer
+			 */
+			void bind(VkCommandBuffer commandBuffer) const noexcept;
+
+			/**
+			 * @brief get the vertex buffer
+			 * @return VkBuffer
+			 */
+			VkBuffer getVertexBuffer() const noexcept {return vertexBuffer->getBuffer();}
+
+			/**
+			 * @brief get the index buffer
+			 * @return VkBuffer
+			 */
+			VkBuffer getIndexBuffer() const noexcept {return indexBuffer->getBuffer();}
+
+			/**
+			 * @brief get the count of used vertices
+			 * @return uint32_t
+			 */
+			uint32_t getVertexCount() const noexcept {return vertexCount;}
+
+			/**
+			 * @brief get the count of used indices
+			 * @return uint32_t
+			 */
+			uint32_t getIndexCount() const noexcept {return indexCount;}
+
+		private:
+			LogicalDevice &device;
+			CommandPool &commandPool;
+
+			uint32_t vertexSize = 0;
+			uint32_t vertexCapacity = 0;
+			uint32_t indexCapacity = 0;
+
+			uint32_t vertexCount = 0;
+			uint32_t indexCount = 0;
+
+			std::unique_ptr<Buffer> vertexBuffer;
+			std::unique_ptr<Buffer> indexBuffer;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "engine/LogicalDevice.hpp"
+
+// libs
+#include <vulkan/vulkan.h>
+
+namespace vk_engine{
+	/**
+	 * @brief the indirect draw support of a device, the multiDrawIndirect and drawIndirectFirstInstance features and VK_KHR_draw_indirect_count.
+	 * all of them are optional, the draws are split in several commands when a feature is missing
+	 */
+	class MultiDrawIndirect{
+		public:
+			MultiDrawIndirect(LogicalDevice &device);
+
+			// avoid copy
+			MultiDrawIndirect(const MultiDrawIndirect &) = delete;
+			MultiDrawIndirect &operator=(const MultiDrawIndirect &) = delete;
+
+			/**
+			 * @brief require the features and the extension if the physical device support them, must be called before the build of the logical device
+			 */
+			void require();
+
+			/**
+			 * @brief load the commands of the enabled extension, must be called after the build of the logical device
+			 */
+			void build();
+
+			/**
+			 * @brief get if a single command can record several draws
+			 */
+			bool isMultiDrawSupported() const noexcept {return multiDraw;}
+
+			/**
+			 * @brief get if the indirect commands can have a first instance, required to index the objects with gl_InstanceIndex
+			 */
+			bool isFirstInstanceSupported() const noexcept {return firstInstance;}
+
+			/**
+			 * @brief get if the count of draws can be read from a buffer
+			 */
+			bool isCountSupported() const noexcept {return count;}
+
+			/**
+			 * @brief record the VkDrawIndexedIndirectCommand of the buffer, in a single command if the device support it
+			 *
+			 * @param commandBuffer the command buffer
+			 * @param buffer the buffer of the commands
+			 * @param offset the offset of the first command in the buffer
+			 * @param drawCount the count of commands
+			 * @param stride the size between two commands
+			 */
+			void drawIndexedIndirect(VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize offset, uint32_t drawCount, uint32_t stride = sizeof(VkDrawIndexedIndirectCommand)) const noexcept;
+
+			/**
+			 * @brief record the commands of the buffer, their count is read from the count buffer when executed. require isCountSupported()
+			 *
+			 * @param commandBuffer the command buffer
+			 * @param buffer the buffer of the commands
+			 * @param offset the offset of the first command in the buffer
+			 * @param countBuffer the buffer of the count
+			 * @param countOffset the offset of the uint32_t count in the count buffer
+			 * @param maxDrawCount the maximum count of commands
+			 * @param stride the size between two commands
+			 */
+			void drawIndexedIndirectCount(VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize offset, VkBuffer countBuffer, VkDeviceSize countOffset, uint32_t maxDrawCount, uint32_t stride = sizeof(VkDrawIndexedIndirectCommand)) const noexcept;
+
+		private:
+			LogicalDevice &device;
+
+			bool multiDraw = false;
+			bool firstInstance = false;
+			bool count = false;
+			uint32_t maxDrawCount = 1;
+
+			PFN_vkCmdDrawIndexedIndirectCountKHR cmdDrawIndexedIndirectCount = nullptr;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "engine/LogicalDevice.hpp"
+#include "engine/FrameCommandPool.hpp"
+#include "engine/ThreadPool.hpp"
+
+// libs
+#include <vulkan/vulkan.h>
+
+// std
+#include <vector>
+#include <memory>
+#include <functional>
+
+namespace vk_engine{
+	/**
+	 * @brief record secondary command buffers on the workers of a thread pool. Each worker has its own command pool per frame in flight,
+	 * the pools of a frame are reset together when the frame begins again and their command buffers are reused
+	 */
+	class ParallelRecorder{
+		public:
+			// record the commands of the task index into the secondary command buffer
+			using Task = std::function<void(VkCommandBuffer commandBuffer, uint32_t index)>;
+
+			ParallelRecorder(LogicalDevice &device, ThreadPool &threadPool);
+
+			// avoid copy
+			ParallelRecorder(const ParallelRecorder &) = delete;
+			ParallelRecorder &operator=(const ParallelRecorder &) = delete;
+
+			/**
+			 * @brief set the family of the command pools, must be the family of the primary command buffers
+			 * @param family the family
+			 */
+			void setFamily(Family family) noexcept {this->family = family;}
+
+			/**
+			 * @brief set the count of frames in flight, each frame has its own pools
+			 * @param count the count of frames
+			 */
+			void setFramesInFlight(uint32_t count) noexcept {framesInFlight = count;}
+
+			/**
+			 * @brief create the command pools of the workers
+			 */
+			void build();
+
+			/**
+			 * @brief reset the pools of the given frame, the fence of the frame must be signaled
+			 * @param frameIndex the index of the frame in flight
+			 */
+			void beginFrame(uint32_t frameIndex);
+
+			/**
+			 * @brief record the tasks in parallel and execute the secondary command buffers in the primary one, in task order.
+			 * must not be called from a worker of the thread pool
+			 *
+			 * @param commandBuffer the primary command buffer
+			 * @param inheritanceInfo the render pass, subpass and framebuffer continued by the secondary command buffers, no render pass if outside of a render pass
+			 * @param taskCount the count of tasks, each task records a secondary command buffer
+			 * @param task the recording function, called from the workers
+			 */
+			void record(VkCommandBuffer commandBuffer, const VkCommandBufferInheritanceInfo &inheritanceInfo, uint32_t taskCount, const Task &task);
+
+			/**
+			 * @brief get the thread pool recording the command buffers
+			 * @return ThreadPool&
+			 */
+			ThreadPool &getThreadPool() noexcept {return threadPool;}
+
+		private:
+			LogicalDevice &device;
+			ThreadPool &threadPool;
+
+			Family family = FAMILY_GRAPHIC;
+			uint32_t framesInFlight = 2;
+			uint32_t currentFrame = 0;
+
+			// [frame][worker]
+			std::vector<std::vector<std::unique_ptr<FrameCommandPool>>> frames;
+	};
+}
\ No newline at end of file
@@ -9,6 +9,7 @@
 #include <string>
 #include <bitset>
 #include <array>
+#include <set>
 
 namespace vk_engine{
 	
@@ -157,6 +158,13 @@ namespace vk_engine{
 			 */
 			std::bitset<FEATURES_COUNT> getRequiredFeatures() const noexcept {return requiredFeatures;}
 
+			/**
+			 * @brief get if the given feature is supported by the physical device, available after the build.
+			 * an optional feature can be required after the build if supported, until the build of the logical device
+			 * @param feature the feature
+			 */
+			bool isFeatureSupported(Feature feature) const noexcept;
+
 			/**
 			 * @brief get the required features as a VkPhysicalDeviceFeatures structure
 			 * @return VkPhysicalDevice 
@@ -175,6 +183,48 @@ namespace vk_engine{
 			 */
 			SwapChainSupport getSwapChainSupport() const noexcept {return swapChainSupport;}
 
+			/**
+			 * @brief get if the given extension is supported by the physical device, available after the build
+			 * @param extension the name of the extension
+			 */
+			bool isExtensionSupported(const std::string &extension) const noexcept {return supportedExtensions.find(extension) != supportedExtensions.end();}
+
+			/**
+			 * @brief query an extension features structure of the physical device, available after the build
+			 * @param sType the structure type of T
+			 * @return T the supported features
+			 */
+			template<typename T> T getFeatures(VkStructureType sType) const noexcept{
+				T features{};
+				features.sType = sType;
+
+				VkPhysicalDeviceFeatures2 features2{};
+				features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+				features2.pNext = &features;
+
+				vkGetPhysicalDeviceFeatures2(physicalDevice, &features2);
+				features.pNext = nullptr;
+				return features;
+			}
+
+			/**
+			 * @brief query an extension properties structure of the physical device
+			 * @param sType the structure type of T
+			 * @return T the properties
+			 */
+			template<typename T> T getProperties(VkStructureType sType) const noexcept{
+				T extensionProperties{};
+				extensionProperties.sType = sType;
+
+				VkPhysicalDeviceProperties2 properties2{};
+				properties2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+				properties2.pNext = &extensionProperties;
+
+				vkGetPhysicalDeviceProperties2(physicalDevice, &properties2);
+				extensionProperties.pNext = nullptr;
+				return extensionProperties;
+			}
+
 			/**
 			 * @brief return the supported format between the given formats
 			 * 
@@ -214,6 +264,7 @@ namespace vk_engine{
 
 			std::vector<FamilyDetails> families;
 			std::vector<std::string> requiredExtensions;
+			std::set<std::string> supportedExtensions;
 			std::bitset<FEATURES_COUNT> requiredFeatures;
 			std::bitset<FAMILY_TYPE_COUNT> requiredFamilies;
 	};	
@@ -2,6 +2,14 @@
 
 #include "engine/LogicalDevice.hpp"
 #include "engine/SwapChain.hpp"
+#include "engine/PipelineCache.hpp"
+#include "engine/SpecializationConstants.hpp"
+#include "engine/ShaderModuleCache.hpp"
+#include "engine/PipelineLayoutCache.hpp"
+#include "engine/ExtendedDynamicState.hpp"
+#include "engine/GraphicsPipelineLibrary.hpp"
+#include "engine/PipelineManifest.hpp"
+#include "engine/PushDescriptor.hpp"
 
 // libs
 #include <vulkan/vulkan.h>
@@ -13,31 +21,50 @@
 #include <string>
 #include <vector>
 #include <memory>
+#include <mutex>
+#include <atomic>
+#include <future>
 
 namespace vk_engine{
 	class Pipeline{
 		public:
+			static constexpr uint32_t NO_PUSH_SET = ~0U;
+
 			struct ConfigInfo {
 				ConfigInfo(){defaultPipelineConfigInfo(*this);}
 
 				ConfigInfo(const ConfigInfo&) = delete;
 				ConfigInfo &operator=(const ConfigInfo&) = delete;
 
-				VkPipelineViewportStateCreateInfo viewportInfo;
-				VkPipelineInputAssemblyStateCreateInfo inputAssemblyInfo;
-				VkPipelineRasterizationStateCreateInfo rasterizationInfo;
-				VkPipelineMultisampleStateCreateInfo multisampleInfo;
-				VkPipelineColorBlendAttachmentState colorBlendAttachment;
-				VkPipelineColorBlendStateCreateInfo colorBlendInfo;
-				VkPipelineDepthStencilStateCreateInfo depthStencilInfo;
+				VkPipelineViewportStateCreateInfo viewportInfo{};
+				VkPipelineInputAssemblyStateCreateInfo inputAssemblyInfo{};
+				VkPipelineRasterizationStateCreateInfo rasterizationInfo{};
+				VkPipelineMultisampleStateCreateInfo multisampleInfo{};
+				VkPipelineColorBlendAttachmentState colorBlendAttachment{};
+				VkPipelineColorBlendStateCreateInfo colorBlendInfo{};
+				VkPipelineDepthStencilStateCreateInfo depthStencilInfo{};
 				std::vector<VkDynamicState> dynamicStateEnables;
-				VkPipelineDynamicStateCreateInfo dynamicStateInfo;
+				VkPipelineDynamicStateCreateInfo dynamicStateInfo{};
 				VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
 				VkRenderPass renderPass = VK_NULL_HANDLE;
 				uint32_t subpass = 0;
 			};
+
+			// the states set at bind time, in the command buffer if the device support the extended dynamic states, with a baked permutation if not
+			struct DrawState{
+				VkCullModeFlags cullMode = VK_CULL_MODE_NONE;
+				VkFrontFace frontFace = VK_FRONT_FACE_CLOCKWISE;
+				VkPrimitiveTopology topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+				bool depthTestEnable = true;
+				bool depthWriteEnable = true;
+				VkCompareOp depthCompareOp = VK_COMPARE_OP_LESS;
+				bool depthBiasEnable = false;
+				bool primitiveRestartEnable = false;
+				bool rasterizerDiscardEnable = false;
+			};
         
 			
+			Pipeline(LogicalDevice &device);
 			Pipeline(LogicalDevice &device, SwapChain &swapChain);
 			~Pipeline();
 
@@ -86,22 +113,212 @@ namespace vk_engine{
 			 * @param filepath the path to the file
 			 */
 			void setFragment(const std::string &filepath) {fragPath = filepath;}
+
+			/**
+			 * @brief set the value of a specialization constant of the given stage, the driver fold the constant when compiling the pipeline
+			 * 
+			 * @param stage the shader stage, VK_SHADER_STAGE_VERTEX_BIT or VK_SHADER_STAGE_FRAGMENT_BIT
+			 * @param constantID the constant_id of the constant in the shader
+			 * @param value the value of the constant (bool, int32_t, uint32_t, float, double)
+			 */
+			template<typename T> void setSpecializationConstant(VkShaderStageFlagBits stage, uint32_t constantID, const T &value){
+				assert(!builded && "cannot set a specialization constant of a builded pipeline");
+				getSpecializationConstants(stage).set(constantID, value);
+			}
+
+			/**
+			 * @brief get the specialization constants of the given stage
+			 * @param stage the shader stage, VK_SHADER_STAGE_VERTEX_BIT or VK_SHADER_STAGE_FRAGMENT_BIT
+			 * @return SpecializationConstants& 
+			 */
+			SpecializationConstants &getSpecializationConstants(VkShaderStageFlagBits stage);
+
+			/**
+			 * @brief get the hash of the pipeline state, shaders and specialization constants. Two pipelines with the same hash are identical
+			 * @return uint64_t 
+			 */
+			uint64_t getHash() const noexcept {return builded ? hash : computeHash();}
+
+			/**
+			 * @brief set the pipeline cache used on the build
+			 * @param cache the pipeline cache, must outlive the build
+			 */
+			void setPipelineCache(PipelineCache &cache) noexcept {this->cache = &cache;}
+
+			/**
+			 * @brief set the shader module cache used to load the shaders, the modules are shared with the other pipelines using the cache
+			 * @param cache the shader module cache, must outlive the build
+			 */
+			void setShaderModuleCache(ShaderModuleCache &cache) noexcept {moduleCache = &cache;}
+
+			/**
+			 * @brief set the layout cache used to create the pipeline layout from the reflection of the shaders, only used if the config has no pipelineLayout
+			 * @param cache the pipeline layout cache, must outlive the build
+			 */
+			void setPipelineLayoutCache(PipelineLayoutCache &cache) noexcept {layoutCache = &cache;}
+
+			/**
+			 * @brief use the draw states of bind(commandBuffer, state). The states supported by the device are set in the command buffer,
+			 * the others are baked in permutations of the pipeline created on the first use
+			 * 
+			 * @param dynamicState the extended dynamic state support of the device, must be builded and outlive the pipeline
+			 */
+			void setExtendedDynamicState(ExtendedDynamicState &dynamicState) noexcept {this->dynamicState = &dynamicState;}
+
+			/**
+			 * @brief mark a set of the reflected layout as a push set, its descriptors are written in the command buffer instead of being allocated.
+			 * without VK_KHR_push_descriptor the set is a regular set, see Renderer::pushDescriptorSet
+			 *
+			 * @param pushDescriptor the push descriptor support of the device, must be built
+			 * @param set the index of the push set
+			 */
+			void setPushDescriptorSet(const PushDescriptor &pushDescriptor, uint32_t set) noexcept {this->pushDescriptor = &pushDescriptor; pushSet = set; pushSetFlags = pushDescriptor.getSetLayoutFlags();}
+
+			/**
+			 * @brief use the given layout for a set of the reflected layout instead of reflecting it, required by the sets with an unbounded array
+			 *
+			 * @param set the index of the set
+			 * @param layout the layout of the set, e.g. BindlessTable::getLayout(), must outlive the pipeline
+			 */
+			void setSetLayout(uint32_t set, VkDescriptorSetLayout layout){
+				if (fixedSetLayouts.size() <= set) fixedSetLayouts.resize(set + 1, VK_NULL_HANDLE);
+				fixedSetLayouts[set] = layout;
+			}
+
+			/**
+			 * @brief create the pipeline by linking libraries shared with the other pipelines, if supported by the device.
+			 * the pipeline is fast linked on the build then replaced by an optimized pipeline linked on the thread pool of the library
+			 * 
+			 * @param library the graphics pipeline library, must be builded and outlive the pipeline
+			 */
+			void setGraphicsPipelineLibrary(GraphicsPipelineLibrary &library) noexcept {this->library = &library;}
+
+			/**
+			 * @brief record the pipeline, and its permutations, into the manifest on their creation
+			 * @param manifest the manifest, must outlive the pipeline
+			 */
+			void setPipelineManifest(PipelineManifest &manifest) noexcept {this->manifest = &manifest;}
+
+			/**
+			 * @brief get if the current pipeline is the final one, false while the optimized pipeline is linked in the background
+			 */
+			bool isOptimized() const noexcept {return optimized;}
+
+			/**
+			 * @brief bind the pipeline with the draw states of the config
+			 * @param commandBuffer the command buffer
+			 */
+			void bind(VkCommandBuffer commandBuffer);
+
+			/**
+			 * @brief bind the pipeline with the given draw states, require setExtendedDynamicState
+			 * @param commandBuffer the command buffer
+			 * @param state the draw states
+			 */
+			void bind(VkCommandBuffer commandBuffer, const DrawState &state);
+
+			/**
+			 * @brief create the permutation of the given draw states ahead of the first bind, nothing is created if the states are set in the command buffer
+			 * @param state the draw states
+			 */
+			void prepare(const DrawState &state) {getPermutation(state);}
+
+			/**
+			 * @brief get the count of baked permutations, the pipeline itself excluded
+			 * @return size_t 
+			 */
+			size_t getPermutationCount() const noexcept {return permutations.size();}
+
+			/**
+			 * @brief get the layout of the pipeline, available after the build
+			 * @return VkPipelineLayout 
+			 */
+			VkPipelineLayout getPipelineLayout() const noexcept {return pipelineLayout;}
+
+			/**
+			 * @brief get the index of the push set, NO_PUSH_SET if none
+			 * @return uint32_t
+			 */
+			uint32_t getPushSet() const noexcept {return pushSet;}
+
+			/**
+			 * @brief get the layout of the push set, available after the build
+			 * @return VkDescriptorSetLayout
+			 */
+			VkDescriptorSetLayout getPushSetLayout() const noexcept {return pushSetLayout;}
+
+			/**
+			 * @brief get the vulkan pipeline
+			 * @return VkPipeline 
+			 */
+			VkPipeline getPipeline() const noexcept {return pipeline;}
+
+			// operators
+			operator VkPipeline() const noexcept {return pipeline;}
 		
 		private:
+			friend class PipelineBatch;
+			friend class PipelineManifest;
+
+			// the structures referenced by the VkGraphicsPipelineCreateInfo, must stay alive until the vkCreateGraphicsPipelines call
+			struct CreateInfo{
+				VkPipelineShaderStageCreateInfo shaderStages[2];
+				VkPipelineVertexInputStateCreateInfo vertexInputInfo;
+				VkGraphicsPipelineCreateInfo pipelineInfo;
+			};
+
 			void createRenderPass(SwapChain &swapChain);
 			void createDescriptorSetLayout();
 			void createGraphicPipeline();
-			void createShaderModule(const std::vector<char>& code, VkShaderModule* shaderModule);
-			static std::vector<char> readFile(const std::string &filepath);
+			void createLinkedPipeline(CreateInfo &createInfo);
+			void prepareCreateInfo(CreateInfo &createInfo);
+			void onBuilded(VkPipeline pipeline);
+			uint64_t computeHash() const noexcept;
+			uint64_t computePartHash(VkGraphicsPipelineLibraryFlagBitsEXT part) const noexcept;
+			bool isDynamic(VkDynamicState state) const noexcept;
+			uint64_t getPermutationKey(const DrawState &state) const noexcept;
+			VkPipeline getPermutation(const DrawState &state);
+			void applyDrawState(const DrawState &state);
+			DrawState getDrawState() const noexcept;
+			void loadShader(const std::string &filepath, VkShaderModule &module, ShaderReflection &reflection);
+			void destroyShaderModules() noexcept;
+			void preparePushSet();
 
 			LogicalDevice &device;
+			PipelineCache *cache = nullptr;
+			ShaderModuleCache *moduleCache = nullptr;
+			PipelineLayoutCache *layoutCache = nullptr;
+			ExtendedDynamicState *dynamicState = nullptr;
+			GraphicsPipelineLibrary *library = nullptr;
+			PipelineManifest *manifest = nullptr;
 
-			VkPipeline pipeline = VK_NULL_HANDLE;
-			VkShaderModule vertShaderModule;
-			VkShaderModule fragShaderModule;
+			// replaced by the optimized pipeline when linked from libraries
+			std::atomic<VkPipeline> pipeline{VK_NULL_HANDLE};
+			VkPipeline fastLinkedPipeline = VK_NULL_HANDLE;
+			std::future<void> optimizing;
+			std::atomic<bool> optimized{false};
+			bool backgroundOptimization = true;
+			bool reflectedLayout = false;
+			VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
+
+			const PushDescriptor *pushDescriptor = nullptr;
+			uint32_t pushSet = NO_PUSH_SET;
+			VkDescriptorSetLayoutCreateFlags pushSetFlags = 0;
+			VkDescriptorSetLayout pushSetLayout = VK_NULL_HANDLE;
+			std::vector<VkDescriptorSetLayout> fixedSetLayouts;
+			VkShaderModule vertShaderModule = VK_NULL_HANDLE;
+			VkShaderModule fragShaderModule = VK_NULL_HANDLE;
 			
 			std::unique_ptr<ConfigInfo> config;
 			std::string vertPath, fragPath;
+			SpecializationConstants vertConstants, fragConstants;
+			uint64_t hash = 0;
+
+			// the config and the shader modules are kept to create the permutations
+			DrawState defaultState;
+			uint64_t defaultKey = 0;
+			std::unordered_map<uint64_t, VkPipeline> permutations;
+			std::mutex permutationsMutex;
 
 			bool builded = false;
 	};
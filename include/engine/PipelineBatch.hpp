@@ -0,0 +1,62 @@
+#pragma once
+
+#include "engine/LogicalDevice.hpp"
+#include "engine/Pipeline.hpp"
+#include "engine/PipelineCache.hpp"
+
+// libs
+#include <vulkan/vulkan.h>
+
+// std
+#include <vector>
+
+namespace vk_engine{
+	class PipelineBatch{
+		public:
+			PipelineBatch(LogicalDevice &device);
+			~PipelineBatch();
+
+			// avoid copy
+			PipelineBatch(const PipelineBatch &) = delete;
+			PipelineBatch &operator=(const PipelineBatch &) = delete;
+
+			/**
+			 * @brief add a pipeline to the batch, the pipeline must not be builded and must outlive the build of the batch
+			 * @param pipeline the pipeline to build with the batch
+			 */
+			void push(Pipeline &pipeline);
+
+			/**
+			 * @brief set the pipeline cache shared by all the pipelines of the batch
+			 * @param cache the pipeline cache
+			 */
+			void setPipelineCache(PipelineCache &cache) noexcept {this->cache = &cache;}
+
+			/**
+			 * @brief create the pipelines as derivatives of the first pushed pipeline
+			 * @param derivatives use the derivatives
+			 */
+			void useDerivatives(const bool &derivatives = true) noexcept {this->derivatives = derivatives;}
+
+			/**
+			 * @brief build all the pushed pipelines with a single vkCreateGraphicsPipelines call
+			 */
+			void build();
+
+			/**
+			 * @brief get the count of pipelines in the batch
+			 * @return size_t
+			 */
+			size_t size() const noexcept {return pipelines.size();}
+
+			// operators
+			void operator<<(Pipeline &pipeline) {push(pipeline);}
+
+		private:
+			LogicalDevice &device;
+			PipelineCache *cache = nullptr;
+
+			std::vector<Pipeline*> pipelines;
+			bool derivatives = false;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "engine/LogicalDevice.hpp"
+
+// libs
+#include <vulkan/vulkan.h>
+
+// std
+#include <string>
+#include <vector>
+
+namespace vk_engine{
+	class PipelineCache{
+		public:
+			PipelineCache(LogicalDevice &device);
+			~PipelineCache();
+
+			// avoid copy
+			PipelineCache(const PipelineCache &) = delete;
+			PipelineCache &operator=(const PipelineCache &) = delete;
+
+			/**
+			 * @brief set the file used to load the cache on build and to store it on save
+			 * @param filepath the path to the cache file
+			 */
+			void setFilepath(const std::string &filepath) noexcept {this->filepath = filepath;}
+
+			/**
+			 * @brief build the pipeline cache, load the cache file if it's exists and match the current device
+			 */
+			void build();
+
+			/**
+			 * @brief write the content of the cache into the cache file
+			 */
+			void save();
+
+			/**
+			 * @brief get the raw content of the cache
+			 * @return std::vector<char>
+			 */
+			std::vector<char> getData() const;
+
+			/**
+			 * @brief get the vulkan pipeline cache
+			 * @return VkPipelineCache
+			 */
+			VkPipelineCache get() const noexcept {return cache;}
+
+			// operators
+			operator VkPipelineCache() const noexcept {return cache;}
+
+		private:
+			bool isCompatible(const std::vector<char> &data) const noexcept;
+
+			LogicalDevice &device;
+			VkPipelineCache cache = VK_NULL_HANDLE;
+			std::string filepath;
+	};
+}
\ No newline at end of file
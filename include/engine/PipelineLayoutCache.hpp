@@ -0,0 +1,87 @@
+#pragma once
+
+#include "engine/LogicalDevice.hpp"
+#include "engine/DescriptorSetLayoutCache.hpp"
+#include "engine/ShaderReflection.hpp"
+
+// libs
+#include <vulkan/vulkan.h>
+
+// std
+#include <vector>
+#include <unordered_map>
+#include <mutex>
+
+namespace vk_engine{
+	class PipelineLayoutCache{
+		public:
+			PipelineLayoutCache(LogicalDevice &device, DescriptorSetLayoutCache &setLayoutCache);
+			~PipelineLayoutCache();
+
+			// avoid copy
+			PipelineLayoutCache(const PipelineLayoutCache &) = delete;
+			PipelineLayoutCache &operator=(const PipelineLayoutCache &) = delete;
+
+			/**
+			 * @brief get the pipeline layout of the given set layouts and push constant ranges, identical inputs always return the same layout.
+			 * the push constant ranges are sorted and the ranges with the same offset and size are merged
+			 *
+			 * @param setLayouts the descriptor set layouts, in set order
+			 * @param pushConstantRanges the push constant ranges
+			 * @return VkPipelineLayout
+			 */
+			VkPipelineLayout get(const std::vector<VkDescriptorSetLayout> &setLayouts, std::vector<VkPushConstantRange> pushConstantRanges = {});
+
+			/**
+			 * @brief get the pipeline layout used by the given shaders. The bindings of all the shaders are merged, the unused sets get an empty layout
+			 * and the push constants get a single range visible by all the stages using them
+			 *
+			 * @param shaders the reflections of the shaders of the pipeline
+			 * @param setFlags the creation flags of the set layouts, in set order, the missing sets have no flags
+			 * @param fixedSetLayouts the layouts used instead of the reflected ones, in set order, VK_NULL_HANDLE for a reflected set.
+			 * the unbounded descriptor arrays can only be in those sets, e.g. BindlessTable::getLayout() for res/shaders/bindless.glsl
+			 * @return VkPipelineLayout
+			 */
+			VkPipelineLayout getReflected(const std::vector<const ShaderReflection*> &shaders, const std::vector<VkDescriptorSetLayoutCreateFlags> &setFlags = {}, const std::vector<VkDescriptorSetLayout> &fixedSetLayouts = {});
+
+			/**
+			 * @brief get the set layouts of the given pipeline layout
+			 * @param layout a layout created by this cache
+			 * @return const std::vector<VkDescriptorSetLayout>&
+			 */
+			const std::vector<VkDescriptorSetLayout> &getSetLayouts(VkPipelineLayout layout);
+
+			/**
+			 * @brief get the descriptor set layout cache used by this cache
+			 * @return DescriptorSetLayoutCache&
+			 */
+			DescriptorSetLayoutCache &getSetLayoutCache() noexcept {return setLayoutCache;}
+
+			/**
+			 * @brief get the count of layouts in the cache
+			 * @return size_t
+			 */
+			size_t size() const noexcept {return layouts.size();}
+
+		private:
+			struct Key{
+				std::vector<VkDescriptorSetLayout> setLayouts;
+				std::vector<VkPushConstantRange> pushConstantRanges;
+
+				bool operator==(const Key &other) const noexcept;
+			};
+
+			struct KeyHash{
+				size_t operator()(const Key &key) const noexcept;
+			};
+
+			static void normalize(std::vector<VkPushConstantRange> &ranges);
+
+			LogicalDevice &device;
+			DescriptorSetLayoutCache &setLayoutCache;
+
+			std::unordered_map<Key, VkPipelineLayout, KeyHash> layouts;
+			std::unordered_map<VkPipelineLayout, const Key*> keys;
+			std::mutex mutex;
+	};
+}
\ No newline at end of file
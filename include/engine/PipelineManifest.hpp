@@ -0,0 +1,165 @@
+#pragma once
+
+#include "engine/LogicalDevice.hpp"
+#include "engine/PipelineCache.hpp"
+#include "engine/ShaderModuleCache.hpp"
+#include "engine/PipelineLayoutCache.hpp"
+#include "engine/GraphicsPipelineLibrary.hpp"
+#include "engine/ThreadPool.hpp"
+#include "engine/PushDescriptor.hpp"
+#include "engine/ExtendedDynamicState.hpp"
+
+// libs
+#include <vulkan/vulkan.h>
+
+// std
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <future>
+#include <mutex>
+#include <atomic>
+
+namespace vk_engine{
+	class Pipeline;
+
+	/**
+	 * @brief a file recording the states of the pipelines created at runtime, replayed on the next startup to fill the pipeline cache
+	 * before the pipelines are needed.
+	 * the render passes and the explicit pipeline layouts are not portable between runs, they are recorded as ids registered
+	 * by the user. The pipelines using an unregistered handle or a fixed set layout are not recorded. The manifest is bound to the device it was saved with
+	 */
+	class PipelineManifest{
+		public:
+			PipelineManifest(LogicalDevice &device);
+			~PipelineManifest();
+
+			// avoid copy
+			PipelineManifest(const PipelineManifest &) = delete;
+			PipelineManifest &operator=(const PipelineManifest &) = delete;
+
+			/**
+			 * @brief set the file used to load the manifest and to store it on save
+			 * @param filepath the path to the manifest file
+			 */
+			void setFilepath(const std::string &filepath) noexcept {this->filepath = filepath;}
+
+			/**
+			 * @brief load the manifest file if it exists
+			 */
+			void load();
+
+			/**
+			 * @brief write the recorded pipelines into the file, only if new pipelines have been recorded
+			 */
+			void save();
+
+			/**
+			 * @brief register a render pass under an id stable between the runs
+			 * @param id the id of the render pass
+			 * @param renderPass the render pass of the current run
+			 */
+			void registerRenderPass(uint32_t id, VkRenderPass renderPass);
+
+			/**
+			 * @brief register a pipeline layout under an id stable between the runs, the layouts created from the reflection of the shaders do not need to be registered
+			 * @param id the id of the pipeline layout
+			 * @param layout the pipeline layout of the current run
+			 */
+			void registerPipelineLayout(uint32_t id, VkPipelineLayout layout);
+
+			/**
+			 * @brief set the pipeline cache filled by the replay
+			 * @param cache the pipeline cache, must outlive the replay
+			 */
+			void setPipelineCache(PipelineCache &cache) noexcept {this->cache = &cache;}
+
+			/**
+			 * @brief set the shader module cache used by the replay
+			 * @param cache the shader module cache, must outlive the replay
+			 */
+			void setShaderModuleCache(ShaderModuleCache &cache) noexcept {moduleCache = &cache;}
+
+			/**
+			 * @brief set the layout cache used to recreate the reflected pipeline layouts
+			 * @param cache the pipeline layout cache, must outlive the replay
+			 */
+			void setPipelineLayoutCache(PipelineLayoutCache &cache) noexcept {layoutCache = &cache;}
+
+			/**
+			 * @brief replay into the graphics pipeline library, the libraries of the parts are kept alive by the library
+			 * @param library the graphics pipeline library, must outlive the replay
+			 */
+			void setGraphicsPipelineLibrary(GraphicsPipelineLibrary &library) noexcept {this->library = &library;}
+
+			/**
+			 * @brief set the push descriptor support given to the replayed pipelines using a push set
+			 * @param pushDescriptor the push descriptor support of the device, must be built and outlive the replay
+			 */
+			void setPushDescriptor(const PushDescriptor &pushDescriptor) noexcept {this->pushDescriptor = &pushDescriptor;}
+
+			/**
+			 * @brief set the extended dynamic state given to the replayed pipelines that used one
+			 * @param dynamicState the extended dynamic state support of the device, must be builded and outlive the replay
+			 */
+			void setExtendedDynamicState(ExtendedDynamicState &dynamicState) noexcept {this->dynamicState = &dynamicState;}
+
+			/**
+			 * @brief record the given pipeline, called by the pipelines using this manifest. The entries are keyed by the hash of their
+			 * serialized state, a pipeline already recorded in this run or a previous one is not added again
+			 * @param pipeline a pipeline with its config
+			 */
+			void record(const Pipeline &pipeline);
+
+			/**
+			 * @brief create the loaded pipelines on the thread pool and destroy them, only the pipeline cache keeps the result.
+			 * the entries referencing a missing file or an unregistered handle are skipped
+			 * 
+			 * @param threadPool the thread pool executing the replay
+			 */
+			void replay(ThreadPool &threadPool);
+
+			/**
+			 * @brief wait for the end of the replay
+			 */
+			void wait();
+
+			/**
+			 * @brief get the count of entries that failed to be replayed
+			 * @return uint32_t 
+			 */
+			uint32_t getFailedCount() const noexcept {return failedCount;}
+
+			/**
+			 * @brief get the count of pipelines in the manifest
+			 * @return size_t 
+			 */
+			size_t size() const noexcept {return entries.size();}
+
+		private:
+			static constexpr uint32_t MAGIC = 0x4D504B56; // VKPM
+			static constexpr uint32_t MANIFEST_VERSION = 3;
+			static constexpr uint32_t NO_ID = ~0U;
+
+			std::vector<char> serialize(const Pipeline &pipeline) const;
+			void replayEntry(const std::vector<char> &data);
+			bool isDeviceCompatible(const std::vector<char> &data, size_t &offset) const;
+
+			LogicalDevice &device;
+			PipelineCache *cache = nullptr;
+			ShaderModuleCache *moduleCache = nullptr;
+			PipelineLayoutCache *layoutCache = nullptr;
+			GraphicsPipelineLibrary *library = nullptr;
+			const PushDescriptor *pushDescriptor = nullptr;
+			ExtendedDynamicState *dynamicState = nullptr;
+
+			std::string filepath;
+			std::unordered_map<uint64_t, std::vector<char>> entries;
+			std::unordered_map<uint32_t, VkRenderPass> renderPasses;
+			std::unordered_map<uint32_t, VkPipelineLayout> pipelineLayouts;
+			std::vector<std::future<void>> replays;
+			std::atomic<uint32_t> failedCount{0};
+			std::mutex mutex;
+			bool modified = false;
+	};
+}
\ No newline at end of file
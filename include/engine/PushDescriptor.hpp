@@ -0,0 +1,70 @@
+#pragma once
+
+#include "engine/LogicalDevice.hpp"
+
+// libs
+#include <vulkan/vulkan.h>
+
+// std
+#include <vector>
+
+namespace vk_engine{
+	/**
+	 * @brief the VK_KHR_push_descriptor support of a device.
+	 * the extension is optional, isSupported() tells if the descriptors can be pushed in the command buffer, the users fall back on allocated sets if not
+	 */
+	class PushDescriptor{
+		public:
+			PushDescriptor(LogicalDevice &device);
+
+			// avoid copy
+			PushDescriptor(const PushDescriptor &) = delete;
+			PushDescriptor &operator=(const PushDescriptor &) = delete;
+
+			/**
+			 * @brief require the extension if the physical device support it, must be called before the build of the logical device
+			 */
+			void require();
+
+			/**
+			 * @brief load the commands if the extension is enabled, must be called after the build of the logical device
+			 */
+			void build();
+
+			/**
+			 * @brief get if VK_KHR_push_descriptor is enabled
+			 */
+			bool isSupported() const noexcept {return supported;}
+
+			/**
+			 * @brief get the max count of descriptors of a push set
+			 * @return uint32_t
+			 */
+			uint32_t getMaxPushDescriptors() const noexcept {return maxPushDescriptors;}
+
+			/**
+			 * @brief get the creation flags of the push set layouts, 0 if the extension is not supported
+			 * @return VkDescriptorSetLayoutCreateFlags
+			 */
+			VkDescriptorSetLayoutCreateFlags getSetLayoutFlags() const noexcept {return supported ? VK_DESCRIPTOR_SET_LAYOUT_CREATE_PUSH_DESCRIPTOR_BIT_KHR : 0;}
+
+			/**
+			 * @brief write the descriptors of the push set in the command buffer
+			 *
+			 * @param commandBuffer the command buffer
+			 * @param bindPoint the pipeline bind point
+			 * @param layout the pipeline layout
+			 * @param set the index of the push set in the layout
+			 * @param writes the descriptors, dstSet is ignored
+			 */
+			void push(VkCommandBuffer commandBuffer, VkPipelineBindPoint bindPoint, VkPipelineLayout layout, uint32_t set, const std::vector<VkWriteDescriptorSet> &writes) const noexcept {cmdPushDescriptorSet(commandBuffer, bindPoint, layout, set, static_cast<uint32_t>(writes.size()), writes.data());}
+
+		private:
+			LogicalDevice &device;
+
+			bool supported = false;
+			uint32_t maxPushDescriptors = 0;
+
+			PFN_vkCmdPushDescriptorSetKHR cmdPushDescriptorSet = nullptr;
+	};
+}
\ No newline at end of file
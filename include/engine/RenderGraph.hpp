@@ -0,0 +1,376 @@
+#pragma once
+
+#include "engine/LogicalDevice.hpp"
+#include "engine/Synchronization2.hpp"
+
+// libs
+#include <vulkan/vulkan.h>
+
+// std
+#include <vector>
+#include <string>
+#include <functional>
+#include <map>
+
+namespace vk_engine{
+	/**
+	 * @brief a frame graph, the passes declare the images and buffers they read and write and the graph derives the synchronization.
+	 * On the compilation, the passes not contributing to an output are culled, the transient resources used in disjoint parts of the frame share
+	 * the same memory and the barriers of each pass are batched into a single pipeline barrier, with the stages of each barrier with synchronization2.
+	 * The passes are executed in declaration order
+	 */
+	class RenderGraph{
+		public:
+			using ResourceId = uint32_t;
+			using PassId = uint32_t;
+			static constexpr ResourceId INVALID_RESOURCE = ~0U;
+
+			// an image created and owned by the graph
+			struct ImageInfo{
+				VkFormat format = VK_FORMAT_UNDEFINED;
+				VkExtent2D extent = {0, 0};
+				uint32_t layers = 1;
+				VkSampleCountFlagBits samples = VK_SAMPLE_COUNT_1_BIT;
+
+				// added to the usages derived from the passes
+				VkImageUsageFlags usage = 0;
+			};
+
+			// an image owned by the user, like the swap chain images
+			struct ImportedImageInfo{
+				VkImage image = VK_NULL_HANDLE;
+				VkImageView view = VK_NULL_HANDLE;
+				VkFormat format = VK_FORMAT_UNDEFINED;
+				VkExtent2D extent = {0, 0};
+				VkSampleCountFlagBits samples = VK_SAMPLE_COUNT_1_BIT;
+
+				// the state of the image at the begin of the graph, the stage is waited by the first barrier (the acquire semaphore stage for a swap chain image)
+				VkImageLayout initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+				VkPipelineStageFlags initialStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+				VkAccessFlags initialAccess = 0;
+
+				// the layout of the image at the end of the graph, VK_IMAGE_LAYOUT_UNDEFINED to keep the layout of the last pass
+				VkImageLayout finalLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+			};
+
+			// a buffer created and owned by the graph
+			struct BufferInfo{
+				VkDeviceSize size = 0;
+
+				// added to the usages derived from the passes
+				VkBufferUsageFlags usage = 0;
+			};
+
+			// declare the resources used by a pass
+			class PassBuilder{
+				public:
+					/**
+					 * @brief render into the given image, the attachments are bound in declaration order
+					 * @param image the color image
+					 * @param loadOp the load operation, VK_ATTACHMENT_LOAD_OP_LOAD reads the previous content
+					 * @param clearColor the clear value if cleared
+					 */
+					void writeColor(ResourceId image, VkAttachmentLoadOp loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR, VkClearColorValue clearColor = {{0.f, 0.f, 0.f, 0.f}});
+
+					/**
+					 * @brief use the given image as the depth stencil attachment
+					 * @param image the depth image
+					 * @param loadOp the load operation, VK_ATTACHMENT_LOAD_OP_LOAD reads the previous content
+					 * @param clearValue the clear value if cleared
+					 */
+					void writeDepth(ResourceId image, VkAttachmentLoadOp loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR, VkClearDepthStencilValue clearValue = {1.f, 0});
+
+					/**
+					 * @brief sample the given image in the shaders
+					 * @param image the image
+					 * @param stages the shader stages sampling the image
+					 */
+					void readTexture(ResourceId image, VkPipelineStageFlags stages = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+
+					/**
+					 * @brief read the given storage image in the shaders
+					 * @param image the image
+					 * @param stages the shader stages reading the image
+					 */
+					void readStorageImage(ResourceId image, VkPipelineStageFlags stages = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+					/**
+					 * @brief write the given storage image in the shaders
+					 * @param image the image
+					 * @param stages the shader stages writing the image
+					 */
+					void writeStorageImage(ResourceId image, VkPipelineStageFlags stages = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+					/**
+					 * @brief read the given buffer
+					 *
+					 * @param buffer the buffer
+					 * @param stages the stages reading the buffer
+					 * @param access the kind of reads
+					 * @param usage the usage required by the reads
+					 */
+					void readBuffer(ResourceId buffer, VkPipelineStageFlags stages, VkAccessFlags access = VK_ACCESS_SHADER_READ_BIT, VkBufferUsageFlags usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+
+					/**
+					 * @brief write the given buffer
+					 *
+					 * @param buffer the buffer
+					 * @param stages the stages writing the buffer
+					 * @param access the kind of writes
+					 * @param usage the usage required by the writes
+					 */
+					void writeBuffer(ResourceId buffer, VkPipelineStageFlags stages, VkAccessFlags access = VK_ACCESS_SHADER_WRITE_BIT, VkBufferUsageFlags usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+
+					/**
+					 * @brief keep the pass even if its outputs are not used, for the passes writing outside of the graph
+					 */
+					void setSideEffects() noexcept;
+
+				private:
+					friend class RenderGraph;
+					PassBuilder(RenderGraph &graph, PassId pass) : graph{graph}, pass{pass}{}
+
+					RenderGraph &graph;
+					PassId pass;
+			};
+
+			// record the commands of a pass, inside of its render pass for a graphic pass
+			using Execute = std::function<void(VkCommandBuffer commandBuffer)>;
+
+			RenderGraph(LogicalDevice &device);
+			~RenderGraph();
+
+			// avoid copy
+			RenderGraph(const RenderGraph &) = delete;
+			RenderGraph &operator=(const RenderGraph &) = delete;
+
+			/**
+			 * @brief record the barriers with vkCmdPipelineBarrier2KHR if the device support it
+			 * @param synchronization2 the built synchronization2 support, must outlive the graph
+			 */
+			void setSynchronization2(const Synchronization2 &synchronization2) noexcept {this->synchronization2 = &synchronization2;}
+
+			/**
+			 * @brief declare a transient image, created on the compilation
+			 * @param name the name of the image
+			 * @param info the description of the image
+			 * @return ResourceId
+			 */
+			ResourceId createImage(const std::string &name, const ImageInfo &info);
+
+			/**
+			 * @brief declare a transient buffer, created on the compilation
+			 * @param name the name of the buffer
+			 * @param info the description of the buffer
+			 * @return ResourceId
+			 */
+			ResourceId createBuffer(const std::string &name, const BufferInfo &info);
+
+			/**
+			 * @brief use an image owned by the user, the imported resources are outputs of the graph
+			 * @param name the name of the image
+			 * @param info the image and its states
+			 * @return ResourceId
+			 */
+			ResourceId importImage(const std::string &name, const ImportedImageInfo &info);
+
+			/**
+			 * @brief use a buffer owned by the user, the imported resources are outputs of the graph
+			 *
+			 * @param name the name of the buffer
+			 * @param buffer the buffer
+			 * @param size the size of the buffer
+			 * @param initialStage the stages of the last access before the graph, waited by the first barrier (like the transfer of an upload)
+			 * @param initialAccess the last write before the graph, made visible by the first barrier
+			 * @return ResourceId
+			 */
+			ResourceId importBuffer(const std::string &name, VkBuffer buffer, VkDeviceSize size, VkPipelineStageFlags initialStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VkAccessFlags initialAccess = 0);
+
+			/**
+			 * @brief change the handles of an imported image, like the swap chain image of the frame. The image must have the same format and extent
+			 *
+			 * @param image the imported image
+			 * @param vkImage the new image
+			 * @param view the new view
+			 */
+			void setImportedImage(ResourceId image, VkImage vkImage, VkImageView view);
+
+			/**
+			 * @brief keep the passes writing the given resource
+			 * @param resource the resource read after the execution of the graph
+			 */
+			void setOutput(ResourceId resource);
+
+			/**
+			 * @brief add a pass, executed after the previously added ones
+			 *
+			 * @param name the name of the pass
+			 * @param setup declare the resources used by the pass
+			 * @param execute record the commands of the pass
+			 * @return PassId
+			 */
+			PassId addPass(const std::string &name, const std::function<void(PassBuilder&)> &setup, Execute execute);
+
+			/**
+			 * @brief cull the passes, create the transient resources and the render passes and compute the barriers
+			 */
+			void compile();
+
+			/**
+			 * @brief record the passes and their barriers
+			 * @param commandBuffer the command buffer
+			 */
+			void execute(VkCommandBuffer commandBuffer);
+
+			/**
+			 * @brief destroy the resources and remove the passes, to declare the graph again (after a resize)
+			 * the resources must not be used by the device anymore
+			 */
+			void clear();
+
+			/**
+			 * @brief get the render pass of a graphic pass, available after the compilation
+			 * @param pass the pass
+			 * @return VkRenderPass, VK_NULL_HANDLE if the pass has no attachments or is culled
+			 */
+			VkRenderPass getRenderPass(PassId pass) const;
+
+			/**
+			 * @brief get if the pass is culled, available after the compilation
+			 * @param pass the pass
+			 */
+			bool isCulled(PassId pass) const;
+
+			VkImage getImage(ResourceId image) const;
+			VkImageView getImageView(ResourceId image) const;
+			VkBuffer getBuffer(ResourceId buffer) const;
+
+			/**
+			 * @brief get the count of device memory allocations of the transient resources
+			 * @return size_t
+			 */
+			size_t getMemoryBlockCount() const noexcept {return blocks.size();}
+
+		private:
+			struct Resource{
+				std::string name;
+				bool isImage = true;
+				bool imported = false;
+				bool output = false;
+
+				VkFormat format = VK_FORMAT_UNDEFINED;
+				VkExtent2D extent = {0, 0};
+				uint32_t layers = 1;
+				VkSampleCountFlagBits samples = VK_SAMPLE_COUNT_1_BIT;
+				VkImageUsageFlags imageUsage = 0;
+				VkImage image = VK_NULL_HANDLE;
+				VkImageView view = VK_NULL_HANDLE;
+
+				VkImageLayout initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+				VkPipelineStageFlags initialStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+				VkAccessFlags initialAccess = 0;
+				VkImageLayout finalLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+				VkDeviceSize size = 0;
+				VkBufferUsageFlags bufferUsage = 0;
+				VkBuffer buffer = VK_NULL_HANDLE;
+
+				// the first and last alive passes using the resource
+				uint32_t firstPass = ~0U;
+				uint32_t lastPass = 0;
+				int block = -1;
+			};
+
+			struct Access{
+				ResourceId resource;
+				VkImageLayout layout;
+				VkPipelineStageFlags stages;
+				VkAccessFlags access;
+				bool read;
+				bool write;
+			};
+
+			struct Attachment{
+				ResourceId resource;
+				VkAttachmentLoadOp loadOp;
+				VkClearValue clearValue;
+			};
+
+			struct ImageBarrier{
+				ResourceId resource;
+				VkImageMemoryBarrier2KHR barrier;
+			};
+
+			struct BufferBarrier{
+				ResourceId resource;
+				VkBufferMemoryBarrier2KHR barrier;
+			};
+
+			// the barriers of a pass, recorded in a single pipeline barrier
+			struct Barriers{
+				std::vector<ImageBarrier> images;
+				std::vector<BufferBarrier> buffers;
+
+				void record(VkCommandBuffer commandBuffer, const std::vector<Resource> &resources, const Synchronization2 *synchronization2) const;
+			};
+
+			struct Pass{
+				std::string name;
+				std::vector<Access> accesses;
+				std::vector<Attachment> colorAttachments;
+				Attachment depthAttachment{INVALID_RESOURCE, VK_ATTACHMENT_LOAD_OP_DONT_CARE, {}};
+				bool sideEffects = false;
+				bool culled = false;
+				Execute execute;
+
+				VkRenderPass renderPass = VK_NULL_HANDLE;
+				std::map<std::vector<VkImageView>, VkFramebuffer> framebuffers;
+				Barriers barriers;
+			};
+
+			// a device memory allocation shared by the transient resources with disjoint lifetimes
+			struct MemoryBlock{
+				VkDeviceMemory memory = VK_NULL_HANDLE;
+				VkDeviceSize size = 0;
+				uint32_t memoryTypeBits = 0;
+				bool isImage = true;
+				std::vector<ResourceId> resources;
+
+				// all the stages and writes on the memory, waited by the first use of a resource of the block
+				VkPipelineStageFlags stages = 0;
+				VkAccessFlags writeAccess = 0;
+			};
+
+			// the synchronization state of a resource during the compilation
+			struct State{
+				VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+				VkPipelineStageFlags writeStages = 0;
+				VkAccessFlags writeAccess = 0;
+				VkPipelineStageFlags readStages = 0;
+
+				// the stages and accesses already synchronized with the last write
+				VkPipelineStageFlags visibleStages = 0;
+				VkAccessFlags visibleAccess = 0;
+			};
+
+			void addAccess(PassId pass, const Access &access, VkFlags usage);
+			void cullPasses();
+			void computeLifetimes();
+			void createResources();
+			void allocateMemory(const std::vector<ResourceId> &transients);
+			void createRenderPasses();
+			void computeBarriers();
+			void addBarrier(Barriers &barriers, State &state, const Access &access);
+			VkFramebuffer getFramebuffer(Pass &pass);
+			bool isUsedAfter(ResourceId resource, PassId pass) const;
+
+			LogicalDevice &device;
+			const Synchronization2 *synchronization2 = nullptr;
+
+			std::vector<Resource> resources;
+			std::vector<Pass> passes;
+			std::vector<MemoryBlock> blocks;
+			Barriers finalBarriers;
+			bool compiled = false;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,270 @@
+#pragma once
+
+#include "engine/LogicalDevice.hpp"
+#include "engine/Pipeline.hpp"
+#include "engine/ThreadPool.hpp"
+#include "engine/Buffer.hpp"
+
+// libs
+#include <vulkan/vulkan.h>
+#include <glm/mat4x4.hpp>
+
+// std
+#include <vector>
+#include <unordered_map>
+#include <memory>
+#include <cstdint>
+#include <cassert>
+
+namespace vk_engine{
+	/**
+	 * @brief collect the draws of a frame with a 64 bits sort key, sort them and record them with the fewest state changes.
+	 * the key is, from the most significant bits, the pass, the pipeline, the material and the depth, so the sorted draws are
+	 * grouped by pass then pipeline then material. The draws are pushed from a single thread, the sort is split on the thread pool.
+	 * The draws pushed with a transform are instanced, the consecutive draws of the same mesh and material are recorded as a single
+	 * instanced draw reading its transforms from the instance buffer of the frame (see res/shaders/instancing.glsl)
+	 */
+	class RenderQueue{
+		public:
+			// the bits of each field of the key, from the most significant
+			static constexpr uint32_t PASS_BITS = 8;
+			static constexpr uint32_t PIPELINE_BITS = 12;
+			static constexpr uint32_t MATERIAL_BITS = 20;
+			static constexpr uint32_t DEPTH_BITS = 24;
+
+			static constexpr uint32_t DEPTH_SHIFT = 0;
+			static constexpr uint32_t MATERIAL_SHIFT = DEPTH_SHIFT + DEPTH_BITS;
+			static constexpr uint32_t PIPELINE_SHIFT = MATERIAL_SHIFT + MATERIAL_BITS;
+			static constexpr uint32_t PASS_SHIFT = PIPELINE_SHIFT + PIPELINE_BITS;
+
+			// the payload of a draw, the buffers are not owned by the queue
+			struct Draw{
+				Pipeline *pipeline = nullptr;
+
+				// the set bound at the material set index (see setMaterialSet), VK_NULL_HANDLE to keep the bound set
+				VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+
+				VkBuffer vertexBuffer = VK_NULL_HANDLE;
+				VkDeviceSize vertexBufferOffset = 0;
+
+				// VK_NULL_HANDLE for a non indexed draw
+				VkBuffer indexBuffer = VK_NULL_HANDLE;
+				VkDeviceSize indexBufferOffset = 0;
+				VkIndexType indexType = VK_INDEX_TYPE_UINT32;
+
+				// the count and the first of the indices, or of the vertices without index buffer
+				uint32_t count = 0;
+				uint32_t first = 0;
+				int32_t vertexOffset = 0;
+				uint32_t instanceCount = 1;
+				uint32_t firstInstance = 0;
+			};
+
+			// the commands recorded by the last submits
+			struct Stats{
+				uint32_t draws = 0;
+				uint32_t pipelineBinds = 0;
+				uint32_t descriptorSetBinds = 0;
+				uint32_t vertexBufferBinds = 0;
+				uint32_t indexBufferBinds = 0;
+
+				// the transforms written in the instance buffer
+				uint32_t instances = 0;
+			};
+
+			RenderQueue(LogicalDevice &device);
+
+			// avoid copy
+			RenderQueue(const RenderQueue &) = delete;
+			RenderQueue &operator=(const RenderQueue &) = delete;
+
+			/**
+			 * @brief split the sort of the large queues on the workers of the thread pool
+			 * @param threadPool the thread pool, must outlive the queue
+			 */
+			void setThreadPool(ThreadPool &threadPool) noexcept {this->threadPool = &threadPool;}
+
+			/**
+			 * @brief set the index of the descriptor set bound with the set of the draws
+			 * @param set the index of the set in the pipeline layouts
+			 */
+			void setMaterialSet(uint32_t set) noexcept {materialSet = set;}
+
+			/**
+			 * @brief set the count of transforms of the instance buffer of each frame, 0 to disable the instancing
+			 * @param capacity the count of transforms
+			 */
+			void setInstanceCapacity(uint32_t capacity) noexcept {instanceCapacity = capacity;}
+
+			/**
+			 * @brief set the count of frames in flight, each frame has its own instance buffer
+			 * @param count the count of frames
+			 */
+			void setFramesInFlight(uint32_t count) noexcept {framesInFlight = count;}
+
+			/**
+			 * @brief create the instance buffers
+			 */
+			void build();
+
+			/**
+			 * @brief clear the queue and write the next instances in the buffer of the given frame, the fence of the frame must be signaled
+			 * @param frameIndex the index of the frame in flight
+			 */
+			void beginFrame(uint32_t frameIndex);
+
+			/**
+			 * @brief add a draw with the given key
+			 *
+			 * @param key the sort key, see makeKey
+			 * @param draw the draw
+			 */
+			void push(uint64_t key, const Draw &draw);
+
+			/**
+			 * @brief add a draw keyed by its pipeline and its descriptor set, their ids in the key are given on their first push of the frame
+			 *
+			 * @param draw the draw
+			 * @param pass the pass of the draw, the passes are sorted in increasing order
+			 * @param depth the normalized depth of the draw in [0, 1], draws of the same material are sorted front to back
+			 * @param backToFront sort the draws of the same material back to front, for the transparent draws
+			 */
+			void push(const Draw &draw, uint32_t pass, float depth = 0.f, bool backToFront = false);
+
+			/**
+			 * @brief add an instance of a draw, the transform is read with gl_InstanceIndex.
+			 * the depth field of the key holds the id of the mesh so the instances of a mesh are consecutive, except for the back to front draws
+			 *
+			 * @param draw the draw, with a single instance
+			 * @param transform the transform of the instance
+			 * @param pass the pass of the draw
+			 * @param depth the normalized depth of the draw in [0, 1], only used by the back to front draws
+			 * @param backToFront sort the draws of the same material back to front, for the transparent draws
+			 */
+			void push(const Draw &draw, const glm::mat4 &transform, uint32_t pass, float depth = 0.f, bool backToFront = false);
+
+			/**
+			 * @brief sort the draws by key, draws with the same key keep their push order
+			 */
+			void sort();
+
+			/**
+			 * @brief record all the sorted draws, the binds already done by the previous draw are skipped.
+			 * the states bound before the call are ignored, the first draw binds all of its states
+			 * @param commandBuffer the command buffer
+			 */
+			void submit(VkCommandBuffer commandBuffer);
+
+			/**
+			 * @brief record the sorted draws of the given pass
+			 * @param commandBuffer the command buffer
+			 * @param pass the pass
+			 */
+			void submit(VkCommandBuffer commandBuffer, uint32_t pass);
+
+			/**
+			 * @brief remove the draws, the ids of the pipelines, descriptor sets and meshes and reset the stats. The descriptor sets
+			 * allocated each frame are new handles, the ids are only kept for a frame so they stay in the bits of the key.
+			 * the instances already written stay in the buffer of the frame until the next beginFrame
+			 */
+			void clear();
+
+			/**
+			 * @brief get the instance buffer of a frame, bound as the storage buffer of the transforms
+			 * @param frameIndex the index of the frame in flight
+			 * @return Buffer&
+			 */
+			Buffer &getInstanceBuffer(uint32_t frameIndex) const {
+				assert(frameIndex < instanceBuffers.size() && "invalid frame index");
+				return *instanceBuffers[frameIndex];
+			}
+
+			/**
+			 * @brief get the count of draws in the queue
+			 * @return size_t
+			 */
+			size_t size() const noexcept {return items.size();}
+
+			/**
+			 * @brief get the commands recorded since the last clear
+			 * @return const Stats&
+			 */
+			const Stats &getStats() const noexcept {return stats;}
+
+			/**
+			 * @brief pack the fields into a sort key, each field must fit in its bits
+			 *
+			 * @param pass the pass
+			 * @param pipeline the id of the pipeline
+			 * @param material the id of the material
+			 * @param depth the quantized depth, see quantizeDepth
+			 * @return uint64_t
+			 */
+			static uint64_t makeKey(uint32_t pass, uint32_t pipeline, uint32_t material, uint32_t depth) noexcept;
+
+			/**
+			 * @brief quantize a normalized depth on DEPTH_BITS bits, clamped in [0, 1]
+			 * @param depth the depth
+			 * @return uint32_t
+			 */
+			static uint32_t quantizeDepth(float depth) noexcept;
+
+			/**
+			 * @brief get the pass of a key
+			 * @param key the key
+			 * @return uint32_t
+			 */
+			static uint32_t getPass(uint64_t key) noexcept {return static_cast<uint32_t>(key >> PASS_SHIFT);}
+
+		private:
+			static constexpr uint32_t NO_TRANSFORM = ~0U;
+
+			struct Item{
+				uint64_t key;
+				uint32_t draw;
+
+				// the index in transforms, NO_TRANSFORM for a draw not instanced
+				uint32_t transform;
+			};
+
+			struct BoundState{
+				Pipeline *pipeline = nullptr;
+				VkPipelineLayout layout = VK_NULL_HANDLE;
+				VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+				VkBuffer vertexBuffer = VK_NULL_HANDLE;
+				VkDeviceSize vertexBufferOffset = 0;
+				VkBuffer indexBuffer = VK_NULL_HANDLE;
+				VkDeviceSize indexBufferOffset = 0;
+				VkIndexType indexType = VK_INDEX_TYPE_UINT32;
+			};
+
+			void record(VkCommandBuffer commandBuffer, size_t begin, size_t end);
+			size_t writeInstances(size_t begin, size_t end, uint32_t &firstInstance);
+			uint32_t getPipelineId(const Pipeline *pipeline);
+			uint32_t getMaterialId(VkDescriptorSet descriptorSet);
+			uint32_t getMeshId(const Draw &draw);
+			static bool sameMesh(const Draw &a, const Draw &b) noexcept;
+
+			LogicalDevice &device;
+			ThreadPool *threadPool = nullptr;
+			uint32_t materialSet = 0;
+
+			uint32_t instanceCapacity = 0;
+			uint32_t framesInFlight = 2;
+			uint32_t currentFrame = 0;
+			uint32_t instanceCount = 0;
+			std::vector<std::unique_ptr<Buffer>> instanceBuffers;
+
+			std::vector<Draw> draws;
+			std::vector<glm::mat4> transforms;
+			std::vector<Item> items;
+			std::vector<Item> sortBuffer;
+			bool sorted = true;
+
+			std::unordered_map<const Pipeline*, uint32_t> pipelineIds;
+			std::unordered_map<uint64_t, uint32_t> materialIds;
+			std::unordered_map<uint64_t, uint32_t> meshIds;
+
+			Stats stats;
+	};
+}
\ No newline at end of file
@@ -3,6 +3,13 @@
 #include "engine/LogicalDevice.hpp"
 #include "engine/SwapChain.hpp"
 #include "engine/CommandPool.hpp"
+#include "engine/FrameCommandPool.hpp"
+#include "engine/DescriptorAllocator.hpp"
+#include "engine/BindlessTable.hpp"
+#include "engine/PushDescriptor.hpp"
+#include "engine/Pipeline.hpp"
+#include "engine/ParallelRecorder.hpp"
+#include "engine/ImageStateTracker.hpp"
 
 // libs
 #include <vulkan/vulkan.hpp>
@@ -37,9 +44,18 @@ namespace vk_engine{
 			 */
 			VkCommandBuffer getCurrentCommandBuffer() const {
 				assert(isFrameStarted && "Cannot get command buffer whene frame not in progress");
-				return commandBuffers[currentFrameIndex];
+				return currentCommandBuffer;
 			};
 
+			/**
+			 * @brief get the command pool of the current frame, its command buffers are valid until the next use of the frame
+			 * @return FrameCommandPool& 
+			 */
+			FrameCommandPool &getFrameCommandPool() const {
+				assert(isFrameStarted && "Cannot get command pool whene frame not in progress");
+				return *framePools[currentFrameIndex];
+			}
+
 			/**
 			 * @brief get the current frame index
 			 * @return int 
@@ -49,12 +65,68 @@ namespace vk_engine{
 				return currentFrameIndex;
 			}
 
+			/**
+			 * @brief get the index of the swap chain image acquired for the current frame
+			 * @return uint32_t 
+			 */
+			uint32_t getImageIndex() const {
+				assert(isFrameStarted && "Cannot get image index whene frame not in progress");
+				return currentImageIndex;
+			}
+
+			/**
+			 * @brief get the state tracker of the swap chain images, shared with the images of the user (see Image::setStateTracker).
+			 * the acquired image is in VK_IMAGE_LAYOUT_UNDEFINED and must be in VK_IMAGE_LAYOUT_PRESENT_SRC_KHR at the end of the frame
+			 * @return ImageStateTracker& 
+			 */
+			ImageStateTracker &getImageStates() noexcept {return imageStates;}
+
 			/**
 			 * @brief get a reference to the swapChain to chang attributes before the build
 			 * @return SwapChain& 
 			 */
 			SwapChain &getSwapChain() noexcept {return *swapChain.get();}
 
+			/**
+			 * @brief get the allocator of the transient descriptor sets, the sets are valid until the end of the frame
+			 * @return DescriptorAllocator& 
+			 */
+			DescriptorAllocator &getDescriptorAllocator() noexcept {return descriptorAllocator;}
+
+			/**
+			 * @brief advance the frames of the bindless table with the frames of the renderer
+			 * @param table the bindless table, must outlive the renderer
+			 */
+			void setBindlessTable(BindlessTable &table) noexcept {bindlessTable = &table;}
+
+			/**
+			 * @brief set the push descriptor support used by pushDescriptorSet
+			 * @param pushDescriptor the push descriptor support of the device, must outlive the renderer
+			 */
+			void setPushDescriptor(const PushDescriptor &pushDescriptor) noexcept {this->pushDescriptor = &pushDescriptor;}
+
+			/**
+			 * @brief record the barriers of the renderer with synchronization2 if the device support it, must be called before the build
+			 * @param synchronization2 the built synchronization2 support, must outlive the renderer
+			 */
+			void setSynchronization2(const Synchronization2 &synchronization2);
+
+			/**
+			 * @brief enable the parallel recording of the swap chain render pass, see recordSwapChainRenderPass. must be called before the build
+			 * @param threadPool the workers recording the secondary command buffers, must outlive the renderer
+			 */
+			void setThreadPool(ThreadPool &threadPool);
+
+			/**
+			 * @brief write the descriptors of the push set of the pipeline in the command buffer.
+			 * without VK_KHR_push_descriptor a set of the current frame is allocated, written and bound instead
+			 *
+			 * @param commandBuffer the command buffer of the current frame
+			 * @param pipeline the bound pipeline, with a push set
+			 * @param writes the descriptors, dstSet is ignored
+			 */
+			void pushDescriptorSet(VkCommandBuffer commandBuffer, const Pipeline &pipeline, std::vector<VkWriteDescriptorSet> writes);
+
 			/**
 			 * @brief construct the renderer
 			 */
@@ -74,8 +146,20 @@ namespace vk_engine{
 			/**
 			 * @brief begin the renderPass
 			 * @param commandBuffer 
+			 * @param contents VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS to record the pass with recordSwapChainRenderPass
+			 */
+			void beginSwapChainRenderPass(VkCommandBuffer commandBuffer, VkSubpassContents contents = VK_SUBPASS_CONTENTS_INLINE);
+
+			/**
+			 * @brief record the content of the swap chain render pass on the workers of the thread pool. The tasks get secondary command buffers
+			 * with the viewport and the scissor already set, they are executed in task order.
+			 * the render pass must be begun with VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS
+			 *
+			 * @param commandBuffer the command buffer of the current frame
+			 * @param taskCount the count of secondary command buffers to record, a few per worker balance the load
+			 * @param task the recording function, called from the workers with the secondary command buffer and the index of the task
 			 */
-			void beginSwapChainRenderPass(VkCommandBuffer commandBuffer);
+			void recordSwapChainRenderPass(VkCommandBuffer commandBuffer, uint32_t taskCount, const ParallelRecorder::Task &task);
 
 			/**
 			 * @brief end the renderPass
@@ -115,15 +199,24 @@ namespace vk_engine{
 			void setAutoUpdateViewportSize(bool autoUpdate) noexcept {autoUpdateViewportSize = autoUpdate;}
 		
 		private:
-			void createCommandBuffers();
-			void freeCommandBuffers();
+			void createFramePools();
 			void recreateSwapChain();
+			void trackSwapChainImages();
 			
 			LogicalDevice &device;
 			CommandPool &commandPool;
 
+			// before the swap chain, the destruction of the swap chain removes its images
+			ImageStateTracker imageStates;
 			std::unique_ptr<SwapChain> swapChain;
-			std::vector<VkCommandBuffer> commandBuffers{};
+			DescriptorAllocator descriptorAllocator;
+			BindlessTable *bindlessTable = nullptr;
+			const PushDescriptor *pushDescriptor = nullptr;
+			std::unique_ptr<ParallelRecorder> parallelRecorder;
+
+			// reset once per frame instead of once per command buffer
+			std::vector<std::unique_ptr<FrameCommandPool>> framePools;
+			VkCommandBuffer currentCommandBuffer = VK_NULL_HANDLE;
 
 			uint32_t currentImageIndex = 0;
 			int currentFrameIndex = 0;
@@ -0,0 +1,97 @@
+#pragma once
+
+#include "engine/MappedFile.hpp"
+
+// std
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace vk_engine{
+	/**
+	 * @brief a memory mapped file packing the SPIR-V code of all the shader variants, written by tools/shader_compiler.
+	 * a variant is found with a single probe of an open addressing hash table stored in the file
+	 * 
+	 * layout : Header, Slot[slotCount], then the SPIR-V code of each variant aligned on 8 bytes
+	 */
+	class ShaderArchive{
+		public:
+			static constexpr uint32_t MAGIC = 0x41534B56; // VKSA
+			static constexpr uint32_t ARCHIVE_VERSION = 1;
+			static constexpr uint32_t CODE_ALIGNMENT = 8;
+
+			struct Header{
+				uint32_t magic;
+				uint32_t version;
+				uint32_t entryCount;
+				uint32_t slotCount; // power of two
+			};
+
+			// an empty slot has a key of 0
+			struct Slot{
+				uint64_t key;
+				uint32_t offset;
+				uint32_t size;
+			};
+
+			/**
+			 * @brief get the name of a variant, the name of the source file relative to the shader directory followed by the sorted keywords
+			 * @param name the name of the source file, e.g. "shader.frag"
+			 * @param keywords the enabled keywords of the variant
+			 * @return std::string e.g. "shader.frag|ALPHA_TEST|SKINNING"
+			 */
+			static std::string getVariantName(const std::string &name, std::vector<std::string> keywords);
+
+			/**
+			 * @brief get the key of the given variant in the hash table
+			 * @param variantName the name of the variant
+			 * @return uint64_t never 0
+			 */
+			static uint64_t getKey(const std::string &variantName) noexcept;
+
+			ShaderArchive() = default;
+
+			/**
+			 * @brief open the given archive
+			 * @param filepath the path to the archive
+			 */
+			ShaderArchive(const std::string &filepath);
+
+			// avoid copy
+			ShaderArchive(const ShaderArchive &) = delete;
+			ShaderArchive &operator=(const ShaderArchive &) = delete;
+
+			/**
+			 * @brief map the archive and check the header, throw if the file is not a valid archive
+			 * @param filepath the path to the archive
+			 */
+			void open(const std::string &filepath);
+
+			/**
+			 * @brief find the SPIR-V code of the given variant
+			 * 
+			 * @param variantName the name of the variant, see getVariantName
+			 * @param code set to the code in the mapped file if found
+			 * @param wordCount set to the count of words of the code if found
+			 * @return true if found, false if not
+			 */
+			bool find(const std::string &variantName, const uint32_t *&code, size_t &wordCount) const;
+
+			/**
+			 * @brief get if the archive contains the given variant
+			 * @param variantName the name of the variant, see getVariantName
+			 */
+			bool contains(const std::string &variantName) const;
+
+			/**
+			 * @brief get the count of variants in the archive
+			 * @return size_t 
+			 */
+			size_t size() const noexcept {return header ? header->entryCount : 0;}
+
+		private:
+			MappedFile file;
+			const Header *header = nullptr;
+			const Slot *slots = nullptr;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,95 @@
+#pragma once
+
+#include "engine/LogicalDevice.hpp"
+#include "engine/ShaderReflection.hpp"
+#include "engine/MappedFile.hpp"
+#include "engine/ShaderArchive.hpp"
+
+// libs
+#include <vulkan/vulkan.h>
+
+// std
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <mutex>
+
+namespace vk_engine{
+	class ShaderModuleCache{
+		public:
+			ShaderModuleCache(LogicalDevice &device);
+			~ShaderModuleCache();
+
+			// avoid copy
+			ShaderModuleCache(const ShaderModuleCache &) = delete;
+			ShaderModuleCache &operator=(const ShaderModuleCache &) = delete;
+
+			/**
+			 * @brief get the shader module of the given SPIR-V file, the file is loaded and reflected on the first call
+			 * @param filepath the path to the SPIR-V file
+			 * @return VkShaderModule
+			 */
+			VkShaderModule getModule(const std::string &filepath);
+
+			/**
+			 * @brief get the reflection of the given SPIR-V file, the file is loaded and reflected on the first call
+			 * @param filepath the path to the SPIR-V file
+			 * @return const ShaderReflection&
+			 */
+			const ShaderReflection &getReflection(const std::string &filepath);
+
+			/**
+			 * @brief load the shaders from the given archive, the paths are then variant names (see ShaderArchive::getVariantName).
+			 * the shaders missing from the archive are loaded from the files
+			 * 
+			 * @param archive the shader archive, must outlive the cache
+			 */
+			void setArchive(ShaderArchive &archive) noexcept {this->archive = &archive;}
+
+			/**
+			 * @brief destroy all the cached shader modules, the pipelines created from them stay valid
+			 */
+			void clear();
+
+			/**
+			 * @brief map a SPIR-V file in memory, the code can be given to vkCreateShaderModule without copy.
+			 * the size and the magic number of the file are validated
+			 * 
+			 * @param filepath the path to the file
+			 * @return MappedFile the SPIR-V words, use as<uint32_t>()
+			 */
+			static MappedFile mapFile(const std::string &filepath);
+
+			/**
+			 * @brief check that the given data is SPIR-V code, throw if not
+			 * 
+			 * @param code the code
+			 * @param size the size in bytes
+			 * @param name the name of the code in the error messages
+			 */
+			static void validate(const void *code, size_t size, const std::string &name);
+
+			/**
+			 * @brief create a shader module from SPIR-V code
+			 *
+			 * @param device the logical device
+			 * @param code the SPIR-V words
+			 * @param wordCount the count of words
+			 * @return VkShaderModule
+			 */
+			static VkShaderModule createShaderModule(LogicalDevice &device, const uint32_t *code, size_t wordCount);
+
+		private:
+			struct Entry{
+				VkShaderModule module = VK_NULL_HANDLE;
+				ShaderReflection reflection;
+			};
+
+			Entry &get(const std::string &filepath);
+
+			LogicalDevice &device;
+			ShaderArchive *archive = nullptr;
+			std::unordered_map<std::string, Entry> entries;
+			std::mutex mutex;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,77 @@
+#pragma once
+
+// libs
+#include <vulkan/vulkan.h>
+
+// std
+#include <vector>
+#include <array>
+#include <cstdint>
+#include <cstddef>
+
+namespace vk_engine{
+	class ShaderReflection{
+		public:
+			static constexpr uint32_t SPIRV_MAGIC = 0x07230203;
+			static constexpr uint32_t NO_SPEC_ID = ~0U;
+
+			struct Binding{
+				uint32_t set = 0;
+				uint32_t binding = 0;
+				VkDescriptorType type = VK_DESCRIPTOR_TYPE_MAX_ENUM;
+
+				// 0 for a runtime array (unbounded)
+				uint32_t count = 1;
+				VkShaderStageFlags stages = 0;
+			};
+
+			struct LocalSize{
+				std::array<uint32_t, 3> size = {1, 1, 1};
+
+				// the specialization constant id overriding each dimension, NO_SPEC_ID if none
+				std::array<uint32_t, 3> specIds = {NO_SPEC_ID, NO_SPEC_ID, NO_SPEC_ID};
+			};
+
+			ShaderReflection() = default;
+
+			/**
+			 * @brief reflect the given SPIR-V code
+			 *
+			 * @param code the SPIR-V words
+			 * @param wordCount the count of 32 bits words
+			 */
+			ShaderReflection(const uint32_t *code, size_t wordCount);
+
+			/**
+			 * @brief get the stage of the entry point
+			 * @return VkShaderStageFlagBits
+			 */
+			VkShaderStageFlagBits getStage() const noexcept {return stage;}
+
+			/**
+			 * @brief get the descriptor bindings used by the shader, sorted by set and binding
+			 * @return const std::vector<Binding>&
+			 */
+			const std::vector<Binding> &getBindings() const noexcept {return bindings;}
+
+			/**
+			 * @brief get the push constant range used by the shader, the size is 0 if the shader does not use push constants
+			 * @return VkPushConstantRange
+			 */
+			VkPushConstantRange getPushConstantRange() const noexcept {return pushConstantRange;}
+
+			/**
+			 * @brief get the workgroup size of a compute shader
+			 * @return const LocalSize&
+			 */
+			const LocalSize &getLocalSize() const noexcept {return localSize;}
+
+		private:
+			void reflect(const uint32_t *code, size_t wordCount);
+
+			VkShaderStageFlagBits stage = VK_SHADER_STAGE_ALL;
+			std::vector<Binding> bindings;
+			VkPushConstantRange pushConstantRange{};
+			LocalSize localSize;
+	};
+}
\ No newline at end of file
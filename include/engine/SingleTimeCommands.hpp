@@ -2,6 +2,7 @@
 
 #include "engine/CommandPool.hpp"
 #include "engine/LogicalDevice.hpp"
+#include "engine/Synchronization2.hpp"
 
 // libs
 #include <vulkan/vulkan.h>
@@ -65,9 +66,10 @@ namespace vk_engine{
 	 * @param commandPool a reference to a commandPool
 	 * @param device a reference to a LogicalDevice
 	 * @param image the image to convert
-	 * @param format the format of the image
+	 * @param format the format of the image, gives the aspects of the barrier
 	 * @param oldLayout the old layout of the image
 	 * @param newLayout the new layout of the image
+	 * @param synchronization2 record the barrier with vkCmdPipelineBarrier2KHR if supported, nullptr to use vkCmdPipelineBarrier
 	 */
-	void transitionImageLayout(CommandPool &commandPool, LogicalDevice &device, VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout);
+	void transitionImageLayout(CommandPool &commandPool, LogicalDevice &device, VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout, const Synchronization2 *synchronization2 = nullptr);
 }
\ No newline at end of file
@@ -0,0 +1,98 @@
+#pragma once
+
+// libs
+#include <vulkan/vulkan.h>
+
+// std
+#include <map>
+#include <vector>
+#include <type_traits>
+#include <cstring>
+
+namespace vk_engine{
+	class SpecializationConstants{
+		public:
+			SpecializationConstants() = default;
+			~SpecializationConstants() = default;
+
+			/**
+			 * @brief set the value of a specialization constant, bool values are converted to VkBool32
+			 *
+			 * @param constantID the constant_id of the constant in the shader
+			 * @param value the value of the constant (bool, int32_t, uint32_t, float, double, ...)
+			 */
+			template<typename T> void set(uint32_t constantID, const T &value){
+				static_assert(std::is_arithmetic<T>::value, "a specialization constant must be a scalar");
+
+				if constexpr (std::is_same<T, bool>::value){
+					VkBool32 boolean = value ? VK_TRUE : VK_FALSE;
+					setRaw(constantID, &boolean, sizeof(VkBool32));
+				} else {
+					setRaw(constantID, &value, sizeof(T));
+				}
+			}
+
+			/**
+			 * @brief set the raw bytes of a specialization constant
+			 *
+			 * @param constantID the constant_id of the constant in the shader
+			 * @param data the bytes of the value
+			 * @param size the count of bytes
+			 */
+			void setRaw(uint32_t constantID, const void *data, size_t size);
+
+			/**
+			 * @brief get the value of a specialization constant
+			 *
+			 * @param constantID the constant_id of the constant in the shader
+			 * @param value the output value, unchanged if the constant is not set or if the size does not match
+			 * @return true if the constant is set, false if not
+			 */
+			template<typename T> bool get(uint32_t constantID, T &value) const{
+				static_assert(std::is_arithmetic<T>::value, "a specialization constant must be a scalar");
+
+				auto it = constants.find(constantID);
+				if (it == constants.end() || it->second.size() != sizeof(T)) return false;
+
+				memcpy(&value, it->second.data(), sizeof(T));
+				return true;
+			}
+
+			/**
+			 * @brief remove the given constant, the shader will use it's default value
+			 * @param constantID the constant_id of the constant in the shader
+			 */
+			void remove(uint32_t constantID);
+
+			/**
+			 * @brief get if no constants are set
+			 */
+			bool empty() const noexcept {return constants.empty();}
+
+			/**
+			 * @brief get the raw values of the constants, sorted by id
+			 * @return const std::map<uint32_t, std::vector<char>>& 
+			 */
+			const std::map<uint32_t, std::vector<char>> &getConstants() const noexcept {return constants;}
+
+			/**
+			 * @brief get the specialization info, valid until the next modification
+			 * @return const VkSpecializationInfo*, nullptr if no constants are set
+			 */
+			const VkSpecializationInfo *getInfo();
+
+			/**
+			 * @brief get the hash of the constants ids and values
+			 * @return uint64_t
+			 */
+			uint64_t hash(uint64_t seed) const noexcept;
+
+		private:
+			// sorted by id, the same constants always produce the same data and hash
+			std::map<uint32_t, std::vector<char>> constants;
+
+			std::vector<VkSpecializationMapEntry> entries;
+			std::vector<char> data;
+			VkSpecializationInfo info{};
+	};
+}
\ No newline at end of file
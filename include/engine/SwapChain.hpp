@@ -1,6 +1,7 @@
 #pragma once
 
 #include "engine/LogicalDevice.hpp"
+#include "engine/Synchronization2.hpp"
 
 // libs
 #include <vulkan/vulkan.h>
@@ -39,6 +40,18 @@ namespace vk_engine{
 			 */
 			void setSurfaceFormat(VkSurfaceFormatKHR format) {wantedSurfaceFormat = format;}
 
+			/**
+			 * @brief create the render pass with the synchronization2 barriers if the device support them, must be called before the build
+			 * @param synchronization2 the built synchronization2 support, must outlive the swap chain
+			 */
+			void setSynchronization2(const Synchronization2 *synchronization2) noexcept {this->synchronization2 = synchronization2;}
+
+			/**
+			 * @brief get the synchronization2 support used by the render pass
+			 * @return const Synchronization2* nullptr if not set
+			 */
+			const Synchronization2 *getSynchronization2() const noexcept {return synchronization2;}
+
 			/**
 			 * @brief build the swapChain
 			 */
@@ -70,6 +83,13 @@ namespace vk_engine{
 			 */
 			VkImageView getImageView(int index) const noexcept {return swapChainImageViews[index];}
 
+			/**
+			 * @brief get the image of the given index
+			 * @param index the index of the image
+			 * @return VkImage 
+			 */
+			VkImage getImage(int index) const noexcept {return swapChainImages[index];}
+
 			/**
 			 * @brief get the count of images
 			 * @return size_t 
@@ -200,6 +220,8 @@ namespace vk_engine{
 			Refresh refreshType = REFRESH_FIFO_MODE;
 			VkSurfaceFormatKHR wantedSurfaceFormat = {VK_FORMAT_B8G8R8A8_SRGB, VK_COLOR_SPACE_SRGB_NONLINEAR_KHR};
 
+			const Synchronization2 *synchronization2 = nullptr;
+
 			int framesInFlight = 2;
 			bool depthBufferEnable = false;
 			bool builded = false;
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "engine/LogicalDevice.hpp"
+
+// libs
+#include <vulkan/vulkan.h>
+
+// std
+#include <vector>
+
+namespace vk_engine{
+	/**
+	 * @brief the VK_KHR_synchronization2 support of a device. The barriers are described with the synchronization2 structures,
+	 * each barrier has its own stages, and all the barriers of a dependency are recorded by a single vkCmdPipelineBarrier2KHR.
+	 * without the extension the dependency is converted and recorded with vkCmdPipelineBarrier
+	 */
+	class Synchronization2{
+		public:
+			Synchronization2(LogicalDevice &device);
+
+			// avoid copy
+			Synchronization2(const Synchronization2 &) = delete;
+			Synchronization2 &operator=(const Synchronization2 &) = delete;
+
+			/**
+			 * @brief require the extension and the feature if the physical device support them, with VK_KHR_create_renderpass2 for the subpass dependencies.
+			 * must be called before the build of the logical device
+			 */
+			void require();
+
+			/**
+			 * @brief load the commands of the enabled extensions, must be called after the build of the logical device
+			 */
+			void build();
+
+			/**
+			 * @brief get if the barriers are recorded with vkCmdPipelineBarrier2KHR
+			 */
+			bool isSupported() const noexcept {return supported;}
+
+			/**
+			 * @brief record the barriers of the dependency
+			 * @param commandBuffer the command buffer
+			 * @param dependency the barriers
+			 */
+			void pipelineBarrier(VkCommandBuffer commandBuffer, const VkDependencyInfoKHR &dependency) const;
+
+			/**
+			 * @brief record the given barriers in a single dependency
+			 *
+			 * @param commandBuffer the command buffer
+			 * @param imageBarriers the image barriers
+			 * @param bufferBarriers the buffer barriers
+			 */
+			void pipelineBarrier(VkCommandBuffer commandBuffer, const std::vector<VkImageMemoryBarrier2KHR> &imageBarriers, const std::vector<VkBufferMemoryBarrier2KHR> &bufferBarriers = {}) const;
+
+			/**
+			 * @brief create a render pass with vkCreateRenderPass2KHR, the memory barrier of a dependency replaces its stages and accesses.
+			 * without the extensions the render pass is created with vkCreateRenderPass and the masks of the dependencies
+			 *
+			 * @param createInfo the render pass
+			 * @param dependencyBarriers the barriers of the dependencies, in the order of createInfo.pDependencies, empty to keep the masks of the dependencies
+			 * @param renderPass the created render pass
+			 * @return VkResult
+			 */
+			VkResult createRenderPass(const VkRenderPassCreateInfo &createInfo, const std::vector<VkMemoryBarrier2KHR> &dependencyBarriers, VkRenderPass *renderPass) const;
+
+			/**
+			 * @brief record the dependency with vkCmdPipelineBarrier, the stages and accesses of all the barriers are merged
+			 * @param commandBuffer the command buffer
+			 * @param dependency the barriers
+			 */
+			static void legacyPipelineBarrier(VkCommandBuffer commandBuffer, const VkDependencyInfoKHR &dependency);
+
+			/**
+			 * @brief get the VkPipelineStageFlags covering the given synchronization2 stages
+			 *
+			 * @param stages the stages
+			 * @param src true for a source scope, false for a destination scope
+			 * @return VkPipelineStageFlags
+			 */
+			static VkPipelineStageFlags toLegacyStages(VkPipelineStageFlags2KHR stages, bool src) noexcept;
+
+			/**
+			 * @brief get the VkAccessFlags covering the given synchronization2 accesses
+			 * @param access the accesses
+			 * @return VkAccessFlags
+			 */
+			static VkAccessFlags toLegacyAccess(VkAccessFlags2KHR access) noexcept;
+
+		private:
+			LogicalDevice &device;
+
+			bool supported = false;
+			bool renderPass2 = false;
+
+			PFN_vkCmdPipelineBarrier2KHR cmdPipelineBarrier2 = nullptr;
+			PFN_vkCreateRenderPass2KHR createRenderPass2 = nullptr;
+	};
+}
\ No newline at end of file
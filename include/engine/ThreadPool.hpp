@@ -0,0 +1,128 @@
+#pragma once
+
+// std
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <atomic>
+#include <algorithm>
+#include <exception>
+
+namespace vk_engine{
+	/**
+	 * @brief a fixed count of worker threads executing the submited tasks in submission order
+	 */
+	class ThreadPool{
+		public:
+			static constexpr uint32_t NO_WORKER = ~0U;
+
+			/**
+			 * @brief create the pool and start the threads
+			 * @param threadCount the count of worker threads, 0 to use the count of hardware threads
+			 */
+			ThreadPool(uint32_t threadCount = 0);
+			~ThreadPool();
+
+			// avoid copy
+			ThreadPool(const ThreadPool &) = delete;
+			ThreadPool &operator=(const ThreadPool &) = delete;
+
+			/**
+			 * @brief execute the given task on a worker thread
+			 * @param task a callable without arguments
+			 * @return std::future of the result of the task, rethrow the exceptions of the task on get()
+			 */
+			template<typename F> auto submit(F &&task) -> std::future<decltype(task())>{
+				using R = decltype(task());
+
+				// std::function require a copyable callable
+				auto packaged = std::make_shared<std::packaged_task<R()>>(std::forward<F>(task));
+				std::future<R> future = packaged->get_future();
+
+				push([packaged](){(*packaged)();});
+				return future;
+			}
+
+			/**
+			 * @brief call task(i) for i in [0, count[, the indices are taken in order by the workers and the calling thread until none
+			 * is left. Return once all the calls are done, the caller must not be a worker of the pool
+			 *
+			 * @param threadPool the pool, nullptr to make all the calls on the calling thread
+			 * @param count the count of calls
+			 * @param task a callable taking the index, called concurrently
+			 */
+			template<typename F> static void parallelFor(ThreadPool *threadPool, uint32_t count, const F &task){
+				if (count <= 1 || threadPool == nullptr){
+					for (uint32_t i=0; i<count; i++)
+						task(i);
+					return;
+				}
+
+				std::atomic<uint32_t> next{0};
+				auto work = [&](){
+					for (uint32_t i = next.fetch_add(1, std::memory_order_relaxed); i < count; i = next.fetch_add(1, std::memory_order_relaxed))
+						task(i);
+				};
+
+				const uint32_t taskCount = std::min(threadPool->getThreadCount(), count - 1);
+				std::vector<std::future<void>> tasks;
+				tasks.reserve(taskCount);
+
+				for (uint32_t i=0; i<taskCount; i++)
+					tasks.push_back(threadPool->submit([&work](){work();}));
+
+				// the tasks reference the locals of the caller, all of them are waited before an exception leaves
+				std::exception_ptr exception;
+				try {
+					work();
+				} catch (...){
+					next = count;
+					exception = std::current_exception();
+				}
+
+				for (auto &task : tasks){
+					try {
+						task.get();
+					} catch (...){
+						if (!exception) exception = std::current_exception();
+					}
+				}
+
+				if (exception) std::rethrow_exception(exception);
+			}
+
+			/**
+			 * @brief wait until all the submited tasks are executed
+			 */
+			void wait();
+
+			/**
+			 * @brief get the count of worker threads
+			 * @return uint32_t 
+			 */
+			uint32_t getThreadCount() const noexcept {return static_cast<uint32_t>(threads.size());}
+
+			/**
+			 * @brief get the index of the worker thread calling the function, used to give each worker its own resources
+			 * @return uint32_t in [0, getThreadCount()[, NO_WORKER if not called from a worker thread
+			 */
+			static uint32_t getWorkerIndex() noexcept;
+
+		private:
+			void push(std::function<void()> task);
+			void work(uint32_t index);
+
+			std::vector<std::thread> threads;
+			std::deque<std::function<void()>> tasks;
+			std::mutex mutex;
+			std::condition_variable taskCondition;
+			std::condition_variable idleCondition;
+			uint32_t activeTasks = 0;
+			bool stop = false;
+	};
+}
\ No newline at end of file
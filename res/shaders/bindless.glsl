@@ -0,0 +1,11 @@
+// the bindless table of vk_engine::BindlessTable, define BINDLESS_SET before the include to change the set
+#extension GL_EXT_nonuniform_qualifier : require
+
+#ifndef BINDLESS_SET
+#define BINDLESS_SET 0
+#endif
+
+layout(set = BINDLESS_SET, binding = 0) uniform sampler2D bindlessTextures[];
+
+// the index may vary between the invocations of a draw
+#define bindlessTexture(index) bindlessTextures[nonuniformEXT(index)]
\ No newline at end of file
@@ -0,0 +1,16 @@
+// the instance transforms of vk_engine::RenderQueue and the object transforms of vk_engine::IndirectScene, define INSTANCE_SET and INSTANCE_BINDING before the include to change the binding
+
+#ifndef INSTANCE_SET
+#define INSTANCE_SET 1
+#endif
+
+#ifndef INSTANCE_BINDING
+#define INSTANCE_BINDING 0
+#endif
+
+layout(std430, set = INSTANCE_SET, binding = INSTANCE_BINDING) readonly buffer InstanceBuffer{
+	mat4 instanceTransforms[];
+};
+
+// gl_InstanceIndex starts at the first instance of the draw, the offset of its run in the buffer
+#define instanceTransform instanceTransforms[gl_InstanceIndex]
\ No newline at end of file
@@ -0,0 +1,152 @@
+#include "engine/BindlessTable.hpp"
+
+// std
+#include <stdexcept>
+#include <cassert>
+#include <algorithm>
+
+namespace vk_engine{
+	BindlessTable::BindlessTable(LogicalDevice &device) : device{device}{}
+
+	BindlessTable::~BindlessTable(){
+		vkDestroyDescriptorPool(device, pool, nullptr);
+		vkDestroyDescriptorSetLayout(device, layout, nullptr);
+	}
+
+	void BindlessTable::require(){
+		PhysicalDevice &physicalDevice = device.getPhysicalDevice();
+		auto features = physicalDevice.getFeatures<VkPhysicalDeviceDescriptorIndexingFeatures>(VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES);
+
+		if (!features.runtimeDescriptorArray || !features.descriptorBindingPartiallyBound || !features.descriptorBindingSampledImageUpdateAfterBind ||
+			!features.descriptorBindingUpdateUnusedWhilePending || !features.shaderSampledImageArrayNonUniformIndexing) return;
+		
+		// core in vulkan 1.2, the extension is only needed by the older devices
+		device.requireOptionalExtension(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME);
+
+		auto &enabled = device.requireFeatures<VkPhysicalDeviceDescriptorIndexingFeatures>(VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES);
+		enabled.runtimeDescriptorArray = VK_TRUE;
+		enabled.descriptorBindingPartiallyBound = VK_TRUE;
+		enabled.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+		enabled.descriptorBindingUpdateUnusedWhilePending = VK_TRUE;
+		enabled.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
+	}
+
+	void BindlessTable::build(){
+		auto features = device.getEnabledFeatures<VkPhysicalDeviceDescriptorIndexingFeatures>(VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES);
+		supported = features && features->descriptorBindingSampledImageUpdateAfterBind && features->descriptorBindingPartiallyBound;
+
+		// the features are not enabled, the images keep using regular descriptor sets
+		if (!supported) return;
+
+		// a combined image sampler counts as a sampled image and as a sampler
+		auto properties = device.getPhysicalDevice().getProperties<VkPhysicalDeviceDescriptorIndexingProperties>(VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES);
+		capacity = std::min({
+			capacity,
+			properties.maxDescriptorSetUpdateAfterBindSampledImages,
+			properties.maxDescriptorSetUpdateAfterBindSamplers,
+			properties.maxPerStageDescriptorUpdateAfterBindSampledImages,
+			properties.maxPerStageDescriptorUpdateAfterBindSamplers
+		});
+
+		VkDescriptorSetLayoutBinding binding{};
+		binding.binding = 0;
+		binding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+		binding.descriptorCount = capacity;
+		binding.stageFlags = VK_SHADER_STAGE_ALL;
+
+		VkDescriptorBindingFlags bindingFlags = VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT | VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT;
+
+		VkDescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsInfo{};
+		bindingFlagsInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+		bindingFlagsInfo.bindingCount = 1;
+		bindingFlagsInfo.pBindingFlags = &bindingFlags;
+
+		VkDescriptorSetLayoutCreateInfo layoutInfo{};
+		layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+		layoutInfo.pNext = &bindingFlagsInfo;
+		layoutInfo.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT;
+		layoutInfo.bindingCount = 1;
+		layoutInfo.pBindings = &binding;
+
+		if (vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &layout) != VK_SUCCESS)
+			throw std::runtime_error("failed to create bindless descriptor set layout");
+
+		VkDescriptorPoolSize poolSize{VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, capacity};
+
+		VkDescriptorPoolCreateInfo poolInfo{};
+		poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+		poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
+		poolInfo.maxSets = 1;
+		poolInfo.poolSizeCount = 1;
+		poolInfo.pPoolSizes = &poolSize;
+
+		if (vkCreateDescriptorPool(device, &poolInfo, nullptr, &pool) != VK_SUCCESS)
+			throw std::runtime_error("failed to create bindless descriptor pool");
+
+		VkDescriptorSetAllocateInfo allocInfo{};
+		allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+		allocInfo.descriptorPool = pool;
+		allocInfo.descriptorSetCount = 1;
+		allocInfo.pSetLayouts = &layout;
+
+		if (vkAllocateDescriptorSets(device, &allocInfo, &set) != VK_SUCCESS)
+			throw std::runtime_error("failed to allocate bindless descriptor set");
+	}
+
+	uint32_t BindlessTable::add(const VkDescriptorImageInfo &info){
+		assert(set != VK_NULL_HANDLE && "cannot add an image to a bindless table before the build or if not supported");
+
+		uint32_t index;
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+
+			// the removed indices are sorted by frame, only the oldest one can be finished
+			if (!removedIndices.empty() && removedIndices.front().frame + framesInFlight <= frame){
+				index = removedIndices.front().index;
+				removedIndices.pop_front();
+			} else if (nextIndex < capacity){
+				index = nextIndex++;
+			} else {
+				throw std::runtime_error("the bindless table is full");
+			}
+		}
+
+		update(index, info);
+		return index;
+	}
+
+	void BindlessTable::update(uint32_t index, const VkDescriptorImageInfo &info){
+		assert(index < capacity && "invalid bindless index");
+
+		VkWriteDescriptorSet write{};
+		write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		write.dstSet = set;
+		write.dstBinding = 0;
+		write.dstArrayElement = index;
+		write.descriptorCount = 1;
+		write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+		write.pImageInfo = &info;
+
+		// the updates of a set must be externally synchronized
+		std::lock_guard<std::mutex> lock(mutex);
+		vkUpdateDescriptorSets(device, 1, &write, 0, nullptr);
+	}
+
+	void BindlessTable::remove(uint32_t index){
+		assert(index < capacity && "invalid bindless index");
+
+		// the descriptor is partially bound, it is left as is until reused
+		std::lock_guard<std::mutex> lock(mutex);
+		removedIndices.push_back({index, frame});
+	}
+
+	void BindlessTable::beginFrame(){
+		std::lock_guard<std::mutex> lock(mutex);
+		frame++;
+	}
+
+	void BindlessTable::bind(VkCommandBuffer commandBuffer, VkPipelineLayout layout, uint32_t set, VkPipelineBindPoint bindPoint) const noexcept{
+		assert(this->set != VK_NULL_HANDLE && "cannot bind a bindless table before the build or if not supported");
+		vkCmdBindDescriptorSets(commandBuffer, bindPoint, layout, set, 1, &this->set, 0, nullptr);
+	}
+}
\ No newline at end of file
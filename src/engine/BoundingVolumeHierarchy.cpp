@@ -0,0 +1,606 @@
+#include "engine/BoundingVolumeHierarchy.hpp"
+
+// libs
+#include <glm/common.hpp>
+
+// std
+#include <algorithm>
+#include <utility>
+
+namespace vk_engine{
+	namespace{
+		struct Bounds{
+			glm::vec3 min = glm::vec3(FLT_MAX);
+			glm::vec3 max = glm::vec3(-FLT_MAX);
+
+			void grow(const glm::vec3 &point) noexcept{
+				min = glm::min(min, point);
+				max = glm::max(max, point);
+			}
+
+			void grow(const glm::vec3 &otherMin, const glm::vec3 &otherMax) noexcept{
+				min = glm::min(min, otherMin);
+				max = glm::max(max, otherMax);
+			}
+
+			float area() const noexcept{
+				glm::vec3 size = max - min;
+				return 2.f * (size.x * size.y + size.y * size.z + size.z * size.x);
+			}
+		};
+
+		// only the used bins are reset, the nodes of the subtrees are small and many
+		struct Bins{
+			glm::vec3 mins[3][BoundingVolumeHierarchy::MAX_BINS];
+			glm::vec3 maxs[3][BoundingVolumeHierarchy::MAX_BINS];
+			uint32_t counts[3][BoundingVolumeHierarchy::MAX_BINS];
+
+			explicit Bins(uint32_t binCount) noexcept{
+				for (int axis=0; axis<3; axis++){
+					for (uint32_t bin=0; bin<binCount; bin++){
+						mins[axis][bin] = glm::vec3(FLT_MAX);
+						maxs[axis][bin] = glm::vec3(-FLT_MAX);
+						counts[axis][bin] = 0;
+					}
+				}
+			}
+
+			void grow(int axis, uint32_t bin, const glm::vec3 &min, const glm::vec3 &max, uint32_t count) noexcept{
+				mins[axis][bin] = glm::min(mins[axis][bin], min);
+				maxs[axis][bin] = glm::max(maxs[axis][bin], max);
+				counts[axis][bin] += count;
+			}
+		};
+
+		// the distance to the plane of the corner the farthest along its normal, the box is outside if it is negative
+		float farthestDistance(const glm::vec4 &plane, const glm::vec3 &min, const glm::vec3 &max) noexcept{
+			float x = plane.x >= 0.f ? max.x : min.x;
+			float y = plane.y >= 0.f ? max.y : min.y;
+			float z = plane.z >= 0.f ? max.z : min.z;
+			return plane.x * x + plane.y * y + plane.z * z + plane.w;
+		}
+
+		// the distance to the plane of the corner the farthest against its normal, the box is inside if it is positive
+		float nearestDistance(const glm::vec4 &plane, const glm::vec3 &min, const glm::vec3 &max) noexcept{
+			float x = plane.x >= 0.f ? min.x : max.x;
+			float y = plane.y >= 0.f ? min.y : max.y;
+			float z = plane.z >= 0.f ? min.z : max.z;
+			return plane.x * x + plane.y * y + plane.z * z + plane.w;
+		}
+
+		bool overlaps(const glm::vec3 &minA, const glm::vec3 &maxA, const glm::vec3 &minB, const glm::vec3 &maxB) noexcept{
+			return minA.x <= maxB.x && minB.x <= maxA.x && minA.y <= maxB.y && minB.y <= maxA.y && minA.z <= maxB.z && minB.z <= maxA.z;
+		}
+
+		// the distance along the ray where it enters the box, FLT_MAX if it misses it before maxDistance
+		float intersectRay(const glm::vec3 &min, const glm::vec3 &max, const glm::vec3 &origin, const glm::vec3 &inverseDirection, float maxDistance) noexcept{
+			glm::vec3 toMin = (min - origin) * inverseDirection;
+			glm::vec3 toMax = (max - origin) * inverseDirection;
+
+			glm::vec3 entries = glm::min(toMin, toMax);
+			glm::vec3 exits = glm::max(toMin, toMax);
+
+			float entry = std::max(std::max(entries.x, entries.y), std::max(entries.z, 0.f));
+			float exit = std::min(std::min(exits.x, exits.y), exits.z);
+
+			return entry <= exit && entry < maxDistance ? entry : FLT_MAX;
+		}
+	}
+
+	void BoundingVolumeHierarchy::reserve(uint32_t count){
+		objects.reserve(count);
+		moved.reserve(count);
+	}
+
+	uint32_t BoundingVolumeHierarchy::add(const glm::vec3 &min, const glm::vec3 &max){
+		objects.push_back({min, max});
+		moved.push_back(false);
+		built = false;
+		return static_cast<uint32_t>(objects.size() - 1);
+	}
+
+	void BoundingVolumeHierarchy::set(uint32_t object, const glm::vec3 &min, const glm::vec3 &max){
+		assert(object < objects.size() && "invalid object index");
+		objects[object] = {min, max};
+		if (!built) return;
+
+		sortedBoxes[objectSlots[object]] = {min, max};
+		if (!moved[object]){
+			moved[object] = true;
+			movedObjects.push_back(object);
+		}
+	}
+
+	void BoundingVolumeHierarchy::clear() noexcept{
+		objects.clear();
+		references.clear();
+		sortedObjects.clear();
+		sortedBoxes.clear();
+		objectSlots.clear();
+		objectLeaves.clear();
+		nodes.clear();
+		parents.clear();
+		upperNodes.clear();
+		subtrees.clear();
+		movedObjects.clear();
+		moved.clear();
+		built = false;
+		buildCost = 0.f;
+	}
+
+	void BoundingVolumeHierarchy::build(){
+		const uint32_t count = size();
+
+		nodes.clear();
+		upperNodes.clear();
+		subtrees.clear();
+		movedObjects.clear();
+		moved.assign(count, false);
+		built = true;
+		buildCost = 0.f;
+
+		if (count == 0) return;
+
+		// a binary tree of count leaves at most, with the root and pairs of children
+		nodes.resize(2 * count);
+		parents.resize(2 * count);
+		references.resize(count);
+		sortedObjects.resize(count);
+		sortedBoxes.resize(count);
+		objectSlots.resize(count);
+		objectLeaves.resize(count);
+
+		// the bounds of the root, the bounds of the children are found while splitting their parent
+		const uint32_t chunkCount = (count + CHUNK_SIZE - 1) / CHUNK_SIZE;
+		std::vector<Bounds> chunkBounds(chunkCount);
+		std::vector<Bounds> chunkCentroids(chunkCount);
+
+		ThreadPool::parallelFor(threadPool, chunkCount, [&](uint32_t chunk){
+			const uint32_t end = std::min(count, (chunk + 1) * CHUNK_SIZE);
+			for (uint32_t i=chunk * CHUNK_SIZE; i<end; i++){
+				references[i] = {objects[i], (objects[i].min + objects[i].max) * 0.5f, i};
+				chunkBounds[chunk].grow(objects[i].min, objects[i].max);
+				chunkCentroids[chunk].grow(references[i].centroid);
+			}
+		});
+
+		Bounds bounds;
+		Bounds centroidBounds;
+		for (uint32_t chunk=0; chunk<chunkCount; chunk++){
+			bounds.grow(chunkBounds[chunk].min, chunkBounds[chunk].max);
+			centroidBounds.grow(chunkCentroids[chunk].min, chunkCentroids[chunk].max);
+		}
+
+		nodeCount = 1;
+		parents[0] = NO_NODE;
+
+		// split the upper nodes until their subtrees are small enough to give a few to each worker
+		const uint32_t subtreeSize = threadPool == nullptr ? count : std::max(count / ((threadPool->getThreadCount() + 1) * 4), MIN_SUBTREE_SIZE);
+		std::vector<Range> pending = {{0, 0, count, {bounds.min, bounds.max}, {centroidBounds.min, centroidBounds.max}}};
+		std::vector<Range> subtreeRanges;
+
+		while (!pending.empty()){
+			Range range = pending.back();
+			pending.pop_back();
+
+			if (range.end - range.begin <= subtreeSize){
+				subtreeRanges.push_back(range);
+				continue;
+			}
+
+			upperNodes.push_back(range.node);
+
+			Range left, right;
+			if (split(range, true, left, right)){
+				pending.push_back(right);
+				pending.push_back(left);
+			}
+		}
+
+		// the largest subtrees first, so the workers end together
+		std::sort(subtreeRanges.begin(), subtreeRanges.end(), [](const Range &a, const Range &b){return a.end - a.begin > b.end - b.begin;});
+
+		ThreadPool::parallelFor(threadPool, static_cast<uint32_t>(subtreeRanges.size()), [&](uint32_t i){
+			buildSubtree(subtreeRanges[i]);
+		});
+
+		for (const auto &range : subtreeRanges)
+			subtrees.push_back(range.node);
+
+		ThreadPool::parallelFor(threadPool, chunkCount, [&](uint32_t chunk){
+			const uint32_t end = std::min(count, (chunk + 1) * CHUNK_SIZE);
+			for (uint32_t i=chunk * CHUNK_SIZE; i<end; i++){
+				sortedObjects[i] = references[i].object;
+				sortedBoxes[i] = references[i].box;
+				objectSlots[references[i].object] = i;
+			}
+		});
+
+		nodes.resize(nodeCount);
+		parents.resize(nodeCount);
+		buildCost = getCost();
+	}
+
+	bool BoundingVolumeHierarchy::split(const Range &range, bool parallel, Range &left, Range &right){
+		const uint32_t count = range.end - range.begin;
+		const uint32_t chunkCount = parallel && threadPool != nullptr ? (count + CHUNK_SIZE - 1) / CHUNK_SIZE : 1;
+		const uint32_t chunkSize = (count + chunkCount - 1) / chunkCount;
+		const Bounds bounds{range.bounds.min, range.bounds.max};
+		const Bounds centroidBounds{range.centroidBounds.min, range.centroidBounds.max};
+
+		Node &node = nodes[range.node];
+		node.min = bounds.min;
+		node.max = bounds.max;
+
+		if (count <= leafSize){
+			makeLeaf(range);
+			return false;
+		}
+
+		// the bins of the centroids along each axis, an axis where the centroids are the same is not binned
+		const glm::vec3 extent = centroidBounds.max - centroidBounds.min;
+		glm::vec3 scale;
+		for (int axis=0; axis<3; axis++)
+			scale[axis] = extent[axis] > 0.f ? static_cast<float>(binCount) / extent[axis] : 0.f;
+
+		auto getBin = [&](const Reference &reference, int axis){
+			return std::min(binCount - 1, static_cast<uint32_t>((reference.centroid[axis] - centroidBounds.min[axis]) * scale[axis]));
+		};
+
+		auto binObjects = [&](uint32_t begin, uint32_t end, Bins &bins){
+			for (uint32_t i=begin; i<end; i++){
+				const Reference &reference = references[i];
+
+				for (int axis=0; axis<3; axis++){
+					bins.grow(axis, getBin(reference, axis), reference.box.min, reference.box.max, 1);
+				}
+			}
+		};
+
+		Bins bins(binCount);
+		if (chunkCount == 1){
+			binObjects(range.begin, range.end, bins);
+		} else {
+			std::vector<Bins> chunkBins(chunkCount, Bins(binCount));
+
+			ThreadPool::parallelFor(threadPool, chunkCount, [&](uint32_t chunk){
+				const uint32_t begin = range.begin + chunk * chunkSize;
+				binObjects(begin, std::min(range.end, begin + chunkSize), chunkBins[chunk]);
+			});
+
+			for (const auto &chunk : chunkBins){
+				for (int axis=0; axis<3; axis++){
+					for (uint32_t bin=0; bin<binCount; bin++){
+						bins.grow(axis, bin, chunk.mins[axis][bin], chunk.maxs[axis][bin], chunk.counts[axis][bin]);
+					}
+				}
+			}
+		}
+
+		// the cost of a split after each bin, the area of each side times its count of objects
+		int bestAxis = -1;
+		uint32_t bestBin = 0;
+		float bestCost = FLT_MAX;
+
+		for (int axis=0; axis<3; axis++){
+			if (scale[axis] == 0.f) continue;
+
+			float leftCosts[MAX_BINS];
+			Bounds leftBounds;
+			uint32_t leftCount = 0;
+
+			for (uint32_t bin=0; bin+1<binCount; bin++){
+				leftBounds.grow(bins.mins[axis][bin], bins.maxs[axis][bin]);
+				leftCount += bins.counts[axis][bin];
+				leftCosts[bin] = leftCount == 0 ? FLT_MAX : leftBounds.area() * static_cast<float>(leftCount);
+			}
+
+			Bounds rightBounds;
+			uint32_t rightCount = 0;
+
+			for (uint32_t bin=binCount-1; bin>0; bin--){
+				rightBounds.grow(bins.mins[axis][bin], bins.maxs[axis][bin]);
+				rightCount += bins.counts[axis][bin];
+				if (rightCount == 0 || leftCosts[bin - 1] == FLT_MAX) continue;
+
+				const float cost = leftCosts[bin - 1] + rightBounds.area() * static_cast<float>(rightCount);
+				if (cost < bestCost){
+					bestCost = cost;
+					bestAxis = axis;
+					bestBin = bin - 1;
+				}
+			}
+		}
+
+		// the bounds of the children are grown while the references are partitioned
+		Bounds leftBounds, leftCentroids, rightBounds, rightCentroids;
+		auto growLeft = [&](const Reference &reference){
+			leftBounds.grow(reference.box.min, reference.box.max);
+			leftCentroids.grow(reference.centroid);
+		};
+		auto growRight = [&](const Reference &reference){
+			rightBounds.grow(reference.box.min, reference.box.max);
+			rightCentroids.grow(reference.centroid);
+		};
+
+		uint32_t middle;
+		if (bestAxis < 0){
+			// the centroids are all the same, halve the objects
+			middle = range.begin + count / 2;
+
+			for (uint32_t i=range.begin; i<middle; i++)
+				growLeft(references[i]);
+			for (uint32_t i=middle; i<range.end; i++)
+				growRight(references[i]);
+
+		} else {
+			// a leaf costs its count of objects, a node the traversal and the objects of its children weighted by their areas.
+			// the split is skipped when a leaf is cheaper and small enough
+			const float area = bounds.area();
+			const float splitCost = area > 0.f ? 1.f + bestCost / area : FLT_MAX;
+
+			if (splitCost >= static_cast<float>(count) && count <= leafSize * 4){
+				makeLeaf(range);
+				return false;
+			}
+
+			auto isLeft = [&](const Reference &reference){return getBin(reference, bestAxis) <= bestBin;};
+			uint32_t begin = range.begin;
+			uint32_t end = range.end;
+
+			while (true){
+				for (; begin < end && isLeft(references[begin]); begin++)
+					growLeft(references[begin]);
+				for (; begin < end && !isLeft(references[end - 1]); end--)
+					growRight(references[end - 1]);
+
+				if (begin == end) break;
+
+				std::swap(references[begin], references[end - 1]);
+				growLeft(references[begin++]);
+				growRight(references[--end]);
+			}
+
+			middle = begin;
+		}
+
+		const uint32_t child = nodeCount.fetch_add(2, std::memory_order_relaxed);
+		node.first = child;
+		node.count = 0;
+		parents[child] = range.node;
+		parents[child + 1] = range.node;
+
+		left = {child, range.begin, middle, {leftBounds.min, leftBounds.max}, {leftCentroids.min, leftCentroids.max}};
+		right = {child + 1, middle, range.end, {rightBounds.min, rightBounds.max}, {rightCentroids.min, rightCentroids.max}};
+		return true;
+	}
+
+	void BoundingVolumeHierarchy::buildSubtree(const Range &range){
+		Range left, right;
+		if (split(range, false, left, right)){
+			buildSubtree(left);
+			buildSubtree(right);
+		}
+	}
+
+	void BoundingVolumeHierarchy::makeLeaf(const Range &range) noexcept{
+		Node &node = nodes[range.node];
+		node.first = range.begin;
+		node.count = range.end - range.begin;
+
+		for (uint32_t i=range.begin; i<range.end; i++)
+			objectLeaves[references[i].object] = range.node;
+	}
+
+	void BoundingVolumeHierarchy::refit(){
+		if (!built || movedObjects.empty()) return;
+
+		if (isRefitPartial()){
+			for (uint32_t object : movedObjects)
+				refitBranch(object);
+
+		} else {
+			ThreadPool::parallelFor(threadPool, static_cast<uint32_t>(subtrees.size()), [&](uint32_t i){
+				refitSubtree(subtrees[i]);
+			});
+
+			// the children are split after their parents
+			for (auto node = upperNodes.rbegin(); node != upperNodes.rend(); node++)
+				refitNode(*node);
+		}
+
+		for (uint32_t object : movedObjects)
+			moved[object] = false;
+
+		movedObjects.clear();
+	}
+
+	void BoundingVolumeHierarchy::update(){
+		if (!built){
+			build();
+			return;
+		}
+
+		if (movedObjects.empty()) return;
+
+		// the cost is only measured after the full refits, the partial ones barely change it
+		const bool partial = isRefitPartial();
+		refit();
+
+		if (!partial && getCost() > buildCost * rebuildRatio)
+			build();
+	}
+
+	void BoundingVolumeHierarchy::refitNode(uint32_t node) noexcept{
+		Node &refitted = nodes[node];
+		Bounds bounds;
+
+		if (refitted.count > 0){
+			for (uint32_t i=refitted.first; i<refitted.first + refitted.count; i++){
+				const Box &box = sortedBoxes[i];
+				bounds.grow(box.min, box.max);
+			}
+		} else {
+			bounds.grow(nodes[refitted.first].min, nodes[refitted.first].max);
+			bounds.grow(nodes[refitted.first + 1].min, nodes[refitted.first + 1].max);
+		}
+
+		refitted.min = bounds.min;
+		refitted.max = bounds.max;
+	}
+
+	void BoundingVolumeHierarchy::refitSubtree(uint32_t node) noexcept{
+		if (nodes[node].count == 0){
+			refitSubtree(nodes[node].first);
+			refitSubtree(nodes[node].first + 1);
+		}
+
+		refitNode(node);
+	}
+
+	void BoundingVolumeHierarchy::refitBranch(uint32_t object) noexcept{
+		// the ancestors are already fitted once a node keeps its box
+		for (uint32_t node = objectLeaves[object]; node != NO_NODE; node = parents[node]){
+			const glm::vec3 min = nodes[node].min;
+			const glm::vec3 max = nodes[node].max;
+
+			refitNode(node);
+			if (nodes[node].min == min && nodes[node].max == max) break;
+		}
+	}
+
+	float BoundingVolumeHierarchy::getCost() const noexcept{
+		if (nodes.empty()) return 0.f;
+
+		const float rootArea = Bounds{nodes[0].min, nodes[0].max}.area();
+		if (rootArea <= 0.f) return static_cast<float>(nodes[0].count);
+
+		float cost = 0.f;
+		for (const auto &node : nodes){
+			const float area = Bounds{node.min, node.max}.area();
+			cost += area * static_cast<float>(node.count > 0 ? node.count : 1);
+		}
+
+		return cost / rootArea;
+	}
+
+	void BoundingVolumeHierarchy::cull(const Frustum &frustum, std::vector<uint32_t> &found) const{
+		found.clear();
+		if (nodes.empty()) return;
+
+		// the planes the node still crosses, the children of a node inside a plane are not tested against it
+		struct Entry{
+			uint32_t node;
+			uint32_t planes;
+		};
+
+		std::vector<Entry> stack = {{0, 0x3F}};
+
+		while (!stack.empty()){
+			const Entry entry = stack.back();
+			stack.pop_back();
+
+			const Node &node = nodes[entry.node];
+			uint32_t planes = entry.planes;
+			bool outside = false;
+
+			for (uint32_t i=0; i<6 && !outside; i++){
+				if ((planes & (1U << i)) == 0) continue;
+
+				outside = farthestDistance(frustum.planes[i], node.min, node.max) < 0.f;
+				if (nearestDistance(frustum.planes[i], node.min, node.max) >= 0.f) planes &= ~(1U << i);
+			}
+
+			if (outside) continue;
+
+			if (node.count == 0){
+				stack.push_back({node.first + 1, planes});
+				stack.push_back({node.first, planes});
+				continue;
+			}
+
+			for (uint32_t i=node.first; i<node.first + node.count; i++){
+				const Box &box = sortedBoxes[i];
+				bool visible = true;
+
+				for (uint32_t p=0; p<6 && visible; p++)
+					if (planes & (1U << p)) visible = farthestDistance(frustum.planes[p], box.min, box.max) >= 0.f;
+
+				if (visible) found.push_back(sortedObjects[i]);
+			}
+		}
+	}
+
+	void BoundingVolumeHierarchy::overlap(const glm::vec3 &min, const glm::vec3 &max, std::vector<uint32_t> &found) const{
+		found.clear();
+		if (nodes.empty()) return;
+
+		std::vector<uint32_t> stack = {0};
+
+		while (!stack.empty()){
+			const Node &node = nodes[stack.back()];
+			stack.pop_back();
+
+			if (!overlaps(node.min, node.max, min, max)) continue;
+
+			if (node.count == 0){
+				stack.push_back(node.first + 1);
+				stack.push_back(node.first);
+				continue;
+			}
+
+			for (uint32_t i=node.first; i<node.first + node.count; i++){
+				if (overlaps(sortedBoxes[i].min, sortedBoxes[i].max, min, max)) found.push_back(sortedObjects[i]);
+			}
+		}
+	}
+
+	BoundingVolumeHierarchy::Hit BoundingVolumeHierarchy::raycast(const glm::vec3 &origin, const glm::vec3 &direction, float maxDistance) const{
+		Hit hit;
+		hit.distance = maxDistance;
+		if (nodes.empty()) return Hit{};
+
+		// a zero component gives a finite inverse, an origin on a slab plane gives a distance of 0 instead of the NaN of 0 * inf
+		const glm::vec3 inverseDirection = glm::clamp(1.f / direction, glm::vec3(-FLT_MAX), glm::vec3(FLT_MAX));
+
+		// the nodes with the distance where the ray enters them, the nearest child is visited first
+		std::vector<std::pair<uint32_t, float>> stack;
+		float rootDistance = intersectRay(nodes[0].min, nodes[0].max, origin, inverseDirection, hit.distance);
+		if (rootDistance != FLT_MAX) stack.push_back({0, rootDistance});
+
+		while (!stack.empty()){
+			const auto entry = stack.back();
+			stack.pop_back();
+
+			if (entry.second >= hit.distance) continue;
+			const Node &node = nodes[entry.first];
+
+			if (node.count > 0){
+				for (uint32_t i=node.first; i<node.first + node.count; i++){
+					const float distance = intersectRay(sortedBoxes[i].min, sortedBoxes[i].max, origin, inverseDirection, hit.distance);
+
+					if (distance < hit.distance){
+						hit.object = sortedObjects[i];
+						hit.distance = distance;
+					}
+				}
+				continue;
+			}
+
+			uint32_t nearChild = node.first;
+			uint32_t farChild = node.first + 1;
+			float nearDistance = intersectRay(nodes[nearChild].min, nodes[nearChild].max, origin, inverseDirection, hit.distance);
+			float farDistance = intersectRay(nodes[farChild].min, nodes[farChild].max, origin, inverseDirection, hit.distance);
+
+			if (farDistance < nearDistance){
+				std::swap(nearChild, farChild);
+				std::swap(nearDistance, farDistance);
+			}
+
+			if (farDistance != FLT_MAX) stack.push_back({farChild, farDistance});
+			if (nearDistance != FLT_MAX) stack.push_back({nearChild, nearDistance});
+		}
+
+		return hit.object == NO_OBJECT ? Hit{} : hit;
+	}
+}
\ No newline at end of file
@@ -21,6 +21,8 @@ namespace vk_engine{
 	}
 
 	Buffer::~Buffer(){
+		device.notifyDestroyed(buffer);
+
 		unmap();
 		vkDestroyBuffer(device, buffer, nullptr);
 		vkFreeMemory(device, memory, nullptr);
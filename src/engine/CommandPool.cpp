@@ -20,4 +20,9 @@ namespace vk_engine{
 		if (vkCreateCommandPool(device, &createInfo, nullptr, &commandPool) != VK_SUCCESS)
 			throw std::runtime_error("failed to create command buffer");
 	}
+
+	void CommandPool::reset(bool releaseResources){
+		if (vkResetCommandPool(device, commandPool, releaseResources ? VK_COMMAND_POOL_RESET_RELEASE_RESOURCES_BIT : 0) != VK_SUCCESS)
+			throw std::runtime_error("failed to reset command pool");
+	}
 }
\ No newline at end of file
@@ -0,0 +1,113 @@
+#include "engine/ComputePipeline.hpp"
+#include "engine/Hash.hpp"
+
+// std
+#include <stdexcept>
+
+namespace vk_engine{
+	ComputePipeline::ComputePipeline(LogicalDevice &device) : device{device}{}
+
+	ComputePipeline::~ComputePipeline(){
+		vkDestroyPipeline(device, pipeline, nullptr);
+	}
+
+	void ComputePipeline::build(){
+		assert(!builded && "cannot build a pipeline twice");
+		assert((pipelineLayout != VK_NULL_HANDLE || layoutCache) && "cannot create a compute pipeline without a valid pipelineLayout or layout cache");
+
+		VkShaderModule module;
+		if (moduleCache){
+			module = moduleCache->getModule(filepath);
+			reflection = moduleCache->getReflection(filepath);
+		} else {
+			MappedFile file = ShaderModuleCache::mapFile(filepath);
+			const uint32_t *code = file.as<uint32_t>();
+			size_t wordCount = file.size() / sizeof(uint32_t);
+
+			reflection = ShaderReflection(code, wordCount);
+			module = ShaderModuleCache::createShaderModule(device, code, wordCount);
+		}
+
+		try {
+			if (reflection.getStage() != VK_SHADER_STAGE_COMPUTE_BIT)
+				throw std::runtime_error("not a compute shader : " + filepath);
+
+			resolveLocalSize();
+
+			if (pipelineLayout == VK_NULL_HANDLE)
+				pipelineLayout = layoutCache->getReflected({&reflection}, {}, fixedSetLayouts);
+		} catch (const std::exception &){
+			// the module of the cache is owned by it, the one created here would be created again by the next build
+			if (!moduleCache) vkDestroyShaderModule(device, module, nullptr);
+			throw;
+		}
+
+		VkComputePipelineCreateInfo createInfo{};
+		createInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+		createInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+		createInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+		createInfo.stage.module = module;
+		createInfo.stage.pName = "main";
+		createInfo.stage.pSpecializationInfo = constants.getInfo();
+		createInfo.layout = pipelineLayout;
+		createInfo.basePipelineHandle = VK_NULL_HANDLE;
+		createInfo.basePipelineIndex = -1;
+
+		VkResult result = vkCreateComputePipelines(device, cache ? cache->get() : VK_NULL_HANDLE, 1, &createInfo, nullptr, &pipeline);
+
+		// the module is owned by the cache
+		if (!moduleCache) vkDestroyShaderModule(device, module, nullptr);
+
+		if (result != VK_SUCCESS)
+			throw std::runtime_error("failed to create compute pipeline");
+
+		builded = true;
+	}
+
+	void ComputePipeline::resolveLocalSize(){
+		const ShaderReflection::LocalSize &reflected = reflection.getLocalSize();
+
+		for (int i=0; i<3; i++){
+			localSize[i] = reflected.size[i];
+
+			// the workgroup size can be overriden by a specialization constant
+			if (reflected.specIds[i] != ShaderReflection::NO_SPEC_ID){
+				constants.get(reflected.specIds[i], localSize[i]);
+			}
+		}
+	}
+
+	uint64_t ComputePipeline::getHash() const noexcept{
+		uint64_t seed = HASH_SEED;
+		hashCombine(seed, filepath);
+		seed = constants.hash(seed);
+		hashCombine(seed, pipelineLayout);
+		return seed;
+	}
+
+	void ComputePipeline::bind(VkCommandBuffer commandBuffer){
+		assert(builded && "cannot bind a non builded pipeline");
+		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+	}
+
+	void ComputePipeline::dispatch(VkCommandBuffer commandBuffer, uint32_t width, uint32_t height, uint32_t depth){
+		dispatchGroups(commandBuffer, getGroupCount(width, localSize[0]), getGroupCount(height, localSize[1]), getGroupCount(depth, localSize[2]));
+	}
+
+	void ComputePipeline::dispatchGroups(VkCommandBuffer commandBuffer, uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ){
+		assert(builded && "cannot dispatch a non builded pipeline");
+
+		#ifndef NDEBUG
+			VkPhysicalDeviceLimits limits = device.getPhysicalDevice().getProperties().limits;
+			assert(groupCountX <= limits.maxComputeWorkGroupCount[0] && groupCountY <= limits.maxComputeWorkGroupCount[1] && groupCountZ <= limits.maxComputeWorkGroupCount[2] && "workgroup count exceed the device limits");
+		#endif
+
+		if (groupCountX == 0 || groupCountY == 0 || groupCountZ == 0) return;
+		vkCmdDispatch(commandBuffer, groupCountX, groupCountY, groupCountZ);
+	}
+
+	void ComputePipeline::dispatchIndirect(VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize offset){
+		assert(builded && "cannot dispatch a non builded pipeline");
+		vkCmdDispatchIndirect(commandBuffer, buffer, offset);
+	}
+}
\ No newline at end of file
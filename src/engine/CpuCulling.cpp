@@ -0,0 +1,194 @@
+#include "engine/CpuCulling.hpp"
+
+// std
+#include <algorithm>
+#include <cfloat>
+
+#if defined(__i386__) || defined(__x86_64__)
+	#include <immintrin.h>
+	#define VK_ENGINE_CULLING_X86
+#endif
+
+namespace vk_engine{
+	namespace{
+		// the spheres of [begin, end[ are read from the arrays, the visible indices are written to output
+		struct Spheres{
+			const float *x;
+			const float *y;
+			const float *z;
+			const float *radius;
+		};
+
+		uint32_t cullScalar(const Frustum &frustum, const Spheres &spheres, uint32_t begin, uint32_t end, uint32_t *output) noexcept{
+			uint32_t count = 0;
+
+			for (uint32_t i=begin; i<end; i++){
+				glm::vec3 center(spheres.x[i], spheres.y[i], spheres.z[i]);
+				if (frustum.intersectsSphere(center, spheres.radius[i])) output[count++] = i;
+			}
+
+			return count;
+		}
+
+		#ifdef VK_ENGINE_CULLING_X86
+			// the distances are summed in the order of Frustum::intersectsSphere so every instruction set finds the same spheres
+
+			__attribute__((target("sse")))
+			uint32_t cullSSE(const Frustum &frustum, const Spheres &spheres, uint32_t begin, uint32_t end, uint32_t *output) noexcept{
+				uint32_t count = 0;
+
+				for (uint32_t i=begin; i<end; i+=4){
+					const __m128 x = _mm_load_ps(spheres.x + i);
+					const __m128 y = _mm_load_ps(spheres.y + i);
+					const __m128 z = _mm_load_ps(spheres.z + i);
+					const __m128 negativeRadius = _mm_sub_ps(_mm_setzero_ps(), _mm_load_ps(spheres.radius + i));
+
+					__m128 inside = _mm_setzero_ps();
+					for (int p=0; p<6; p++){
+						const glm::vec4 &plane = frustum.planes[p];
+
+						__m128 distance = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane.x), x), _mm_mul_ps(_mm_set1_ps(plane.y), y));
+						distance = _mm_add_ps(distance, _mm_mul_ps(_mm_set1_ps(plane.z), z));
+						distance = _mm_add_ps(distance, _mm_set1_ps(plane.w));
+
+						const __m128 planeInside = _mm_cmpge_ps(distance, negativeRadius);
+						inside = p == 0 ? planeInside : _mm_and_ps(inside, planeInside);
+					}
+
+					for (uint32_t mask = _mm_movemask_ps(inside); mask != 0; mask &= mask - 1)
+						output[count++] = i + __builtin_ctz(mask);
+				}
+
+				return count;
+			}
+
+			__attribute__((target("avx")))
+			uint32_t cullAVX(const Frustum &frustum, const Spheres &spheres, uint32_t begin, uint32_t end, uint32_t *output) noexcept{
+				uint32_t count = 0;
+
+				for (uint32_t i=begin; i<end; i+=8){
+					const __m256 x = _mm256_load_ps(spheres.x + i);
+					const __m256 y = _mm256_load_ps(spheres.y + i);
+					const __m256 z = _mm256_load_ps(spheres.z + i);
+					const __m256 negativeRadius = _mm256_sub_ps(_mm256_setzero_ps(), _mm256_load_ps(spheres.radius + i));
+
+					__m256 inside = _mm256_setzero_ps();
+					for (int p=0; p<6; p++){
+						const glm::vec4 &plane = frustum.planes[p];
+
+						__m256 distance = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(plane.x), x), _mm256_mul_ps(_mm256_set1_ps(plane.y), y));
+						distance = _mm256_add_ps(distance, _mm256_mul_ps(_mm256_set1_ps(plane.z), z));
+						distance = _mm256_add_ps(distance, _mm256_set1_ps(plane.w));
+
+						const __m256 planeInside = _mm256_cmp_ps(distance, negativeRadius, _CMP_GE_OQ);
+						inside = p == 0 ? planeInside : _mm256_and_ps(inside, planeInside);
+					}
+
+					for (uint32_t mask = _mm256_movemask_ps(inside); mask != 0; mask &= mask - 1)
+						output[count++] = i + __builtin_ctz(mask);
+				}
+
+				return count;
+			}
+		#endif
+	}
+
+	CpuCulling::CpuCulling(){
+		if (isSupported(INSTRUCTION_SET_AVX)){
+			instructionSet = INSTRUCTION_SET_AVX;
+		} else if (isSupported(INSTRUCTION_SET_SSE)){
+			instructionSet = INSTRUCTION_SET_SSE;
+		}
+	}
+
+	bool CpuCulling::isSupported(InstructionSet set) noexcept{
+		#ifdef VK_ENGINE_CULLING_X86
+			__builtin_cpu_init();
+
+			switch (set){
+				case INSTRUCTION_SET_SCALAR: return true;
+				case INSTRUCTION_SET_SSE: return __builtin_cpu_supports("sse");
+				case INSTRUCTION_SET_AVX: return __builtin_cpu_supports("avx");
+			}
+			return false;
+		#else
+			return set == INSTRUCTION_SET_SCALAR;
+		#endif
+	}
+
+	void CpuCulling::reserve(uint32_t count){
+		const size_t padded = (static_cast<size_t>(count) + BLOCK_SIZE - 1) / BLOCK_SIZE * BLOCK_SIZE;
+
+		centersX.reserve(padded);
+		centersY.reserve(padded);
+		centersZ.reserve(padded);
+		radii.reserve(padded);
+	}
+
+	uint32_t CpuCulling::add(const glm::vec4 &sphere){
+		assert(sphere.w >= 0.f && "the radius of a sphere must be positive");
+
+		// a new block of padding, the spheres are at the origin with a radius no distance is below
+		if (count == centersX.size()){
+			centersX.resize(count + BLOCK_SIZE, 0.f);
+			centersY.resize(count + BLOCK_SIZE, 0.f);
+			centersZ.resize(count + BLOCK_SIZE, 0.f);
+			radii.resize(count + BLOCK_SIZE, -FLT_MAX);
+		}
+
+		const uint32_t index = count++;
+		set(index, sphere);
+		return index;
+	}
+
+	void CpuCulling::clear() noexcept{
+		count = 0;
+		centersX.clear();
+		centersY.clear();
+		centersZ.clear();
+		radii.clear();
+		visible.clear();
+	}
+
+	const std::vector<uint32_t> &CpuCulling::cull(const Frustum &frustum){
+		const uint32_t paddedCount = static_cast<uint32_t>(centersX.size());
+		const uint32_t chunkCount = (paddedCount + CHUNK_SIZE - 1) / CHUNK_SIZE;
+
+		visible.clear();
+		if (chunkCount == 0) return visible;
+
+		if (chunkIndices.size() < paddedCount) chunkIndices.resize(paddedCount);
+		chunkCounts.resize(chunkCount);
+
+		ThreadPool::parallelFor(threadPool, chunkCount, [&](uint32_t chunk){
+			chunkCounts[chunk] = cullChunk(frustum, chunk, chunkIndices.data() + chunk * CHUNK_SIZE);
+		});
+
+		// compact the indices of the chunks, in increasing order
+		size_t total = 0;
+		for (uint32_t chunk : chunkCounts)
+			total += chunk;
+
+		visible.reserve(total);
+		for (uint32_t chunk=0; chunk<chunkCount; chunk++){
+			const uint32_t *indices = chunkIndices.data() + chunk * CHUNK_SIZE;
+			visible.insert(visible.end(), indices, indices + chunkCounts[chunk]);
+		}
+
+		return visible;
+	}
+
+	uint32_t CpuCulling::cullChunk(const Frustum &frustum, uint32_t chunk, uint32_t *output) const noexcept{
+		const uint32_t begin = chunk * CHUNK_SIZE;
+		const uint32_t end = std::min(static_cast<uint32_t>(centersX.size()), begin + CHUNK_SIZE);
+		const Spheres spheres{centersX.data(), centersY.data(), centersZ.data(), radii.data()};
+
+		switch (instructionSet){
+			#ifdef VK_ENGINE_CULLING_X86
+				case INSTRUCTION_SET_SSE: return cullSSE(frustum, spheres, begin, end, output);
+				case INSTRUCTION_SET_AVX: return cullAVX(frustum, spheres, begin, end, output);
+			#endif
+			default: return cullScalar(frustum, spheres, begin, end, output);
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,125 @@
+#include "engine/DescriptorAllocator.hpp"
+
+// std
+#include <stdexcept>
+#include <cassert>
+#include <algorithm>
+
+namespace vk_engine{
+	DescriptorAllocator::DescriptorAllocator(LogicalDevice &device) : device{device}, poolFactory{device, 0, 256}{}
+
+	DescriptorAllocator::~DescriptorAllocator(){
+		for (auto &frame : frames){
+			for (auto &pool : frame.pools)
+				vkDestroyDescriptorPool(device, pool, nullptr);
+		}
+
+		for (auto &pool : freePools)
+			vkDestroyDescriptorPool(device, pool, nullptr);
+	}
+
+	void DescriptorAllocator::build(){
+		assert(framesInFlight > 0 && "cannot build a descriptor allocator without frames");
+		frames.resize(framesInFlight);
+	}
+
+	void DescriptorAllocator::beginFrame(uint32_t frameIndex){
+		assert(frameIndex < frames.size() && "invalid frame index");
+		std::lock_guard<std::mutex> lock(mutex);
+
+		Frame &frame = frames[frameIndex];
+		for (auto &pool : frame.pools){
+			vkResetDescriptorPool(device, pool, 0);
+			freePools.push_back(pool);
+		}
+
+		frame.pools.clear();
+		currentFrame = frameIndex;
+	}
+
+	VkDescriptorSet DescriptorAllocator::allocate(VkDescriptorSetLayout layout){
+		return allocate(layout, nullptr, 0);
+	}
+
+	VkDescriptorSet DescriptorAllocator::allocate(VkDescriptorSetLayout layout, uint32_t variableCount){
+		VkDescriptorSetVariableDescriptorCountAllocateInfo variableInfo{};
+		variableInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_VARIABLE_DESCRIPTOR_COUNT_ALLOCATE_INFO;
+		variableInfo.descriptorSetCount = 1;
+		variableInfo.pDescriptorCounts = &variableCount;
+
+		return allocate(layout, &variableInfo, variableCount);
+	}
+
+	VkDescriptorSet DescriptorAllocator::allocate(VkDescriptorSetLayout layout, const void *pNext, uint32_t variableCount){
+		assert(!frames.empty() && "cannot allocate from a descriptor allocator before the build");
+		std::lock_guard<std::mutex> lock(mutex);
+
+		VkDescriptorSetAllocateInfo allocInfo{};
+		allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+		allocInfo.pNext = pNext;
+		allocInfo.descriptorPool = getPool();
+		allocInfo.descriptorSetCount = 1;
+		allocInfo.pSetLayouts = &layout;
+
+		VkDescriptorSet set;
+		VkResult result = vkAllocateDescriptorSets(device, &allocInfo, &set);
+
+		// the pool is full, continue with a new one
+		if (result == VK_ERROR_OUT_OF_POOL_MEMORY || result == VK_ERROR_FRAGMENTED_POOL){
+			allocInfo.descriptorPool = addPool();
+			result = vkAllocateDescriptorSets(device, &allocInfo, &set);
+		}
+
+		// the set is bigger than the pools, a pool is sized for it
+		if (result == VK_ERROR_OUT_OF_POOL_MEMORY || result == VK_ERROR_FRAGMENTED_POOL){
+			allocInfo.descriptorPool = addPool(layout, variableCount);
+			result = vkAllocateDescriptorSets(device, &allocInfo, &set);
+		}
+
+		if (result != VK_SUCCESS)
+			throw std::runtime_error("failed to allocate descriptor set");
+
+		return set;
+	}
+
+	VkDescriptorPool DescriptorAllocator::getPool(){
+		Frame &frame = frames[currentFrame];
+		return frame.pools.empty() ? addPool() : frame.pools.back();
+	}
+
+	VkDescriptorPool DescriptorAllocator::addPool(){
+		Frame &frame = frames[currentFrame];
+
+		if (freePools.empty()){
+			frame.pools.push_back(poolFactory.create());
+		} else {
+			frame.pools.push_back(freePools.back());
+			freePools.pop_back();
+		}
+		return frame.pools.back();
+	}
+
+	VkDescriptorPool DescriptorAllocator::addPool(VkDescriptorSetLayout layout, uint32_t variableCount){
+		if (!setLayoutCache)
+			throw std::runtime_error("the descriptor set needs more descriptors than a pool, increase the pool sizes or set the layout cache");
+
+		// the variable sized binding is the last one
+		const std::vector<DescriptorSetLayoutCache::Binding> &bindings = setLayoutCache->getBindings(layout);
+		std::vector<VkDescriptorPoolSize> sizes;
+
+		for (size_t i=0; i<bindings.size(); i++){
+			const bool variable = i + 1 == bindings.size() && (bindings[i].flags & VK_DESCRIPTOR_BINDING_VARIABLE_DESCRIPTOR_COUNT_BIT);
+			const uint32_t count = variable ? variableCount : bindings[i].count;
+
+			auto size = std::find_if(sizes.begin(), sizes.end(), [&](const VkDescriptorPoolSize &size){return size.type == bindings[i].type;});
+			if (size == sizes.end()){
+				sizes.push_back({bindings[i].type, count});
+			} else {
+				size->descriptorCount += count;
+			}
+		}
+
+		frames[currentFrame].pools.push_back(poolFactory.create(sizes));
+		return frames[currentFrame].pools.back();
+	}
+}
\ No newline at end of file
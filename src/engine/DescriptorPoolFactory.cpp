@@ -0,0 +1,48 @@
+#include "engine/DescriptorPoolFactory.hpp"
+
+// std
+#include <stdexcept>
+#include <algorithm>
+
+namespace vk_engine{
+	DescriptorPoolFactory::DescriptorPoolFactory(LogicalDevice &device, VkDescriptorPoolCreateFlags flags, uint32_t setsPerPool) : device{device}, flags{flags}, nextPoolSize{setsPerPool}{}
+
+	VkDescriptorPool DescriptorPoolFactory::create(){
+		return create({});
+	}
+
+	VkDescriptorPool DescriptorPoolFactory::create(const std::vector<VkDescriptorPoolSize> &minSizes){
+		uint32_t setCount = nextPoolSize;
+		nextPoolSize = std::min(nextPoolSize * 2, maxSetsPerPool);
+
+		std::vector<VkDescriptorPoolSize> sizes;
+		sizes.reserve(poolSizes.size());
+
+		for (const auto &poolSize : poolSizes)
+			sizes.push_back({poolSize.type, std::max(1U, static_cast<uint32_t>(poolSize.ratio * setCount))});
+
+		for (const auto &minSize : minSizes){
+			auto size = std::find_if(sizes.begin(), sizes.end(), [&](const VkDescriptorPoolSize &size){return size.type == minSize.type;});
+
+			if (size == sizes.end()){
+				sizes.push_back(minSize);
+			} else {
+				size->descriptorCount = std::max(size->descriptorCount, minSize.descriptorCount);
+			}
+		}
+
+		VkDescriptorPoolCreateInfo createInfo{};
+		createInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+		createInfo.flags = flags;
+		createInfo.maxSets = setCount;
+		createInfo.poolSizeCount = static_cast<uint32_t>(sizes.size());
+		createInfo.pPoolSizes = sizes.data();
+
+		VkDescriptorPool pool;
+		if (vkCreateDescriptorPool(device, &createInfo, nullptr, &pool) != VK_SUCCESS)
+			throw std::runtime_error("failed to create descriptor pool");
+
+		poolCount++;
+		return pool;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,234 @@
+#include "engine/DescriptorSetCache.hpp"
+#include "engine/Hash.hpp"
+
+// std
+#include <stdexcept>
+#include <algorithm>
+
+namespace vk_engine{
+	DescriptorSetCache::Write DescriptorSetCache::Write::buffer(uint32_t binding, VkDescriptorType type, const VkDescriptorBufferInfo &info, uint32_t arrayElement) noexcept{
+		Write write;
+		write.binding = binding;
+		write.arrayElement = arrayElement;
+		write.type = type;
+		write.bufferInfo = info;
+		return write;
+	}
+
+	DescriptorSetCache::Write DescriptorSetCache::Write::image(uint32_t binding, VkDescriptorType type, const VkDescriptorImageInfo &info, uint32_t arrayElement) noexcept{
+		Write write;
+		write.binding = binding;
+		write.arrayElement = arrayElement;
+		write.type = type;
+		write.imageInfo = info;
+		return write;
+	}
+
+	bool DescriptorSetCache::Write::isImage() const noexcept{
+		switch (type){
+			case VK_DESCRIPTOR_TYPE_SAMPLER:
+			case VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER:
+			case VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE:
+			case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE:
+			case VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT:
+				return true;
+			default:
+				return false;
+		}
+	}
+
+	DescriptorSetCache::DescriptorSetCache(LogicalDevice &device) : device{device}, poolFactory{device, VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT, 64}{
+		destroyCallback = device.addDestroyCallback([this](uint64_t handle){invalidate(handle);});
+	}
+
+	DescriptorSetCache::~DescriptorSetCache(){
+		device.removeDestroyCallback(destroyCallback);
+
+		for (auto &pool : pools)
+			vkDestroyDescriptorPool(device, pool, nullptr);
+	}
+
+	VkDescriptorSet DescriptorSetCache::get(VkDescriptorSetLayout layout, std::vector<Write> writes){
+		normalize(writes);
+
+		Key key;
+		key.layout = layout;
+		key.writes = std::move(writes);
+
+		std::lock_guard<std::mutex> lock(mutex);
+
+		auto it = sets.find(key);
+		if (it != sets.end()) return it->second.set;
+
+		Entry entry;
+		entry.set = allocate(layout, entry.pool);
+		entry.resources = getResources(key.writes);
+		write(entry.set, key);
+
+		auto inserted = sets.emplace(std::move(key), std::move(entry)).first;
+		for (uint64_t resource : inserted->second.resources)
+			resourceSets[resource].push_back(&inserted->first);
+
+		return inserted->second.set;
+	}
+
+	void DescriptorSetCache::invalidate(uint64_t handle){
+		std::lock_guard<std::mutex> lock(mutex);
+
+		auto it = resourceSets.find(handle);
+		if (it == resourceSets.end()) return;
+
+		std::vector<const Key*> keys = std::move(it->second);
+		resourceSets.erase(it);
+
+		for (const Key *key : keys){
+			auto entry = sets.find(*key);
+			if (entry == sets.end()) continue;
+
+			// remove the set from the other resources referenced by it
+			for (uint64_t resource : entry->second.resources){
+				auto other = resourceSets.find(resource);
+				if (other == resourceSets.end()) continue;
+
+				auto &otherKeys = other->second;
+				otherKeys.erase(std::remove(otherKeys.begin(), otherKeys.end(), key), otherKeys.end());
+				if (otherKeys.empty()) resourceSets.erase(other);
+			}
+
+			vkFreeDescriptorSets(device, entry->second.pool, 1, &entry->second.set);
+			sets.erase(entry);
+		}
+	}
+
+	void DescriptorSetCache::clear(){
+		std::lock_guard<std::mutex> lock(mutex);
+
+		for (auto &pool : pools)
+			vkResetDescriptorPool(device, pool, 0);
+
+		sets.clear();
+		resourceSets.clear();
+	}
+
+	void DescriptorSetCache::normalize(std::vector<Write> &writes){
+		std::sort(writes.begin(), writes.end(), [](const Write &a, const Write &b){
+			if (a.binding != b.binding) return a.binding < b.binding;
+			return a.arrayElement < b.arrayElement;
+		});
+
+		// only keep the used info, the other one does not take part in the comparisons
+		for (auto &write : writes){
+			if (write.isImage()){
+				write.bufferInfo = {};
+			} else {
+				write.imageInfo = {};
+			}
+		}
+	}
+
+	std::vector<uint64_t> DescriptorSetCache::getResources(const std::vector<Write> &writes){
+		std::vector<uint64_t> resources;
+
+		for (const auto &write : writes){
+			if (write.isImage()){
+				if (write.imageInfo.imageView != VK_NULL_HANDLE) resources.push_back(LogicalDevice::getHandleKey(write.imageInfo.imageView));
+				if (write.imageInfo.sampler != VK_NULL_HANDLE) resources.push_back(LogicalDevice::getHandleKey(write.imageInfo.sampler));
+			} else {
+				resources.push_back(LogicalDevice::getHandleKey(write.bufferInfo.buffer));
+			}
+		}
+
+		std::sort(resources.begin(), resources.end());
+		resources.erase(std::unique(resources.begin(), resources.end()), resources.end());
+		return resources;
+	}
+
+	VkDescriptorSet DescriptorSetCache::allocate(VkDescriptorSetLayout layout, VkDescriptorPool &pool){
+		VkDescriptorSetAllocateInfo allocInfo{};
+		allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+		allocInfo.descriptorSetCount = 1;
+		allocInfo.pSetLayouts = &layout;
+
+		VkDescriptorSet set;
+
+		// the last pool is the most likely to have space left, the older ones only get space back from the invalidated sets
+		for (auto it = pools.rbegin(); it != pools.rend(); it++){
+			allocInfo.descriptorPool = *it;
+			VkResult result = vkAllocateDescriptorSets(device, &allocInfo, &set);
+
+			if (result == VK_SUCCESS){
+				pool = *it;
+				return set;
+			}
+
+			if (result != VK_ERROR_OUT_OF_POOL_MEMORY && result != VK_ERROR_FRAGMENTED_POOL)
+				throw std::runtime_error("failed to allocate descriptor set");
+		}
+
+		pools.push_back(poolFactory.create());
+		allocInfo.descriptorPool = pools.back();
+
+		if (vkAllocateDescriptorSets(device, &allocInfo, &set) != VK_SUCCESS)
+			throw std::runtime_error("failed to allocate descriptor set");
+
+		pool = pools.back();
+		return set;
+	}
+
+	void DescriptorSetCache::write(VkDescriptorSet set, const Key &key){
+		std::vector<VkWriteDescriptorSet> descriptorWrites(key.writes.size());
+
+		for (size_t i=0; i<key.writes.size(); i++){
+			const Write &write = key.writes[i];
+			VkWriteDescriptorSet &descriptorWrite = descriptorWrites[i];
+
+			descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			descriptorWrite.dstSet = set;
+			descriptorWrite.dstBinding = write.binding;
+			descriptorWrite.dstArrayElement = write.arrayElement;
+			descriptorWrite.descriptorCount = 1;
+			descriptorWrite.descriptorType = write.type;
+
+			if (write.isImage()){
+				descriptorWrite.pImageInfo = &write.imageInfo;
+			} else {
+				descriptorWrite.pBufferInfo = &write.bufferInfo;
+			}
+		}
+
+		vkUpdateDescriptorSets(device, static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
+		updateCount++;
+	}
+
+	bool DescriptorSetCache::Key::operator==(const Key &other) const noexcept{
+		if (layout != other.layout || writes.size() != other.writes.size()) return false;
+
+		for (size_t i=0; i<writes.size(); i++){
+			const Write &a = writes[i];
+			const Write &b = other.writes[i];
+
+			if (a.binding != b.binding || a.arrayElement != b.arrayElement || a.type != b.type) return false;
+			if (a.bufferInfo.buffer != b.bufferInfo.buffer || a.bufferInfo.offset != b.bufferInfo.offset || a.bufferInfo.range != b.bufferInfo.range) return false;
+			if (a.imageInfo.sampler != b.imageInfo.sampler || a.imageInfo.imageView != b.imageInfo.imageView || a.imageInfo.imageLayout != b.imageInfo.imageLayout) return false;
+		}
+		return true;
+	}
+
+	size_t DescriptorSetCache::KeyHash::operator()(const Key &key) const noexcept{
+		uint64_t seed = HASH_SEED;
+		hashCombine(seed, key.layout);
+
+		for (const auto &write : key.writes){
+			hashCombine(seed, write.binding);
+			hashCombine(seed, write.arrayElement);
+			hashCombine(seed, write.type);
+			hashCombine(seed, write.bufferInfo.buffer);
+			hashCombine(seed, write.bufferInfo.offset);
+			hashCombine(seed, write.bufferInfo.range);
+			hashCombine(seed, write.imageInfo.sampler);
+			hashCombine(seed, write.imageInfo.imageView);
+			hashCombine(seed, write.imageInfo.imageLayout);
+		}
+		return static_cast<size_t>(seed);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,129 @@
+#include "engine/DescriptorSetLayoutCache.hpp"
+#include "engine/Hash.hpp"
+
+// std
+#include <stdexcept>
+#include <algorithm>
+
+namespace vk_engine{
+	DescriptorSetLayoutCache::DescriptorSetLayoutCache(LogicalDevice &device) : device{device}{}
+
+	DescriptorSetLayoutCache::~DescriptorSetLayoutCache(){
+		for (auto &layout : layouts)
+			vkDestroyDescriptorSetLayout(device, layout.second, nullptr);
+	}
+
+	VkDescriptorSetLayout DescriptorSetLayoutCache::get(std::vector<Binding> bindings, VkDescriptorSetLayoutCreateFlags flags){
+		normalize(bindings);
+
+		Key key;
+		key.bindings = std::move(bindings);
+		key.flags = flags;
+
+		std::lock_guard<std::mutex> lock(mutex);
+
+		auto it = layouts.find(key);
+		if (it != layouts.end()) return it->second;
+
+		VkDescriptorSetLayout layout = create(key);
+		auto inserted = layouts.emplace(std::move(key), layout).first;
+		keys[layout] = &inserted->first;
+
+		return layout;
+	}
+
+	const std::vector<DescriptorSetLayoutCache::Binding> &DescriptorSetLayoutCache::getBindings(VkDescriptorSetLayout layout){
+		std::lock_guard<std::mutex> lock(mutex);
+
+		auto it = keys.find(layout);
+		if (it == keys.end())
+			throw std::runtime_error("the descriptor set layout has not been created by this cache");
+
+		return it->second->bindings;
+	}
+
+	void DescriptorSetLayoutCache::normalize(std::vector<Binding> &bindings){
+		std::sort(bindings.begin(), bindings.end(), [](const Binding &a, const Binding &b){return a.binding < b.binding;});
+
+		// the same binding used by multiple stages
+		std::vector<Binding> merged;
+		for (const auto &binding : bindings){
+			if (!merged.empty() && merged.back().binding == binding.binding){
+				Binding &previous = merged.back();
+
+				if (previous.type != binding.type || previous.count != binding.count)
+					throw std::runtime_error("conflicting declarations of the descriptor binding " + std::to_string(binding.binding));
+
+				previous.stages |= binding.stages;
+				previous.flags |= binding.flags;
+				continue;
+			}
+			merged.push_back(binding);
+		}
+
+		bindings = std::move(merged);
+	}
+
+	VkDescriptorSetLayout DescriptorSetLayoutCache::create(const Key &key){
+		std::vector<VkDescriptorSetLayoutBinding> layoutBindings(key.bindings.size());
+		std::vector<VkDescriptorBindingFlags> bindingFlags(key.bindings.size());
+		bool hasBindingFlags = false;
+
+		for (size_t i=0; i<key.bindings.size(); i++){
+			const Binding &binding = key.bindings[i];
+
+			layoutBindings[i].binding = binding.binding;
+			layoutBindings[i].descriptorType = binding.type;
+			layoutBindings[i].descriptorCount = binding.count;
+			layoutBindings[i].stageFlags = binding.stages;
+			layoutBindings[i].pImmutableSamplers = nullptr;
+
+			bindingFlags[i] = binding.flags;
+			hasBindingFlags |= binding.flags != 0;
+		}
+
+		VkDescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsInfo{};
+		bindingFlagsInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+		bindingFlagsInfo.bindingCount = static_cast<uint32_t>(bindingFlags.size());
+		bindingFlagsInfo.pBindingFlags = bindingFlags.data();
+
+		VkDescriptorSetLayoutCreateInfo createInfo{};
+		createInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+		createInfo.pNext = hasBindingFlags ? &bindingFlagsInfo : nullptr;
+		createInfo.flags = key.flags;
+		createInfo.bindingCount = static_cast<uint32_t>(layoutBindings.size());
+		createInfo.pBindings = layoutBindings.data();
+
+		VkDescriptorSetLayout layout;
+		if (vkCreateDescriptorSetLayout(device, &createInfo, nullptr, &layout) != VK_SUCCESS)
+			throw std::runtime_error("failed to create descriptor set layout");
+
+		return layout;
+	}
+
+	bool DescriptorSetLayoutCache::Key::operator==(const Key &other) const noexcept{
+		if (flags != other.flags || bindings.size() != other.bindings.size()) return false;
+
+		for (size_t i=0; i<bindings.size(); i++){
+			const Binding &a = bindings[i];
+			const Binding &b = other.bindings[i];
+
+			if (a.binding != b.binding || a.type != b.type || a.count != b.count || a.stages != b.stages || a.flags != b.flags) return false;
+		}
+		return true;
+	}
+
+	size_t DescriptorSetLayoutCache::KeyHash::operator()(const Key &key) const noexcept{
+		uint64_t seed = HASH_SEED;
+		hashCombine(seed, key.flags);
+
+		for (const auto &binding : key.bindings){
+			hashCombine(seed, binding.binding);
+			hashCombine(seed, binding.type);
+			hashCombine(seed, binding.count);
+			hashCombine(seed, binding.stages);
+			hashCombine(seed, binding.flags);
+		}
+		return static_cast<size_t>(seed);
+	}
+}
\ No newline at end of file
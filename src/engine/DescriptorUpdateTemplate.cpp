@@ -0,0 +1,134 @@
+#include "engine/DescriptorUpdateTemplate.hpp"
+
+// std
+#include <stdexcept>
+#include <string>
+
+namespace vk_engine{
+	DescriptorUpdateTemplate::DescriptorUpdateTemplate(LogicalDevice &device, DescriptorSetLayoutCache &setLayoutCache) : device{device}, setLayoutCache{setLayoutCache}{}
+
+	DescriptorUpdateTemplate::~DescriptorUpdateTemplate(){
+		if (updateTemplate != VK_NULL_HANDLE) destroyDescriptorUpdateTemplate(device, updateTemplate, nullptr);
+	}
+
+	void DescriptorUpdateTemplate::require(LogicalDevice &device){
+		device.requireOptionalExtension(VK_KHR_DESCRIPTOR_UPDATE_TEMPLATE_EXTENSION_NAME);
+	}
+
+	void DescriptorUpdateTemplate::build(){
+		assert(setLayout != VK_NULL_HANDLE && "cannot build a descriptor update template without set layout");
+		assert(updateTemplate == VK_NULL_HANDLE && "the descriptor update template is already built");
+
+		entries.clear();
+		dataSize = 0;
+
+		// the bindings are sorted by the cache, the descriptors are packed in the same order
+		for (const auto &binding : setLayoutCache.getBindings(setLayout)){
+			size_t size = getDescriptorSize(binding.type);
+			if (size == 0)
+				throw std::runtime_error("the descriptor type of the binding " + std::to_string(binding.binding) + " cannot be updated with a template");
+
+			VkDescriptorUpdateTemplateEntry entry{};
+			entry.dstBinding = binding.binding;
+			entry.dstArrayElement = 0;
+			entry.descriptorCount = binding.count;
+			entry.descriptorType = binding.type;
+			entry.offset = dataSize;
+			entry.stride = size;
+			entries.push_back(entry);
+
+			dataSize += size * binding.count;
+		}
+
+		if (!device.isExtensionEnabled(VK_KHR_DESCRIPTOR_UPDATE_TEMPLATE_EXTENSION_NAME)) return;
+
+		createDescriptorUpdateTemplate = device.getProcAddr<PFN_vkCreateDescriptorUpdateTemplateKHR>("vkCreateDescriptorUpdateTemplateKHR");
+		destroyDescriptorUpdateTemplate = device.getProcAddr<PFN_vkDestroyDescriptorUpdateTemplateKHR>("vkDestroyDescriptorUpdateTemplateKHR");
+		updateDescriptorSetWithTemplate = device.getProcAddr<PFN_vkUpdateDescriptorSetWithTemplateKHR>("vkUpdateDescriptorSetWithTemplateKHR");
+
+		VkDescriptorUpdateTemplateCreateInfo createInfo{};
+		createInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_UPDATE_TEMPLATE_CREATE_INFO;
+		createInfo.descriptorUpdateEntryCount = static_cast<uint32_t>(entries.size());
+		createInfo.pDescriptorUpdateEntries = entries.data();
+		createInfo.templateType = VK_DESCRIPTOR_UPDATE_TEMPLATE_TYPE_DESCRIPTOR_SET;
+		createInfo.descriptorSetLayout = setLayout;
+
+		if (createDescriptorUpdateTemplate(device, &createInfo, nullptr, &updateTemplate) != VK_SUCCESS)
+			throw std::runtime_error("failed to create descriptor update template");
+	}
+
+	void DescriptorUpdateTemplate::update(VkDescriptorSet set, const void *data) const{
+		if (updateTemplate != VK_NULL_HANDLE){
+			updateDescriptorSetWithTemplate(device, set, updateTemplate, data);
+			return;
+		}
+
+		// the descriptors of a binding are consecutive, the writes point directly into the packed struct
+		const char *bytes = static_cast<const char*>(data);
+		std::vector<VkWriteDescriptorSet> writes(entries.size());
+
+		for (size_t i=0; i<entries.size(); i++){
+			const VkDescriptorUpdateTemplateEntry &entry = entries[i];
+			VkWriteDescriptorSet &write = writes[i];
+
+			write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			write.dstSet = set;
+			write.dstBinding = entry.dstBinding;
+			write.dstArrayElement = entry.dstArrayElement;
+			write.descriptorCount = entry.descriptorCount;
+			write.descriptorType = entry.descriptorType;
+
+			const void *descriptors = bytes + entry.offset;
+			switch (entry.descriptorType){
+				case VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER:
+				case VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER:
+					write.pTexelBufferView = static_cast<const VkBufferView*>(descriptors);
+					break;
+
+				case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER:
+				case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER:
+				case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC:
+				case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC:
+					write.pBufferInfo = static_cast<const VkDescriptorBufferInfo*>(descriptors);
+					break;
+
+				default:
+					write.pImageInfo = static_cast<const VkDescriptorImageInfo*>(descriptors);
+					break;
+			}
+		}
+
+		vkUpdateDescriptorSets(device, static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+	}
+
+	size_t DescriptorUpdateTemplate::getOffset(uint32_t binding) const{
+		for (const auto &entry : entries){
+			if (entry.dstBinding == binding) return entry.offset;
+		}
+		throw std::runtime_error("the binding " + std::to_string(binding) + " is not in the descriptor set layout");
+	}
+
+	size_t DescriptorUpdateTemplate::getDescriptorSize(VkDescriptorType type) noexcept{
+		switch (type){
+			case VK_DESCRIPTOR_TYPE_SAMPLER:
+			case VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER:
+			case VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE:
+			case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE:
+			case VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT:
+				return sizeof(VkDescriptorImageInfo);
+
+			case VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER:
+			case VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER:
+				return sizeof(VkBufferView);
+
+			case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER:
+			case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER:
+			case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC:
+			case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC:
+				return sizeof(VkDescriptorBufferInfo);
+
+			default:
+				return 0;
+		}
+	}
+}
\ No newline at end of file
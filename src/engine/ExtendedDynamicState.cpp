@@ -0,0 +1,81 @@
+#include "engine/ExtendedDynamicState.hpp"
+
+// std
+#include <stdexcept>
+#include <algorithm>
+
+namespace vk_engine{
+	ExtendedDynamicState::ExtendedDynamicState(LogicalDevice &device) : device{device}{}
+
+	void ExtendedDynamicState::require(){
+		PhysicalDevice &physicalDevice = device.getPhysicalDevice();
+
+		if (physicalDevice.isExtensionSupported(VK_EXT_EXTENDED_DYNAMIC_STATE_EXTENSION_NAME)){
+			auto features = physicalDevice.getFeatures<VkPhysicalDeviceExtendedDynamicStateFeaturesEXT>(VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_FEATURES_EXT);
+
+			if (features.extendedDynamicState){
+				device.requireExtension(VK_EXT_EXTENDED_DYNAMIC_STATE_EXTENSION_NAME);
+				device.requireFeatures<VkPhysicalDeviceExtendedDynamicStateFeaturesEXT>(VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_FEATURES_EXT).extendedDynamicState = VK_TRUE;
+			}
+		}
+
+		if (physicalDevice.isExtensionSupported(VK_EXT_EXTENDED_DYNAMIC_STATE_2_EXTENSION_NAME)){
+			auto features = physicalDevice.getFeatures<VkPhysicalDeviceExtendedDynamicState2FeaturesEXT>(VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_2_FEATURES_EXT);
+
+			if (features.extendedDynamicState2){
+				device.requireExtension(VK_EXT_EXTENDED_DYNAMIC_STATE_2_EXTENSION_NAME);
+				device.requireFeatures<VkPhysicalDeviceExtendedDynamicState2FeaturesEXT>(VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_2_FEATURES_EXT).extendedDynamicState2 = VK_TRUE;
+			}
+		}
+	}
+
+	void ExtendedDynamicState::build(){
+		dynamicStates.clear();
+
+		auto features = device.getEnabledFeatures<VkPhysicalDeviceExtendedDynamicStateFeaturesEXT>(VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_FEATURES_EXT);
+		supported = device.isExtensionEnabled(VK_EXT_EXTENDED_DYNAMIC_STATE_EXTENSION_NAME) && features && features->extendedDynamicState;
+
+		if (supported){
+			cmdSetCullMode = device.getProcAddr<PFN_vkCmdSetCullModeEXT>("vkCmdSetCullModeEXT");
+			cmdSetFrontFace = device.getProcAddr<PFN_vkCmdSetFrontFaceEXT>("vkCmdSetFrontFaceEXT");
+			cmdSetPrimitiveTopology = device.getProcAddr<PFN_vkCmdSetPrimitiveTopologyEXT>("vkCmdSetPrimitiveTopologyEXT");
+			cmdSetDepthTestEnable = device.getProcAddr<PFN_vkCmdSetDepthTestEnableEXT>("vkCmdSetDepthTestEnableEXT");
+			cmdSetDepthWriteEnable = device.getProcAddr<PFN_vkCmdSetDepthWriteEnableEXT>("vkCmdSetDepthWriteEnableEXT");
+			cmdSetDepthCompareOp = device.getProcAddr<PFN_vkCmdSetDepthCompareOpEXT>("vkCmdSetDepthCompareOpEXT");
+
+			if (!cmdSetCullMode || !cmdSetFrontFace || !cmdSetPrimitiveTopology || !cmdSetDepthTestEnable || !cmdSetDepthWriteEnable || !cmdSetDepthCompareOp)
+				throw std::runtime_error("failed to load the VK_EXT_extended_dynamic_state commands");
+			
+			dynamicStates.insert(dynamicStates.end(), {
+				VK_DYNAMIC_STATE_CULL_MODE_EXT,
+				VK_DYNAMIC_STATE_FRONT_FACE_EXT,
+				VK_DYNAMIC_STATE_PRIMITIVE_TOPOLOGY_EXT,
+				VK_DYNAMIC_STATE_DEPTH_TEST_ENABLE_EXT,
+				VK_DYNAMIC_STATE_DEPTH_WRITE_ENABLE_EXT,
+				VK_DYNAMIC_STATE_DEPTH_COMPARE_OP_EXT
+			});
+		}
+
+		auto features2 = device.getEnabledFeatures<VkPhysicalDeviceExtendedDynamicState2FeaturesEXT>(VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_2_FEATURES_EXT);
+		supported2 = device.isExtensionEnabled(VK_EXT_EXTENDED_DYNAMIC_STATE_2_EXTENSION_NAME) && features2 && features2->extendedDynamicState2;
+
+		if (supported2){
+			cmdSetDepthBiasEnable = device.getProcAddr<PFN_vkCmdSetDepthBiasEnableEXT>("vkCmdSetDepthBiasEnableEXT");
+			cmdSetPrimitiveRestartEnable = device.getProcAddr<PFN_vkCmdSetPrimitiveRestartEnableEXT>("vkCmdSetPrimitiveRestartEnableEXT");
+			cmdSetRasterizerDiscardEnable = device.getProcAddr<PFN_vkCmdSetRasterizerDiscardEnableEXT>("vkCmdSetRasterizerDiscardEnableEXT");
+
+			if (!cmdSetDepthBiasEnable || !cmdSetPrimitiveRestartEnable || !cmdSetRasterizerDiscardEnable)
+				throw std::runtime_error("failed to load the VK_EXT_extended_dynamic_state2 commands");
+
+			dynamicStates.insert(dynamicStates.end(), {
+				VK_DYNAMIC_STATE_DEPTH_BIAS_ENABLE_EXT,
+				VK_DYNAMIC_STATE_PRIMITIVE_RESTART_ENABLE_EXT,
+				VK_DYNAMIC_STATE_RASTERIZER_DISCARD_ENABLE_EXT
+			});
+		}
+	}
+
+	bool ExtendedDynamicState::isDynamic(VkDynamicState state) const noexcept{
+		return std::find(dynamicStates.begin(), dynamicStates.end(), state) != dynamicStates.end();
+	}
+}
\ No newline at end of file
@@ -0,0 +1,46 @@
+#include "engine/FrameCommandPool.hpp"
+
+// std
+#include <stdexcept>
+#include <cassert>
+
+namespace vk_engine{
+	FrameCommandPool::FrameCommandPool(LogicalDevice &device) : device{device}, pool{device}{
+		pool.setFamily(FAMILY_GRAPHIC);
+	}
+
+	void FrameCommandPool::build(){
+		pool.setFlags(CommandPool::FLAG_TRANSIENT);
+		pool.build();
+	}
+
+	void FrameCommandPool::reset(){
+		if (levels[0].used == 0 && levels[1].used == 0) return;
+
+		pool.reset();
+		for (auto &level : levels)
+			level.used = 0;
+	}
+
+	VkCommandBuffer FrameCommandPool::get(VkCommandBufferLevel level){
+		assert(level < levels.size() && "invalid command buffer level");
+		Level &recycled = levels[level];
+
+		if (recycled.used < recycled.commandBuffers.size())
+			return recycled.commandBuffers[recycled.used++];
+
+		VkCommandBufferAllocateInfo allocInfo{};
+		allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+		allocInfo.level = level;
+		allocInfo.commandPool = pool;
+		allocInfo.commandBufferCount = 1;
+
+		VkCommandBuffer commandBuffer;
+		if (vkAllocateCommandBuffers(device, &allocInfo, &commandBuffer) != VK_SUCCESS)
+			throw std::runtime_error("failed to allocate command buffer");
+
+		recycled.commandBuffers.push_back(commandBuffer);
+		recycled.used++;
+		return commandBuffer;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,357 @@
+#include "engine/GpuCulling.hpp"
+
+// std
+#include <stdexcept>
+#include <cstring>
+#include <algorithm>
+#include <iterator>
+
+namespace vk_engine{
+	namespace{
+		// the push constants of cull.comp
+		struct CullBatch{
+			uint32_t firstCommand;
+			uint32_t commandCount;
+			uint32_t index;
+		};
+
+		// the push constants of depth_pyramid.comp
+		struct PyramidSizes{
+			int32_t sourceWidth;
+			int32_t sourceHeight;
+			int32_t destinationWidth;
+			int32_t destinationHeight;
+		};
+
+		uint32_t previousPowerOfTwo(uint32_t value) noexcept{
+			uint32_t power = 1;
+			while (power * 2 <= value) power *= 2;
+			return power;
+		}
+
+		VkBufferMemoryBarrier2KHR getBufferBarrier(VkBuffer buffer, VkPipelineStageFlags2KHR srcStages, VkAccessFlags2KHR srcAccess, VkPipelineStageFlags2KHR dstStages, VkAccessFlags2KHR dstAccess) noexcept{
+			VkBufferMemoryBarrier2KHR barrier{};
+			barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2_KHR;
+			barrier.srcStageMask = srcStages;
+			barrier.srcAccessMask = srcAccess;
+			barrier.dstStageMask = dstStages;
+			barrier.dstAccessMask = dstAccess;
+			barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier.buffer = buffer;
+			barrier.offset = 0;
+			barrier.size = VK_WHOLE_SIZE;
+			return barrier;
+		}
+	}
+
+	GpuCulling::GpuCulling(LogicalDevice &device, IndirectScene &scene, const MultiDrawIndirect &multiDrawIndirect, PipelineLayoutCache &layoutCache, DescriptorAllocator &descriptorAllocator) :
+		device{device}, scene{scene}, multiDrawIndirect{multiDrawIndirect}, layoutCache{layoutCache}, descriptorAllocator{descriptorAllocator}{}
+
+	GpuCulling::~GpuCulling(){
+		destroyPyramid();
+		device.notifyDestroyed(sampler);
+		vkDestroySampler(device, sampler, nullptr);
+	}
+
+	void GpuCulling::build(){
+		assert(scene.getCapacity() > 0 && maxBatches > 0 && "cannot build the culling of an empty scene");
+
+		// the commands are found by the culling from the object ids in their first instance
+		if (!multiDrawIndirect.isFirstInstanceSupported())
+			throw std::runtime_error("failed to build the gpu culling, drawIndirectFirstInstance is not supported");
+
+		if (!moduleCache && (cullFile == DEFAULT_CULL_SHADER || pyramidFile == DEFAULT_PYRAMID_SHADER))
+			throw std::runtime_error("failed to build the gpu culling, the default shaders are loaded from the shader archive of a shader module cache");
+
+		compact = multiDrawIndirect.isCountSupported();
+
+		cullPipeline = std::make_unique<ComputePipeline>(device);
+		cullPipeline->setShaderFile(cullFile);
+		cullPipeline->setPipelineLayoutCache(layoutCache);
+		cullPipeline->setSpecializationConstant(0, compact);
+		if (moduleCache) cullPipeline->setShaderModuleCache(*moduleCache);
+		if (pipelineCache) cullPipeline->setPipelineCache(*pipelineCache);
+		cullPipeline->build();
+
+		pyramidPipeline = std::make_unique<ComputePipeline>(device);
+		pyramidPipeline->setShaderFile(pyramidFile);
+		pyramidPipeline->setPipelineLayoutCache(layoutCache);
+		if (moduleCache) pyramidPipeline->setShaderModuleCache(*moduleCache);
+		if (pipelineCache) pyramidPipeline->setPipelineCache(*pipelineCache);
+		pyramidPipeline->build();
+
+		frames.clear();
+
+		for (uint32_t i=0; i<scene.getFramesInFlight(); i++){
+			Frame frame;
+			frame.commands = std::make_unique<Buffer>(device, sizeof(VkDrawIndexedIndirectCommand), scene.getCapacity(), VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+			frame.counts = std::make_unique<Buffer>(device, sizeof(uint32_t), maxBatches, VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+			frame.cullData = std::make_unique<Buffer>(device, sizeof(CullData), 1, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+
+			if (frame.cullData->map() != VK_SUCCESS)
+				throw std::runtime_error("failed to map the culling data");
+
+			frames.push_back(std::move(frame));
+		}
+
+		if (sampler == VK_NULL_HANDLE){
+			VkSamplerCreateInfo samplerInfo{};
+			samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+			samplerInfo.magFilter = VK_FILTER_NEAREST;
+			samplerInfo.minFilter = VK_FILTER_NEAREST;
+			samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+			samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+			samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+			samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+			samplerInfo.maxLod = VK_LOD_CLAMP_NONE;
+
+			if (vkCreateSampler(device, &samplerInfo, nullptr, &sampler) != VK_SUCCESS)
+				throw std::runtime_error("failed to create the depth pyramid sampler");
+		}
+
+		// a placeholder bound until the first depth pyramid
+		if (pyramid == VK_NULL_HANDLE) createPyramid({1, 1});
+	}
+
+	void GpuCulling::cull(VkCommandBuffer commandBuffer, const glm::mat4 &viewProjection){
+		assert(!frames.empty() && "cannot cull before the build");
+		assert(scene.getBatchCount() <= maxBatches && "the scene has more batches than the culling");
+
+		Frame &frame = frames[scene.getCurrentFrame()];
+
+		CullData data;
+		data.viewProjection = viewProjection;
+		Frustum frustum = Frustum::fromMatrix(viewProjection);
+		std::copy(std::begin(frustum.planes), std::end(frustum.planes), data.planes);
+		data.pyramidSize = glm::vec2(static_cast<float>(pyramidExtent.width), static_cast<float>(pyramidExtent.height));
+		data.pyramidLevels = pyramidLevels;
+		data.occlusion = occlusion && pyramidValid ? 1 : 0;
+		std::memcpy(frame.cullData->getMappedMemory(), &data, sizeof(CullData));
+
+		std::vector<VkImageMemoryBarrier2KHR> imageBarriers;
+		std::vector<VkBufferMemoryBarrier2KHR> bufferBarriers;
+
+		if (compact){
+			vkCmdFillBuffer(commandBuffer, frame.counts->getBuffer(), 0, VK_WHOLE_SIZE, 0);
+			bufferBarriers.push_back(getBufferBarrier(frame.counts->getBuffer(), VK_PIPELINE_STAGE_2_TRANSFER_BIT_KHR, VK_ACCESS_2_TRANSFER_WRITE_BIT_KHR,
+				VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT_KHR, VK_ACCESS_2_SHADER_READ_BIT_KHR | VK_ACCESS_2_SHADER_WRITE_BIT_KHR));
+		}
+
+		if (!pyramidInitialized){
+			imageBarriers.push_back(getPyramidBarrier(0, pyramidLevels, VK_IMAGE_LAYOUT_UNDEFINED, VK_PIPELINE_STAGE_2_NONE_KHR, 0, VK_ACCESS_2_SHADER_READ_BIT_KHR));
+			pyramidInitialized = true;
+		}
+
+		pipelineBarrier(commandBuffer, imageBarriers, bufferBarriers);
+
+		VkDescriptorSet set = descriptorAllocator.allocate(layoutCache.getSetLayouts(cullPipeline->getPipelineLayout())[0]);
+		uint32_t frameIndex = scene.getCurrentFrame();
+
+		VkDescriptorBufferInfo bufferInfos[6] = {
+			frame.cullData->descriptorInfo(),
+			scene.getCommandBuffer(frameIndex).descriptorInfo(),
+			scene.getObjectBuffer(frameIndex).descriptorInfo(),
+			scene.getBoundsBuffer(frameIndex).descriptorInfo(),
+			frame.commands->descriptorInfo(),
+			frame.counts->descriptorInfo()
+		};
+		VkDescriptorImageInfo imageInfo{sampler, pyramidView, VK_IMAGE_LAYOUT_GENERAL};
+
+		VkWriteDescriptorSet writes[7]{};
+		for (uint32_t i=0; i<7; i++){
+			writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			writes[i].dstSet = set;
+			writes[i].dstBinding = i;
+			writes[i].descriptorCount = 1;
+
+			if (i < 6){
+				writes[i].descriptorType = i == 0 ? VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER : VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+				writes[i].pBufferInfo = &bufferInfos[i];
+			} else {
+				writes[i].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+				writes[i].pImageInfo = &imageInfo;
+			}
+		}
+
+		vkUpdateDescriptorSets(device, 7, writes, 0, nullptr);
+
+		cullPipeline->bind(commandBuffer);
+		vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, cullPipeline->getPipelineLayout(), 0, 1, &set, 0, nullptr);
+
+		// a dispatch per batch, the invocations of a batch share its counter
+		for (uint32_t i=0; i<scene.getBatchCount(); i++){
+			CullBatch batch{scene.getBatchFirstCommand(i), scene.getBatchCommandCount(i), i};
+			if (batch.commandCount == 0) continue;
+
+			vkCmdPushConstants(commandBuffer, cullPipeline->getPipelineLayout(), VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(CullBatch), &batch);
+			cullPipeline->dispatch(commandBuffer, batch.commandCount);
+		}
+
+		bufferBarriers.clear();
+		bufferBarriers.push_back(getBufferBarrier(frame.commands->getBuffer(), VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT_KHR, VK_ACCESS_2_SHADER_WRITE_BIT_KHR, VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT_KHR, VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT_KHR));
+
+		if (compact)
+			bufferBarriers.push_back(getBufferBarrier(frame.counts->getBuffer(), VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT_KHR, VK_ACCESS_2_SHADER_WRITE_BIT_KHR, VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT_KHR, VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT_KHR));
+
+		pipelineBarrier(commandBuffer, {}, bufferBarriers);
+	}
+
+	void GpuCulling::draw(VkCommandBuffer commandBuffer){
+		assert(!frames.empty() && "cannot draw before the build");
+		const Frame &frame = frames[scene.getCurrentFrame()];
+
+		scene.record(commandBuffer, frame.commands->getBuffer(), compact ? frame.counts->getBuffer() : VK_NULL_HANDLE);
+	}
+
+	void GpuCulling::buildDepthPyramid(VkCommandBuffer commandBuffer, VkImageView depthView, VkImageLayout depthLayout, VkExtent2D extent){
+		assert(!frames.empty() && "cannot build the depth pyramid before the build");
+
+		VkExtent2D size = {previousPowerOfTwo(extent.width), previousPowerOfTwo(extent.height)};
+		if (size.width != pyramidExtent.width || size.height != pyramidExtent.height){
+			destroyPyramid();
+			createPyramid(size);
+		}
+
+		// wait for the reads of the culling before overwriting the levels
+		VkImageLayout oldLayout = pyramidInitialized ? VK_IMAGE_LAYOUT_GENERAL : VK_IMAGE_LAYOUT_UNDEFINED;
+		pipelineBarrier(commandBuffer, {getPyramidBarrier(0, pyramidLevels, oldLayout, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT_KHR, 0, VK_ACCESS_2_SHADER_WRITE_BIT_KHR)}, {});
+		pyramidInitialized = true;
+
+		pyramidPipeline->bind(commandBuffer);
+		VkDescriptorSetLayout setLayout = layoutCache.getSetLayouts(pyramidPipeline->getPipelineLayout())[0];
+
+		VkExtent2D sourceSize = extent;
+		for (uint32_t level=0; level<pyramidLevels; level++){
+			VkExtent2D levelSize = {std::max(pyramidExtent.width >> level, 1U), std::max(pyramidExtent.height >> level, 1U)};
+
+			VkDescriptorSet set = descriptorAllocator.allocate(setLayout);
+			VkDescriptorImageInfo sourceInfo = level == 0 ? VkDescriptorImageInfo{sampler, depthView, depthLayout} : VkDescriptorImageInfo{sampler, levelViews[level - 1], VK_IMAGE_LAYOUT_GENERAL};
+			VkDescriptorImageInfo destinationInfo{VK_NULL_HANDLE, levelViews[level], VK_IMAGE_LAYOUT_GENERAL};
+
+			VkWriteDescriptorSet writes[2]{};
+			writes[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			writes[0].dstSet = set;
+			writes[0].dstBinding = 0;
+			writes[0].descriptorCount = 1;
+			writes[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+			writes[0].pImageInfo = &sourceInfo;
+
+			writes[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			writes[1].dstSet = set;
+			writes[1].dstBinding = 1;
+			writes[1].descriptorCount = 1;
+			writes[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+			writes[1].pImageInfo = &destinationInfo;
+
+			vkUpdateDescriptorSets(device, 2, writes, 0, nullptr);
+			vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pyramidPipeline->getPipelineLayout(), 0, 1, &set, 0, nullptr);
+
+			PyramidSizes sizes{static_cast<int32_t>(sourceSize.width), static_cast<int32_t>(sourceSize.height), static_cast<int32_t>(levelSize.width), static_cast<int32_t>(levelSize.height)};
+			vkCmdPushConstants(commandBuffer, pyramidPipeline->getPipelineLayout(), VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(PyramidSizes), &sizes);
+			pyramidPipeline->dispatch(commandBuffer, levelSize.width, levelSize.height);
+
+			// the level is read by the next level and by the culling of the next frame
+			pipelineBarrier(commandBuffer, {getPyramidBarrier(level, 1, VK_IMAGE_LAYOUT_GENERAL, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT_KHR, VK_ACCESS_2_SHADER_WRITE_BIT_KHR, VK_ACCESS_2_SHADER_READ_BIT_KHR)}, {});
+			sourceSize = levelSize;
+		}
+
+		pyramidValid = true;
+	}
+
+	void GpuCulling::createPyramid(VkExtent2D extent){
+		pyramidExtent = extent;
+		pyramidLevels = 1;
+		while ((std::max(extent.width, extent.height) >> pyramidLevels) > 0) pyramidLevels++;
+
+		VkImageCreateInfo imageInfo{};
+		imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+		imageInfo.imageType = VK_IMAGE_TYPE_2D;
+		imageInfo.format = VK_FORMAT_R32_SFLOAT;
+		imageInfo.extent = {extent.width, extent.height, 1};
+		imageInfo.mipLevels = pyramidLevels;
+		imageInfo.arrayLayers = 1;
+		imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+		imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+		imageInfo.usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_STORAGE_BIT;
+		imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+		imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+		device.createImageWithInfo(imageInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, pyramid, pyramidMemory);
+
+		VkImageViewCreateInfo viewInfo{};
+		viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+		viewInfo.image = pyramid;
+		viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+		viewInfo.format = VK_FORMAT_R32_SFLOAT;
+		viewInfo.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, pyramidLevels, 0, 1};
+
+		if (vkCreateImageView(device, &viewInfo, nullptr, &pyramidView) != VK_SUCCESS)
+			throw std::runtime_error("failed to create the depth pyramid view");
+
+		levelViews.resize(pyramidLevels, VK_NULL_HANDLE);
+		for (uint32_t level=0; level<pyramidLevels; level++){
+			viewInfo.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, level, 1, 0, 1};
+
+			if (vkCreateImageView(device, &viewInfo, nullptr, &levelViews[level]) != VK_SUCCESS)
+				throw std::runtime_error("failed to create the depth pyramid level view");
+		}
+
+		pyramidInitialized = false;
+		pyramidValid = false;
+	}
+
+	void GpuCulling::destroyPyramid(){
+		for (VkImageView view : levelViews){
+			device.notifyDestroyed(view);
+			vkDestroyImageView(device, view, nullptr);
+		}
+
+		levelViews.clear();
+		device.notifyDestroyed(pyramidView);
+		vkDestroyImageView(device, pyramidView, nullptr);
+
+		device.notifyDestroyed(pyramid);
+		vkDestroyImage(device, pyramid, nullptr);
+		vkFreeMemory(device, pyramidMemory, nullptr);
+
+		pyramid = VK_NULL_HANDLE;
+		pyramidMemory = VK_NULL_HANDLE;
+		pyramidView = VK_NULL_HANDLE;
+		pyramidExtent = {0, 0};
+		pyramidLevels = 0;
+	}
+
+	void GpuCulling::pipelineBarrier(VkCommandBuffer commandBuffer, const std::vector<VkImageMemoryBarrier2KHR> &imageBarriers, const std::vector<VkBufferMemoryBarrier2KHR> &bufferBarriers) const{
+		if (imageBarriers.empty() && bufferBarriers.empty()) return;
+
+		VkDependencyInfoKHR dependency{};
+		dependency.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO_KHR;
+		dependency.imageMemoryBarrierCount = static_cast<uint32_t>(imageBarriers.size());
+		dependency.pImageMemoryBarriers = imageBarriers.data();
+		dependency.bufferMemoryBarrierCount = static_cast<uint32_t>(bufferBarriers.size());
+		dependency.pBufferMemoryBarriers = bufferBarriers.data();
+
+		if (synchronization2){
+			synchronization2->pipelineBarrier(commandBuffer, dependency);
+		} else {
+			Synchronization2::legacyPipelineBarrier(commandBuffer, dependency);
+		}
+	}
+
+	VkImageMemoryBarrier2KHR GpuCulling::getPyramidBarrier(uint32_t baseLevel, uint32_t levelCount, VkImageLayout oldLayout, VkPipelineStageFlags2KHR srcStages, VkAccessFlags2KHR srcAccess, VkAccessFlags2KHR dstAccess) const noexcept{
+		VkImageMemoryBarrier2KHR barrier{};
+		barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2_KHR;
+		barrier.srcStageMask = srcStages;
+		barrier.srcAccessMask = srcAccess;
+		barrier.dstStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT_KHR;
+		barrier.dstAccessMask = dstAccess;
+		barrier.oldLayout = oldLayout;
+		barrier.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+		barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.image = pyramid;
+		barrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, baseLevel, levelCount, 0, 1};
+		return barrier;
+	}
+}
\ No newline at end of file
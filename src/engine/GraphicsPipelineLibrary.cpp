@@ -0,0 +1,85 @@
+#include "engine/GraphicsPipelineLibrary.hpp"
+#include "engine/Hash.hpp"
+
+// std
+#include <stdexcept>
+#include <cassert>
+
+namespace vk_engine{
+	GraphicsPipelineLibrary::GraphicsPipelineLibrary(LogicalDevice &device) : device{device}{}
+
+	GraphicsPipelineLibrary::~GraphicsPipelineLibrary(){
+		for (auto &library : libraries)
+			vkDestroyPipeline(device, library.second, nullptr);
+	}
+
+	void GraphicsPipelineLibrary::require(){
+		PhysicalDevice &physicalDevice = device.getPhysicalDevice();
+
+		if (!physicalDevice.isExtensionSupported(VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME) || !physicalDevice.isExtensionSupported(VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME)) return;
+
+		auto features = physicalDevice.getFeatures<VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT>(VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT);
+		if (!features.graphicsPipelineLibrary) return;
+
+		device.requireExtension(VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME);
+		device.requireExtension(VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME);
+		device.requireFeatures<VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT>(VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT).graphicsPipelineLibrary = VK_TRUE;
+	}
+
+	void GraphicsPipelineLibrary::build(){
+		auto features = device.getEnabledFeatures<VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT>(VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT);
+		supported = device.isExtensionEnabled(VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME) && features && features->graphicsPipelineLibrary;
+
+		if (supported){
+			auto properties = device.getPhysicalDevice().getProperties<VkPhysicalDeviceGraphicsPipelineLibraryPropertiesEXT>(VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_PROPERTIES_EXT);
+			fastLinking = properties.graphicsPipelineLibraryFastLinking;
+		}
+	}
+
+	VkPipeline GraphicsPipelineLibrary::getPart(VkGraphicsPipelineLibraryFlagBitsEXT part, uint64_t hash, const VkGraphicsPipelineCreateInfo &createInfo){
+		assert(supported && "the graphics pipeline libraries are not supported by the device");
+
+		uint64_t key = hash;
+		hashCombine(key, part);
+
+		std::lock_guard<std::mutex> lock(mutex);
+
+		auto it = libraries.find(key);
+		if (it != libraries.end()) return it->second;
+
+		VkGraphicsPipelineLibraryCreateInfoEXT libraryInfo{};
+		libraryInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_LIBRARY_CREATE_INFO_EXT;
+		libraryInfo.flags = part;
+
+		VkGraphicsPipelineCreateInfo partInfo = createInfo;
+		partInfo.pNext = &libraryInfo;
+		partInfo.flags |= VK_PIPELINE_CREATE_LIBRARY_BIT_KHR | VK_PIPELINE_CREATE_RETAIN_LINK_TIME_OPTIMIZATION_INFO_BIT_EXT;
+
+		VkPipeline library;
+		if (vkCreateGraphicsPipelines(device, cache ? cache->get() : VK_NULL_HANDLE, 1, &partInfo, nullptr, &library) != VK_SUCCESS)
+			throw std::runtime_error("failed to create graphics pipeline library");
+
+		libraries[key] = library;
+		return library;
+	}
+
+	VkPipeline GraphicsPipelineLibrary::link(const Parts &parts, VkPipelineLayout layout, bool optimize){
+		VkPipelineLibraryCreateInfoKHR libraryInfo{};
+		libraryInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LIBRARY_CREATE_INFO_KHR;
+		libraryInfo.libraryCount = PART_COUNT;
+		libraryInfo.pLibraries = parts.data();
+
+		VkGraphicsPipelineCreateInfo createInfo{};
+		createInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+		createInfo.pNext = &libraryInfo;
+		createInfo.flags = optimize ? VK_PIPELINE_CREATE_LINK_TIME_OPTIMIZATION_BIT_EXT : 0;
+		createInfo.layout = layout;
+		createInfo.basePipelineIndex = -1;
+
+		VkPipeline pipeline;
+		if (vkCreateGraphicsPipelines(device, cache ? cache->get() : VK_NULL_HANDLE, 1, &createInfo, nullptr, &pipeline) != VK_SUCCESS)
+			throw std::runtime_error("failed to link graphics pipeline libraries");
+
+		return pipeline;
+	}
+}
\ No newline at end of file
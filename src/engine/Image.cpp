@@ -8,12 +8,19 @@
 
 // std
 #include <stdexcept>
+#include <cassert>
 
 namespace vk_engine{
 	
 	Image::Image(LogicalDevice &device, CommandPool &commandPool, const std::string &filepath) : device{device}, commandPool{commandPool}, filepath{filepath}{}
 
 	Image::~Image(){
+		if (bindlessIndex != BindlessTable::INVALID_INDEX) bindlessTable->remove(bindlessIndex);
+
+		device.notifyDestroyed(imageView);
+		device.notifyDestroyed(sampler);
+		device.notifyDestroyed(image);
+
 		vkDestroySampler(device, sampler, nullptr);
 		vkDestroyImageView(device, imageView, nullptr);
 		vkDestroyImage(device, image, nullptr);
@@ -24,6 +31,13 @@ namespace vk_engine{
 		load(filepath);
 	}
 
+	void Image::setBindlessTable(BindlessTable &table){
+		assert(bindlessIndex == BindlessTable::INVALID_INDEX && "the image is already registered into a bindless table");
+		bindlessTable = &table;
+
+		if (isLoaded() && bindlessTable->isSupported()) bindlessIndex = bindlessTable->add(getDescriptorInfo());
+	}
+
 	void Image::load(const std::string &filepath){
 		int texWidth, texHeight, texChannels;
 
@@ -129,12 +143,45 @@ namespace vk_engine{
 
 		vkBindImageMemory(device, image, memory, 0);
 
-		transitionImageLayout(commandPool, device, image, static_cast<VkFormat>(format), VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
-		copyBufferToImage(commandPool, device, stagingBuffer, image, width, height, 1);
-		transitionImageLayout(commandPool, device, image, static_cast<VkFormat>(format), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+		upload(stagingBuffer);
 
 		createImageView();
 		createSampler();
+
+		// the previous index can still be used by the frames in flight, it is only reused after them
+		if (bindlessIndex != BindlessTable::INVALID_INDEX){
+			bindlessTable->remove(bindlessIndex);
+			bindlessIndex = BindlessTable::INVALID_INDEX;
+		}
+
+		if (bindlessTable && bindlessTable->isSupported()) bindlessIndex = bindlessTable->add(getDescriptorInfo());
+	}
+
+	void Image::upload(VkBuffer stagingBuffer){
+		// a local tracker, the one-shot command buffer only records the transitions of this image and keeps the pending barriers of the shared tracker
+		ImageStateTracker tracker(device);
+		tracker.add(image, VK_IMAGE_ASPECT_COLOR_BIT);
+
+		{
+			// the transitions and the copy are recorded in a single submit
+			SingleTimeCommands commandBuffer(commandPool, device, device.getQueues()[0][FAMILY_GRAPHIC]);
+
+			tracker.require(image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+			tracker.flush(commandBuffer);
+
+			VkBufferImageCopy region{};
+			region.imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1};
+			region.imageOffset = {0, 0, 0};
+			region.imageExtent = {extent.width, extent.height, 1};
+
+			vkCmdCopyBufferToImage(commandBuffer, stagingBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+
+			tracker.require(image, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+			tracker.flush(commandBuffer);
+		}
+
+		// the submit is complete, the shared tracker starts from the final layout without pending access
+		if (stateTracker) stateTracker->add(image, VK_IMAGE_ASPECT_COLOR_BIT, 1, 1, {VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, 0, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT});
 	}
 
 	uint32_t Image::formatToLayerCount(Format format) noexcept{
@@ -0,0 +1,295 @@
+#include "engine/ImageStateTracker.hpp"
+
+// std
+#include <stdexcept>
+#include <cassert>
+
+namespace vk_engine{
+	ImageStateTracker::ImageStateTracker(LogicalDevice &device) : device{device}{
+		destroyCallback = device.addDestroyCallback([this](uint64_t handle){
+			std::lock_guard<std::mutex> lock(mutex);
+			images.erase(handle);
+		});
+	}
+
+	ImageStateTracker::~ImageStateTracker(){
+		device.removeDestroyCallback(destroyCallback);
+	}
+
+	void ImageStateTracker::add(VkImage image, VkImageAspectFlags aspect, uint32_t mipLevels, uint32_t layers, const State &state){
+		assert(image != VK_NULL_HANDLE && "cannot track a null image");
+		assert(mipLevels > 0 && layers > 0 && "an image has at least one subresource");
+
+		Subresource subresource;
+		subresource.layout = state.layout;
+		subresource.writeStages = state.stages == VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT ? 0 : state.stages;
+		subresource.writeAccess = state.access & WRITE_ACCESS;
+
+		TrackedImage tracked;
+		tracked.image = image;
+		tracked.aspect = aspect;
+		tracked.mipLevels = mipLevels;
+		tracked.layers = layers;
+		tracked.subresources.resize(mipLevels * layers, subresource);
+
+		std::lock_guard<std::mutex> lock(mutex);
+		images[LogicalDevice::getHandleKey(image)] = std::move(tracked);
+	}
+
+	void ImageStateTracker::remove(VkImage image){
+		std::lock_guard<std::mutex> lock(mutex);
+		images.erase(LogicalDevice::getHandleKey(image));
+	}
+
+	bool ImageStateTracker::contains(VkImage image) const{
+		std::lock_guard<std::mutex> lock(mutex);
+		return images.find(LogicalDevice::getHandleKey(image)) != images.end();
+	}
+
+	void ImageStateTracker::require(VkImage image, VkImageLayout layout, VkAccessFlags access, VkPipelineStageFlags stages, const VkImageSubresourceRange &range){
+		std::lock_guard<std::mutex> lock(mutex);
+
+		TrackedImage &tracked = getImage(image);
+		VkImageSubresourceRange resolved = resolveRange(tracked, range);
+
+		for (uint32_t mip=resolved.baseMipLevel; mip<resolved.baseMipLevel + resolved.levelCount; mip++){
+			Subresource *subresources = &tracked.subresources[mip * tracked.layers];
+			uint32_t end = resolved.baseArrayLayer + resolved.layerCount;
+
+			// the consecutive layers in the same state share a barrier
+			for (uint32_t first=resolved.baseArrayLayer; first<end;){
+				uint32_t last = first + 1;
+				while (last < end && sameState(subresources[first], subresources[last])) last++;
+
+				const Subresource &from = subresources[first];
+				VkPipelineStageFlags srcStages = 0;
+				VkAccessFlags srcAccess = 0;
+
+				if (needsBarrier(from, layout, access, stages, srcStages, srcAccess)){
+					int barrier = getPendingBarrier(from);
+
+					if (barrier == -1){
+						barrier = addBarrier(tracked, mip, first, last - first, from.layout, layout, access, stages, srcStages, srcAccess);
+					} else {
+						// required twice before the flush, the next commands need both states
+						assert(barriers[barrier].newLayout == layout && "a subresource cannot be required in two layouts before a flush");
+						barriers[barrier].dstAccessMask |= access;
+						barriers[barrier].dstStageMask |= stages;
+					}
+
+					for (uint32_t layer=first; layer<last; layer++){
+						subresources[layer].barrier = barrier;
+						subresources[layer].batch = batch;
+					}
+				}
+
+				for (uint32_t layer=first; layer<last; layer++)
+					apply(subresources[layer], layout, access, stages);
+
+				first = last;
+			}
+		}
+	}
+
+	void ImageStateTracker::require(VkImage image, VkImageLayout layout, const VkImageSubresourceRange &range){
+		State state = getLayoutState(layout);
+		require(image, layout, state.access, state.stages, range);
+	}
+
+	void ImageStateTracker::setState(VkImage image, const State &state, const VkImageSubresourceRange &range){
+		std::lock_guard<std::mutex> lock(mutex);
+
+		TrackedImage &tracked = getImage(image);
+		VkImageSubresourceRange resolved = resolveRange(tracked, range);
+
+		for (uint32_t mip=resolved.baseMipLevel; mip<resolved.baseMipLevel + resolved.levelCount; mip++){
+			for (uint32_t layer=resolved.baseArrayLayer; layer<resolved.baseArrayLayer + resolved.layerCount; layer++){
+				Subresource &subresource = tracked.subresources[mip * tracked.layers + layer];
+				subresource.layout = state.layout;
+				subresource.writeStages = state.stages;
+				subresource.writeAccess = state.access & WRITE_ACCESS;
+				subresource.readStages = 0;
+				subresource.readAccess = 0;
+			}
+		}
+	}
+
+	ImageStateTracker::State ImageStateTracker::getState(VkImage image, uint32_t mipLevel, uint32_t layer) const{
+		std::lock_guard<std::mutex> lock(mutex);
+
+		const TrackedImage &tracked = getImage(image);
+		assert(mipLevel < tracked.mipLevels && layer < tracked.layers && "the subresource is out of the image");
+
+		const Subresource &subresource = tracked.subresources[mipLevel * tracked.layers + layer];
+		return {subresource.layout, subresource.writeAccess | subresource.readAccess, subresource.writeStages | subresource.readStages};
+	}
+
+	bool ImageStateTracker::flush(VkCommandBuffer commandBuffer){
+		std::lock_guard<std::mutex> lock(mutex);
+		if (barriers.empty()) return false;
+
+		VkDependencyInfoKHR dependency{};
+		dependency.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO_KHR;
+		dependency.imageMemoryBarrierCount = static_cast<uint32_t>(barriers.size());
+		dependency.pImageMemoryBarriers = barriers.data();
+
+		if (synchronization2){
+			synchronization2->pipelineBarrier(commandBuffer, dependency);
+		} else {
+			Synchronization2::legacyPipelineBarrier(commandBuffer, dependency);
+		}
+
+		// invalidate the barrier indices of the subresources
+		barriers.clear();
+		batch++;
+		return true;
+	}
+
+	bool ImageStateTracker::hasPendingBarriers() const{
+		std::lock_guard<std::mutex> lock(mutex);
+		return !barriers.empty();
+	}
+
+	ImageStateTracker::State ImageStateTracker::getLayoutState(VkImageLayout layout) noexcept{
+		switch (layout){
+			case VK_IMAGE_LAYOUT_UNDEFINED:
+				return {layout, 0, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT};
+
+			case VK_IMAGE_LAYOUT_PREINITIALIZED:
+				return {layout, VK_ACCESS_HOST_WRITE_BIT, VK_PIPELINE_STAGE_HOST_BIT};
+
+			case VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL:
+				return {layout, VK_ACCESS_TRANSFER_READ_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT};
+
+			case VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL:
+				return {layout, VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT};
+
+			case VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL:
+				return {layout, VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT};
+
+			case VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL:
+				return {layout, VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
+
+			case VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL:
+				return {layout, VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT, VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT};
+
+			case VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL:
+				return {layout, VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT};
+
+			case VK_IMAGE_LAYOUT_PRESENT_SRC_KHR:
+				return {layout, 0, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT};
+
+			default:
+				return {layout, VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT};
+		}
+	}
+
+	ImageStateTracker::TrackedImage &ImageStateTracker::getImage(VkImage image){
+		auto it = images.find(LogicalDevice::getHandleKey(image));
+		if (it == images.end())
+			throw std::runtime_error("the image is not tracked");
+		return it->second;
+	}
+
+	const ImageStateTracker::TrackedImage &ImageStateTracker::getImage(VkImage image) const{
+		auto it = images.find(LogicalDevice::getHandleKey(image));
+		if (it == images.end())
+			throw std::runtime_error("the image is not tracked");
+		return it->second;
+	}
+
+	VkImageSubresourceRange ImageStateTracker::resolveRange(const TrackedImage &image, const VkImageSubresourceRange &range) const{
+		VkImageSubresourceRange resolved = range;
+		resolved.aspectMask = image.aspect;
+		if (range.levelCount == VK_REMAINING_MIP_LEVELS) resolved.levelCount = image.mipLevels - range.baseMipLevel;
+		if (range.layerCount == VK_REMAINING_ARRAY_LAYERS) resolved.layerCount = image.layers - range.baseArrayLayer;
+
+		assert(resolved.baseMipLevel + resolved.levelCount <= image.mipLevels && resolved.baseArrayLayer + resolved.layerCount <= image.layers && "the range is out of the image");
+		return resolved;
+	}
+
+	int ImageStateTracker::addBarrier(const TrackedImage &image, uint32_t mipLevel, uint32_t baseLayer, uint32_t layerCount, VkImageLayout oldLayout, VkImageLayout layout, VkAccessFlags access, VkPipelineStageFlags stages, VkPipelineStageFlags srcStages, VkAccessFlags srcAccess){
+		VkImageMemoryBarrier2KHR barrier{};
+		barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2_KHR;
+		barrier.srcStageMask = srcStages; // nothing to wait, VK_PIPELINE_STAGE_2_NONE_KHR (top of pipe without synchronization2)
+		barrier.srcAccessMask = srcAccess;
+		barrier.dstStageMask = stages;
+		barrier.dstAccessMask = access;
+		barrier.oldLayout = oldLayout;
+		barrier.newLayout = layout;
+		barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.image = image.image;
+		barrier.subresourceRange = {image.aspect, mipLevel, 1, baseLayer, layerCount};
+
+		barriers.push_back(barrier);
+		return static_cast<int>(barriers.size() - 1);
+	}
+
+	int ImageStateTracker::getPendingBarrier(const Subresource &subresource) const noexcept{
+		return subresource.batch == batch ? subresource.barrier : -1;
+	}
+
+	bool ImageStateTracker::sameState(const Subresource &a, const Subresource &b) const noexcept{
+		return a.layout == b.layout && a.writeStages == b.writeStages && a.writeAccess == b.writeAccess && a.readStages == b.readStages &&
+			a.readAccess == b.readAccess && getPendingBarrier(a) == getPendingBarrier(b);
+	}
+
+	bool ImageStateTracker::needsBarrier(const Subresource &subresource, VkImageLayout layout, VkAccessFlags access, VkPipelineStageFlags stages, VkPipelineStageFlags &srcStages, VkAccessFlags &srcAccess) noexcept{
+		bool transition = layout != subresource.layout;
+
+		// a write or a transition waits for all the previous accesses, the reads included
+		if (transition || (access & WRITE_ACCESS)){
+			srcStages = subresource.writeStages | subresource.readStages;
+			srcAccess = subresource.writeAccess;
+			return transition || srcStages != 0;
+		}
+
+		// a read only waits for the last write, once per stage. Without access (like the presentation) the layout is enough
+		if (subresource.writeStages == 0 || access == 0) return false;
+		if ((stages & ~subresource.readStages) == 0 && (access & ~subresource.readAccess) == 0) return false;
+
+		srcStages = subresource.writeStages;
+		srcAccess = subresource.writeAccess;
+		return true;
+	}
+
+	void ImageStateTracker::apply(Subresource &subresource, VkImageLayout layout, VkAccessFlags access, VkPipelineStageFlags stages) noexcept{
+		if (access & WRITE_ACCESS){
+			subresource.layout = layout;
+			subresource.writeStages = stages;
+			subresource.writeAccess = access & WRITE_ACCESS;
+			subresource.readStages = 0;
+			subresource.readAccess = 0;
+
+		} else if (layout != subresource.layout){
+			// the transition is the last write, the reads of other stages chain with the stages of this one
+			subresource.layout = layout;
+			subresource.writeStages = stages;
+			subresource.writeAccess = 0;
+			subresource.readStages = stages;
+			subresource.readAccess = access;
+
+		} else {
+			subresource.readStages |= stages;
+			subresource.readAccess |= access;
+		}
+	}
+
+	VkImageAspectFlags ImageStateTracker::getFormatAspect(VkFormat format) noexcept{
+		switch (format){
+			case VK_FORMAT_S8_UINT:
+				return VK_IMAGE_ASPECT_STENCIL_BIT;
+			case VK_FORMAT_D16_UNORM:
+			case VK_FORMAT_X8_D24_UNORM_PACK32:
+			case VK_FORMAT_D32_SFLOAT:
+				return VK_IMAGE_ASPECT_DEPTH_BIT;
+			case VK_FORMAT_D16_UNORM_S8_UINT:
+			case VK_FORMAT_D24_UNORM_S8_UINT:
+			case VK_FORMAT_D32_SFLOAT_S8_UINT:
+				return VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT;
+			default:
+				return VK_IMAGE_ASPECT_COLOR_BIT;
+		}
+	}
+}
\ No newline at end of file
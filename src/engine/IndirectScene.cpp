@@ -0,0 +1,199 @@
+#include "engine/IndirectScene.hpp"
+
+// std
+#include <stdexcept>
+#include <cstring>
+
+namespace vk_engine{
+	IndirectScene::IndirectScene(LogicalDevice &device, const MultiDrawIndirect &multiDrawIndirect, MeshBuffer &meshes) : device{device}, multiDrawIndirect{multiDrawIndirect}, meshes{meshes}{}
+
+	void IndirectScene::build(){
+		assert(capacity > 0 && "cannot build an indirect scene without capacity");
+		assert(framesInFlight > 0 && "cannot build an indirect scene without frames");
+
+		frames.clear();
+		frames.resize(framesInFlight);
+
+		for (auto &frame : frames){
+			frame.objects = std::make_unique<Buffer>(device, sizeof(glm::mat4), capacity, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+			frame.bounds = std::make_unique<Buffer>(device, sizeof(glm::vec4), capacity, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+			frame.commands = std::make_unique<Buffer>(device, sizeof(VkDrawIndexedIndirectCommand), capacity, VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+
+			if (frame.objects->map() != VK_SUCCESS || frame.bounds->map() != VK_SUCCESS || frame.commands->map() != VK_SUCCESS)
+				throw std::runtime_error("failed to map the buffers of the indirect scene");
+
+			// the objects added before the build are written on the first use of the frame
+			frame.changed.resize(capacity, false);
+			for (uint32_t i=0; i<static_cast<uint32_t>(objects.size()); i++){
+				if (objects[i].batch == NO_BATCH) continue;
+
+				frame.changedObjects.push_back(i);
+				frame.changed[i] = true;
+			}
+		}
+	}
+
+	uint32_t IndirectScene::addBatch(Pipeline &pipeline, VkDescriptorSet descriptorSet){
+		Batch batch;
+		batch.pipeline = &pipeline;
+		batch.descriptorSet = descriptorSet;
+
+		batches.push_back(std::move(batch));
+		return static_cast<uint32_t>(batches.size() - 1);
+	}
+
+	uint32_t IndirectScene::add(uint32_t batch, const MeshBuffer::Mesh &mesh, const glm::mat4 &transform, const glm::vec4 &bounds){
+		assert(batch < batches.size() && "invalid batch index");
+
+		uint32_t object;
+		if (!freeObjects.empty()){
+			object = freeObjects.back();
+			freeObjects.pop_back();
+		} else {
+			if (objects.size() >= capacity)
+				throw std::runtime_error("failed to add the object, the indirect scene is full");
+
+			object = static_cast<uint32_t>(objects.size());
+			objects.emplace_back();
+			transforms.emplace_back();
+			this->bounds.emplace_back();
+		}
+
+		Object &added = objects[object];
+		added.batch = batch;
+		added.batchIndex = static_cast<uint32_t>(batches[batch].objects.size());
+		added.mesh = mesh;
+		batches[batch].objects.push_back(object);
+		this->bounds[object] = bounds;
+
+		objectCount++;
+		changedCommands = true;
+		setTransform(object, transform);
+		return object;
+	}
+
+	void IndirectScene::remove(uint32_t object){
+		assert(object < objects.size() && objects[object].batch != NO_BATCH && "invalid object id");
+		Object &removed = objects[object];
+		Batch &batch = batches[removed.batch];
+
+		// move the last object of the batch in place of the removed one
+		uint32_t last = batch.objects.back();
+		batch.objects[removed.batchIndex] = last;
+		objects[last].batchIndex = removed.batchIndex;
+		batch.objects.pop_back();
+
+		removed.batch = NO_BATCH;
+		freeObjects.push_back(object);
+		objectCount--;
+		changedCommands = true;
+	}
+
+	void IndirectScene::setTransform(uint32_t object, const glm::mat4 &transform){
+		assert(object < objects.size() && objects[object].batch != NO_BATCH && "invalid object id");
+		transforms[object] = transform;
+
+		// an object moved several times before the use of a frame is written once
+		for (auto &frame : frames){
+			if (frame.changed[object]) continue;
+
+			frame.changedObjects.push_back(object);
+			frame.changed[object] = true;
+		}
+	}
+
+	void IndirectScene::beginFrame(uint32_t frameIndex){
+		assert(frameIndex < frames.size() && "invalid frame index");
+		currentFrame = frameIndex;
+
+		if (changedCommands){
+			writeCommands();
+
+			for (auto &frame : frames)
+				frame.changedCommands = true;
+
+			changedCommands = false;
+		}
+
+		Frame &frame = frames[frameIndex];
+		glm::mat4 *mappedObjects = static_cast<glm::mat4*>(frame.objects->getMappedMemory());
+		glm::vec4 *mappedBounds = static_cast<glm::vec4*>(frame.bounds->getMappedMemory());
+
+		for (uint32_t object : frame.changedObjects){
+			std::memcpy(&mappedObjects[object], &transforms[object], sizeof(glm::mat4));
+			std::memcpy(&mappedBounds[object], &bounds[object], sizeof(glm::vec4));
+			frame.changed[object] = false;
+		}
+
+		frame.changedObjects.clear();
+
+		if (frame.changedCommands){
+			std::memcpy(frame.commands->getMappedMemory(), commands.data(), commands.size() * sizeof(VkDrawIndexedIndirectCommand));
+			frame.changedCommands = false;
+		}
+	}
+
+	void IndirectScene::writeCommands(){
+		commands.clear();
+
+		for (auto &batch : batches){
+			batch.firstCommand = static_cast<uint32_t>(commands.size());
+
+			for (uint32_t object : batch.objects){
+				const MeshBuffer::Mesh &mesh = objects[object].mesh;
+
+				// the first instance is the index of the transform of the object
+				VkDrawIndexedIndirectCommand command;
+				command.indexCount = mesh.indexCount;
+				command.instanceCount = 1;
+				command.firstIndex = mesh.firstIndex;
+				command.vertexOffset = mesh.vertexOffset;
+				command.firstInstance = object;
+				commands.push_back(command);
+			}
+
+			batch.commandCount = static_cast<uint32_t>(batch.objects.size());
+		}
+	}
+
+	void IndirectScene::record(VkCommandBuffer commandBuffer){
+		assert(!frames.empty() && "cannot record an indirect scene before the build");
+		record(commandBuffer, frames[currentFrame].commands->getBuffer(), VK_NULL_HANDLE);
+	}
+
+	void IndirectScene::record(VkCommandBuffer commandBuffer, VkBuffer commandsBuffer, VkBuffer counts){
+		assert(!frames.empty() && "cannot record an indirect scene before the build");
+		assert((counts == VK_NULL_HANDLE || multiDrawIndirect.isCountSupported()) && "cannot read the counts of the batches without VK_KHR_draw_indirect_count");
+		assert((multiDrawIndirect.isFirstInstanceSupported() || commandsBuffer == frames[currentFrame].commands->getBuffer()) && "cannot record the commands of another buffer without drawIndirectFirstInstance");
+
+		meshes.bind(commandBuffer);
+
+		for (uint32_t i=0; i<static_cast<uint32_t>(batches.size()); i++){
+			const Batch &batch = batches[i];
+			if (batch.commandCount == 0) continue;
+			batch.pipeline->bind(commandBuffer);
+
+			if (batch.descriptorSet != VK_NULL_HANDLE)
+				vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, batch.pipeline->getPipelineLayout(), materialSet, 1, &batch.descriptorSet, 0, nullptr);
+
+			uint32_t drawCount = batch.commandCount;
+			VkDeviceSize offset = static_cast<VkDeviceSize>(batch.firstCommand) * sizeof(VkDrawIndexedIndirectCommand);
+
+			if (counts != VK_NULL_HANDLE){
+				multiDrawIndirect.drawIndexedIndirectCount(commandBuffer, commandsBuffer, offset, counts, i * sizeof(uint32_t), drawCount);
+				continue;
+			}
+
+			if (multiDrawIndirect.isFirstInstanceSupported()){
+				multiDrawIndirect.drawIndexedIndirect(commandBuffer, commandsBuffer, offset, drawCount);
+				continue;
+			}
+
+			// the indirect commands cannot have a first instance, the transforms are indexed with direct draws
+			for (uint32_t command=batch.firstCommand; command<batch.firstCommand + drawCount; command++){
+				const VkDrawIndexedIndirectCommand &drawCommand = commands[command];
+				vkCmdDrawIndexed(commandBuffer, drawCommand.indexCount, drawCommand.instanceCount, drawCommand.firstIndex, drawCommand.vertexOffset, drawCommand.firstInstance);
+			}
+		}
+	}
+}
\ No newline at end of file
@@ -51,6 +51,12 @@ namespace vk_engine{
 
 		createInfo.pEnabledFeatures = &features;
 
+		// chain the extensions features structures
+		for (size_t i=0; i<featuresChain.size(); i++)
+			featuresChain[i]->pNext = i + 1 < featuresChain.size() ? featuresChain[i + 1].get() : nullptr;
+		
+		createInfo.pNext = featuresChain.empty() ? nullptr : featuresChain.front().get();
+
 		createInfo.enabledExtensionCount = static_cast<uint32_t>(requiredExtensions.size());
 		createInfo.ppEnabledExtensionNames = requiredExtensions.data();
 
@@ -76,6 +82,16 @@ namespace vk_engine{
 		}
 	}
 
+	bool LogicalDevice::requireOptionalExtension(const char *extension){
+		if (!physicalDevice.isExtensionSupported(extension)) return false;
+		if (!isExtensionEnabled(extension)) requireExtension(extension);
+		return true;
+	}
+
+	bool LogicalDevice::isExtensionEnabled(const std::string &extension) const noexcept{
+		return std::find(requiredExtensions.begin(), requiredExtensions.end(), extension) != requiredExtensions.end();
+	}
+
 	void LogicalDevice::createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer &buffer,VkDeviceMemory &bufferMemory){
 
 		VkBufferCreateInfo bufferInfo{};
@@ -124,4 +140,24 @@ namespace vk_engine{
 			throw std::runtime_error("failed to bind image memory!");
 		}
 	}
+
+	uint32_t LogicalDevice::addDestroyCallback(std::function<void(uint64_t)> callback){
+		std::lock_guard<std::mutex> lock(destroyCallbacksMutex);
+
+		uint32_t id = nextCallbackId++;
+		destroyCallbacks[id] = std::move(callback);
+		return id;
+	}
+
+	void LogicalDevice::removeDestroyCallback(uint32_t id){
+		std::lock_guard<std::mutex> lock(destroyCallbacksMutex);
+		destroyCallbacks.erase(id);
+	}
+
+	void LogicalDevice::callDestroyCallbacks(uint64_t handle){
+		std::lock_guard<std::mutex> lock(destroyCallbacksMutex);
+
+		for (auto &callback : destroyCallbacks)
+			callback.second(handle);
+	}
 }
\ No newline at end of file
@@ -0,0 +1,138 @@
+#include "engine/MappedFile.hpp"
+
+// std
+#include <stdexcept>
+#include <utility>
+
+#ifdef _WIN32
+	#ifndef WIN32_LEAN_AND_MEAN
+		#define WIN32_LEAN_AND_MEAN
+	#endif
+	#ifndef NOMINMAX
+		#define NOMINMAX
+	#endif
+	#include <windows.h>
+#else
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+#endif
+
+namespace vk_engine{
+	MappedFile::MappedFile(const std::string &filepath){
+		open(filepath);
+	}
+
+	MappedFile::~MappedFile(){
+		close();
+	}
+
+	MappedFile::MappedFile(MappedFile &&other) noexcept{
+		*this = std::move(other);
+	}
+
+	MappedFile &MappedFile::operator=(MappedFile &&other) noexcept{
+		if (this == &other) return *this;
+		close();
+
+		mapped = std::exchange(other.mapped, nullptr);
+		fileSize = std::exchange(other.fileSize, 0);
+		opened = std::exchange(other.opened, false);
+		filepath = std::move(other.filepath);
+		fileHandle = std::exchange(other.fileHandle, nullptr);
+		mappingHandle = std::exchange(other.mappingHandle, nullptr);
+
+		return *this;
+	}
+
+	#ifdef _WIN32
+		void MappedFile::open(const std::string &filepath){
+			close();
+
+			HANDLE file = CreateFileA(filepath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+			if (file == INVALID_HANDLE_VALUE)
+				throw std::runtime_error("failed to open : " + filepath);
+
+			LARGE_INTEGER size;
+			if (!GetFileSizeEx(file, &size)){
+				CloseHandle(file);
+				throw std::runtime_error("failed to get the size of : " + filepath);
+			}
+
+			this->filepath = filepath;
+			fileHandle = file;
+			fileSize = static_cast<size_t>(size.QuadPart);
+			opened = true;
+
+			// an empty file cannot be mapped
+			if (fileSize == 0) return;
+
+			HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+			if (!mapping){
+				close();
+				throw std::runtime_error("failed to map : " + filepath);
+			}
+			mappingHandle = mapping;
+
+			mapped = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+			if (!mapped){
+				close();
+				throw std::runtime_error("failed to map : " + filepath);
+			}
+		}
+
+		void MappedFile::close() noexcept{
+			if (mapped) UnmapViewOfFile(mapped);
+			if (mappingHandle) CloseHandle(static_cast<HANDLE>(mappingHandle));
+			if (fileHandle) CloseHandle(static_cast<HANDLE>(fileHandle));
+
+			mapped = nullptr;
+			mappingHandle = nullptr;
+			fileHandle = nullptr;
+			fileSize = 0;
+			opened = false;
+		}
+	#else
+		void MappedFile::open(const std::string &filepath){
+			close();
+
+			int file = ::open(filepath.c_str(), O_RDONLY);
+			if (file < 0)
+				throw std::runtime_error("failed to open : " + filepath);
+
+			struct stat status;
+			if (fstat(file, &status) != 0){
+				::close(file);
+				throw std::runtime_error("failed to get the size of : " + filepath);
+			}
+
+			this->filepath = filepath;
+			fileSize = static_cast<size_t>(status.st_size);
+			opened = true;
+
+			// an empty file cannot be mapped
+			if (fileSize > 0){
+				void *data = mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, file, 0);
+
+				if (data == MAP_FAILED){
+					::close(file);
+					close();
+					throw std::runtime_error("failed to map : " + filepath);
+				}
+				mapped = data;
+			}
+
+			// the mapping keeps a reference to the file
+			::close(file);
+		}
+
+		void MappedFile::close() noexcept{
+			if (mapped) munmap(mapped, fileSize);
+
+			mapped = nullptr;
+			fileSize = 0;
+			opened = false;
+		}
+	#endif
+}
\ No newline at end of file
@@ -0,0 +1,78 @@
+#include "engine/MeshBuffer.hpp"
+#include "engine/SingleTimeCommands.hpp"
+
+// std
+#include <stdexcept>
+#include <cassert>
+#include <cstring>
+
+namespace vk_engine{
+	MeshBuffer::MeshBuffer(LogicalDevice &device, CommandPool &commandPool) : device{device}, commandPool{commandPool}{}
+
+	void MeshBuffer::build(){
+		assert(vertexSize > 0 && "cannot build a mesh buffer without vertex size");
+		assert(vertexCapacity > 0 && indexCapacity > 0 && "cannot build an empty mesh buffer");
+
+		vertexBuffer = std::make_unique<Buffer>(device, vertexSize, vertexCapacity, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+		indexBuffer = std::make_unique<Buffer>(device, sizeof(uint32_t), indexCapacity, VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+		vertexCount = 0;
+		indexCount = 0;
+	}
+
+	MeshBuffer::Mesh MeshBuffer::add(const void *vertices, uint32_t vertexCount, const uint32_t *indices, uint32_t indexCount){
+		assert(vertexBuffer && "cannot add a mesh before the build");
+		assert(vertexCount > 0 && indexCount > 0 && "cannot add an empty mesh");
+
+		if (this->vertexCount + vertexCount > vertexCapacity || this->indexCount + indexCount > indexCapacity)
+			throw std::runtime_error("failed to add the mesh, the mesh buffer is full");
+
+		VkDeviceSize verticesSize = static_cast<VkDeviceSize>(vertexCount) * vertexSize;
+		VkDeviceSize indicesSize = static_cast<VkDeviceSize>(indexCount) * sizeof(uint32_t);
+
+		// the vertices then the indices in a single staging buffer
+		Buffer stagingBuffer(device, verticesSize + indicesSize, 1, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+
+		if (stagingBuffer.map() != VK_SUCCESS)
+			throw std::runtime_error("failed to map the staging buffer of the mesh");
+
+		char *mapped = static_cast<char*>(stagingBuffer.getMappedMemory());
+		std::memcpy(mapped, vertices, verticesSize);
+		std::memcpy(mapped + verticesSize, indices, indicesSize);
+		stagingBuffer.unmap();
+
+		{
+			SingleTimeCommands commandBuffer(commandPool, device, device.getQueues()[0][FAMILY_GRAPHIC]);
+
+			VkBufferCopy vertexRegion{};
+			vertexRegion.srcOffset = 0;
+			vertexRegion.dstOffset = static_cast<VkDeviceSize>(this->vertexCount) * vertexSize;
+			vertexRegion.size = verticesSize;
+			vkCmdCopyBuffer(commandBuffer, stagingBuffer, *vertexBuffer, 1, &vertexRegion);
+
+			VkBufferCopy indexRegion{};
+			indexRegion.srcOffset = verticesSize;
+			indexRegion.dstOffset = static_cast<VkDeviceSize>(this->indexCount) * sizeof(uint32_t);
+			indexRegion.size = indicesSize;
+			vkCmdCopyBuffer(commandBuffer, stagingBuffer, *indexBuffer, 1, &indexRegion);
+		}
+
+		Mesh mesh;
+		mesh.firstIndex = this->indexCount;
+		mesh.indexCount = indexCount;
+		mesh.vertexOffset = static_cast<int32_t>(this->vertexCount);
+		mesh.vertexCount = vertexCount;
+
+		this->vertexCount += vertexCount;
+		this->indexCount += indexCount;
+		return mesh;
+	}
+
+	void MeshBuffer::bind(VkCommandBuffer commandBuffer) const noexcept{
+		VkBuffer buffer = vertexBuffer->getBuffer();
+		VkDeviceSize offset = 0;
+
+		vkCmdBindVertexBuffers(commandBuffer, 0, 1, &buffer, &offset);
+		vkCmdBindIndexBuffer(commandBuffer, indexBuffer->getBuffer(), 0, VK_INDEX_TYPE_UINT32);
+	}
+}
\ No newline at end of file
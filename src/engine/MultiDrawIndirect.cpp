@@ -0,0 +1,54 @@
+#include "engine/MultiDrawIndirect.hpp"
+
+// std
+#include <cassert>
+#include <algorithm>
+
+namespace vk_engine{
+	MultiDrawIndirect::MultiDrawIndirect(LogicalDevice &device) : device{device}{}
+
+	void MultiDrawIndirect::require(){
+		PhysicalDevice &physicalDevice = device.getPhysicalDevice();
+
+		// the core features are enabled from the required features of the physical device
+		if (physicalDevice.isFeatureSupported(PhysicalDevice::FEATURE_MULTI_DRAW_INDIRECT))
+			physicalDevice.requireFeature(PhysicalDevice::FEATURE_MULTI_DRAW_INDIRECT);
+
+		if (physicalDevice.isFeatureSupported(PhysicalDevice::FEATURE_DRAW_INDIRECT_FISRT_INSTANCE))
+			physicalDevice.requireFeature(PhysicalDevice::FEATURE_DRAW_INDIRECT_FISRT_INSTANCE);
+
+		if (physicalDevice.isExtensionSupported(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME))
+			device.requireOptionalExtension(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME);
+	}
+
+	void MultiDrawIndirect::build(){
+		PhysicalDevice &physicalDevice = device.getPhysicalDevice();
+		auto requiredFeatures = physicalDevice.getRequiredFeatures();
+
+		multiDraw = requiredFeatures[PhysicalDevice::FEATURE_MULTI_DRAW_INDIRECT];
+		firstInstance = requiredFeatures[PhysicalDevice::FEATURE_DRAW_INDIRECT_FISRT_INSTANCE];
+		maxDrawCount = multiDraw ? std::max(physicalDevice.getProperties().limits.maxDrawIndirectCount, 1U) : 1;
+
+		count = false;
+		if (multiDraw && device.isExtensionEnabled(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME)){
+			cmdDrawIndexedIndirectCount = device.getProcAddr<PFN_vkCmdDrawIndexedIndirectCountKHR>("vkCmdDrawIndexedIndirectCountKHR");
+			count = cmdDrawIndexedIndirectCount != nullptr;
+		}
+	}
+
+	void MultiDrawIndirect::drawIndexedIndirect(VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize offset, uint32_t drawCount, uint32_t stride) const noexcept{
+		// without multiDrawIndirect the draw count must be 0 or 1
+		while (drawCount > 0){
+			uint32_t commandCount = std::min(drawCount, maxDrawCount);
+			vkCmdDrawIndexedIndirect(commandBuffer, buffer, offset, commandCount, stride);
+
+			offset += static_cast<VkDeviceSize>(commandCount) * stride;
+			drawCount -= commandCount;
+		}
+	}
+
+	void MultiDrawIndirect::drawIndexedIndirectCount(VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize offset, VkBuffer countBuffer, VkDeviceSize countOffset, uint32_t maxDrawCount, uint32_t stride) const noexcept{
+		assert(count && "cannot read the draw count from a buffer without VK_KHR_draw_indirect_count");
+		cmdDrawIndexedIndirectCount(commandBuffer, buffer, offset, countBuffer, countOffset, std::min(maxDrawCount, this->maxDrawCount), stride);
+	}
+}
\ No newline at end of file
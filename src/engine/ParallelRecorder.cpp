@@ -0,0 +1,78 @@
+#include "engine/ParallelRecorder.hpp"
+
+// std
+#include <stdexcept>
+#include <cassert>
+#include <future>
+
+namespace vk_engine{
+	ParallelRecorder::ParallelRecorder(LogicalDevice &device, ThreadPool &threadPool) : device{device}, threadPool{threadPool}{}
+
+	void ParallelRecorder::build(){
+		assert(framesInFlight > 0 && "cannot build a parallel recorder without frames");
+
+		frames.resize(framesInFlight);
+		for (auto &frame : frames){
+			frame.resize(threadPool.getThreadCount());
+
+			for (auto &workerPool : frame){
+				workerPool = std::make_unique<FrameCommandPool>(device);
+				workerPool->setFamily(family);
+				workerPool->build();
+			}
+		}
+	}
+
+	void ParallelRecorder::beginFrame(uint32_t frameIndex){
+		assert(frameIndex < frames.size() && "invalid frame index");
+
+		for (auto &workerPool : frames[frameIndex])
+			workerPool->reset();
+
+		currentFrame = frameIndex;
+	}
+
+	void ParallelRecorder::record(VkCommandBuffer commandBuffer, const VkCommandBufferInheritanceInfo &inheritanceInfo, uint32_t taskCount, const Task &task){
+		assert(!frames.empty() && "cannot record with a parallel recorder before the build");
+		assert(ThreadPool::getWorkerIndex() == ThreadPool::NO_WORKER && "cannot record in parallel from a worker thread");
+
+		std::vector<VkCommandBuffer> secondaryCommandBuffers(taskCount);
+		std::vector<std::future<void>> tasks;
+		tasks.reserve(taskCount);
+
+		for (uint32_t i=0; i<taskCount; i++){
+			tasks.push_back(threadPool.submit([this, &inheritanceInfo, &task, &secondaryCommandBuffers, i](){
+				// only used by this worker during the frame
+				FrameCommandPool &workerPool = *frames[currentFrame][ThreadPool::getWorkerIndex()];
+				VkCommandBuffer secondaryCommandBuffer = workerPool.get(VK_COMMAND_BUFFER_LEVEL_SECONDARY);
+
+				VkCommandBufferBeginInfo beginInfo{};
+				beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+				beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+				beginInfo.pInheritanceInfo = &inheritanceInfo;
+
+				if (inheritanceInfo.renderPass != VK_NULL_HANDLE)
+					beginInfo.flags |= VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+
+				if (vkBeginCommandBuffer(secondaryCommandBuffer, &beginInfo) != VK_SUCCESS)
+					throw std::runtime_error("failed to begin recording secondary command buffer");
+
+				task(secondaryCommandBuffer, i);
+
+				if (vkEndCommandBuffer(secondaryCommandBuffer) != VK_SUCCESS)
+					throw std::runtime_error("failed to record secondary command buffer");
+
+				secondaryCommandBuffers[i] = secondaryCommandBuffer;
+			}));
+		}
+
+		// all the tasks reference the locals, wait for them before rethrowing
+		for (auto &recording : tasks)
+			recording.wait();
+
+		for (auto &recording : tasks)
+			recording.get();
+
+		if (taskCount > 0) vkCmdExecuteCommands(commandBuffer, taskCount, secondaryCommandBuffers.data());
+	}
+}
\ No newline at end of file
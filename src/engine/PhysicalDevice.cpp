@@ -31,6 +31,15 @@ namespace vk_engine{
 			throw std::runtime_error("failed to found a suitable GPU");
 
 		vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+
+		uint32_t extensionCount;
+		vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extensionCount, nullptr);
+
+		std::vector<VkExtensionProperties> extensions(extensionCount);
+		vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extensionCount, extensions.data());
+
+		for (const auto &extension : extensions)
+			supportedExtensions.insert(extension.extensionName);
 	}
 
 	bool PhysicalDevice::isSuitableDevice(VkPhysicalDevice device){
@@ -178,6 +187,13 @@ namespace vk_engine{
 		return features;
 	}
 
+	bool PhysicalDevice::isFeatureSupported(Feature feature) const noexcept{
+		VkPhysicalDeviceFeatures supportedFeatures;
+		vkGetPhysicalDeviceFeatures(physicalDevice, &supportedFeatures);
+
+		return reinterpret_cast<VkBool32*>(&supportedFeatures)[feature] == VK_TRUE;
+	}
+
 	PhysicalDevice::FamilyDetails PhysicalDevice::getFamily(Family family) const{
 		for (auto &f : families){
 			if (f.type == family) return f;
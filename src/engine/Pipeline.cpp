@@ -1,18 +1,46 @@
 #include "engine/Pipeline.hpp"
+#include "engine/Hash.hpp"
 
 // std
 #include <stdexcept>
-#include <fstream>
 #include <iostream>
+#include <algorithm>
 
 namespace vk_engine{
-	Pipeline::Pipeline(LogicalDevice &device, SwapChain &swapChain) : device{device}{
+	// the primitive topologies a dynamic topology can switch between without a new pipeline
+	static uint32_t getTopologyClass(VkPrimitiveTopology topology){
+		switch (topology){
+			case VK_PRIMITIVE_TOPOLOGY_POINT_LIST: return 0;
+			case VK_PRIMITIVE_TOPOLOGY_LINE_LIST:
+			case VK_PRIMITIVE_TOPOLOGY_LINE_STRIP:
+			case VK_PRIMITIVE_TOPOLOGY_LINE_LIST_WITH_ADJACENCY:
+			case VK_PRIMITIVE_TOPOLOGY_LINE_STRIP_WITH_ADJACENCY: return 1;
+			case VK_PRIMITIVE_TOPOLOGY_PATCH_LIST: return 3;
+			default: return 2;
+		}
+	}
+
+	Pipeline::Pipeline(LogicalDevice &device) : device{device}{
 		config = std::make_unique<ConfigInfo>();
 	}
 
+	Pipeline::Pipeline(LogicalDevice &device, SwapChain &swapChain) : Pipeline(device){}
+
 	Pipeline::~Pipeline(){
-		vkDestroyShaderModule(device, fragShaderModule, nullptr);
-		vkDestroyShaderModule(device, vertShaderModule, nullptr);
+		// the optimized link still reference the pipeline, a failed link only lose the optimization
+		if (optimizing.valid()){
+			try {
+				optimizing.get();
+			} catch (const std::exception &e){
+				std::cerr << "failed to link the optimized pipeline : " << e.what() << std::endl;
+			}
+		}
+
+		vkDestroyPipeline(device, fastLinkedPipeline, nullptr);
+		destroyShaderModules();
+		for (auto &permutation : permutations)
+			vkDestroyPipeline(device, permutation.second, nullptr);
+
 		vkDestroyPipeline(device, pipeline, nullptr);
 	}
 
@@ -21,43 +49,256 @@ namespace vk_engine{
 		assert((config->renderPass != VK_NULL_HANDLE || config->subpass != 0 || config->pipelineLayout != VK_NULL_HANDLE) && "cannot create a pipeline without a valid renderPass, subpass or pipelineLayout");
 
 		createGraphicPipeline();
+	}
 
+	void Pipeline::onBuilded(VkPipeline pipeline){
+		this->pipeline = pipeline;
+		hash = computeHash();
 		builded = true;
+
+		defaultState = getDrawState();
+		defaultKey = getPermutationKey(defaultState);
+
+		if (manifest) manifest->record(*this);
+
+		// the config and the modules are used to create the permutations
+		if (dynamicState) return;
+
+		// the shader modules are not needed once the pipeline is created, unless they are owned by the cache
+		if (!moduleCache){
+			vkDestroyShaderModule(device, fragShaderModule, nullptr);
+			vkDestroyShaderModule(device, vertShaderModule, nullptr);
+		}
+		fragShaderModule = VK_NULL_HANDLE;
+		vertShaderModule = VK_NULL_HANDLE;
+
 		config = nullptr;
 	}
 
+	void Pipeline::bind(VkCommandBuffer commandBuffer){
+		if (dynamicState){
+			bind(commandBuffer, defaultState);
+			return;
+		}
+		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+	}
+
+	void Pipeline::bind(VkCommandBuffer commandBuffer, const DrawState &state){
+		assert(builded && "cannot bind a pipeline before the build");
+		assert(dynamicState && "the draw states require an ExtendedDynamicState");
+
+		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, getPermutation(state));
+
+		if (dynamicState->isSupported()){
+			dynamicState->setCullMode(commandBuffer, state.cullMode);
+			dynamicState->setFrontFace(commandBuffer, state.frontFace);
+			dynamicState->setPrimitiveTopology(commandBuffer, state.topology);
+			dynamicState->setDepthTestEnable(commandBuffer, state.depthTestEnable);
+			dynamicState->setDepthWriteEnable(commandBuffer, state.depthWriteEnable);
+			dynamicState->setDepthCompareOp(commandBuffer, state.depthCompareOp);
+		}
+
+		if (dynamicState->isSupported2()){
+			dynamicState->setDepthBiasEnable(commandBuffer, state.depthBiasEnable);
+			dynamicState->setPrimitiveRestartEnable(commandBuffer, state.primitiveRestartEnable);
+			dynamicState->setRasterizerDiscardEnable(commandBuffer, state.rasterizerDiscardEnable);
+		}
+	}
+
+	VkPipeline Pipeline::getPermutation(const DrawState &state){
+		uint64_t key = getPermutationKey(state);
+		if (key == defaultKey) return pipeline;
+
+		std::lock_guard<std::mutex> lock(permutationsMutex);
+
+		auto it = permutations.find(key);
+		if (it != permutations.end()) return it->second;
+
+		// the config is shared by the permutations, restored once the permutation is created
+		applyDrawState(state);
+
+		CreateInfo createInfo;
+		prepareCreateInfo(createInfo);
+
+		VkPipelineCache pipelineCache = cache ? cache->get() : VK_NULL_HANDLE;
+		VkPipeline permutation;
+
+		VkResult result = vkCreateGraphicsPipelines(device, pipelineCache, 1, &createInfo.pipelineInfo, nullptr, &permutation);
+
+		if (result == VK_SUCCESS && manifest) manifest->record(*this);
+
+		applyDrawState(defaultState);
+
+		if (result != VK_SUCCESS)
+			throw std::runtime_error("failed to create graphics pipeline permutation!");
+
+		permutations[key] = permutation;
+		return permutation;
+	}
+
+	uint64_t Pipeline::getPermutationKey(const DrawState &state) const noexcept{
+		uint64_t seed = HASH_SEED;
+
+		if (!isDynamic(VK_DYNAMIC_STATE_CULL_MODE_EXT)) hashCombine(seed, state.cullMode);
+		if (!isDynamic(VK_DYNAMIC_STATE_FRONT_FACE_EXT)) hashCombine(seed, state.frontFace);
+		if (!isDynamic(VK_DYNAMIC_STATE_DEPTH_TEST_ENABLE_EXT)) hashCombine(seed, state.depthTestEnable);
+		if (!isDynamic(VK_DYNAMIC_STATE_DEPTH_WRITE_ENABLE_EXT)) hashCombine(seed, state.depthWriteEnable);
+		if (!isDynamic(VK_DYNAMIC_STATE_DEPTH_COMPARE_OP_EXT)) hashCombine(seed, state.depthCompareOp);
+		if (!isDynamic(VK_DYNAMIC_STATE_DEPTH_BIAS_ENABLE_EXT)) hashCombine(seed, state.depthBiasEnable);
+		if (!isDynamic(VK_DYNAMIC_STATE_PRIMITIVE_RESTART_ENABLE_EXT)) hashCombine(seed, state.primitiveRestartEnable);
+		if (!isDynamic(VK_DYNAMIC_STATE_RASTERIZER_DISCARD_ENABLE_EXT)) hashCombine(seed, state.rasterizerDiscardEnable);
+
+		// a dynamic topology must stay in the topology class of the pipeline
+		hashCombine(seed, isDynamic(VK_DYNAMIC_STATE_PRIMITIVE_TOPOLOGY_EXT) ? getTopologyClass(state.topology) : static_cast<uint32_t>(state.topology));
+
+		return seed;
+	}
+
+	void Pipeline::applyDrawState(const DrawState &state){
+		config->rasterizationInfo.cullMode = state.cullMode;
+		config->rasterizationInfo.frontFace = state.frontFace;
+		config->rasterizationInfo.depthBiasEnable = state.depthBiasEnable ? VK_TRUE : VK_FALSE;
+		config->rasterizationInfo.rasterizerDiscardEnable = state.rasterizerDiscardEnable ? VK_TRUE : VK_FALSE;
+		config->inputAssemblyInfo.topology = state.topology;
+		config->inputAssemblyInfo.primitiveRestartEnable = state.primitiveRestartEnable ? VK_TRUE : VK_FALSE;
+		config->depthStencilInfo.depthTestEnable = state.depthTestEnable ? VK_TRUE : VK_FALSE;
+		config->depthStencilInfo.depthWriteEnable = state.depthWriteEnable ? VK_TRUE : VK_FALSE;
+		config->depthStencilInfo.depthCompareOp = state.depthCompareOp;
+	}
+
+	Pipeline::DrawState Pipeline::getDrawState() const noexcept{
+		DrawState state;
+		state.cullMode = config->rasterizationInfo.cullMode;
+		state.frontFace = config->rasterizationInfo.frontFace;
+		state.depthBiasEnable = config->rasterizationInfo.depthBiasEnable;
+		state.rasterizerDiscardEnable = config->rasterizationInfo.rasterizerDiscardEnable;
+		state.topology = config->inputAssemblyInfo.topology;
+		state.primitiveRestartEnable = config->inputAssemblyInfo.primitiveRestartEnable;
+		state.depthTestEnable = config->depthStencilInfo.depthTestEnable;
+		state.depthWriteEnable = config->depthStencilInfo.depthWriteEnable;
+		state.depthCompareOp = config->depthStencilInfo.depthCompareOp;
+		return state;
+	}
+
+	bool Pipeline::isDynamic(VkDynamicState state) const noexcept{
+		if (dynamicState && dynamicState->isDynamic(state)) return true;
+		return config && std::find(config->dynamicStateEnables.begin(), config->dynamicStateEnables.end(), state) != config->dynamicStateEnables.end();
+	}
+
 	
-	std::vector<char> Pipeline::readFile(const std::string &filepath){
-		std::ifstream file(filepath, std::ios::ate | std::ios::binary);
+	void Pipeline::createGraphicPipeline(){
+		CreateInfo createInfo;
+		prepareCreateInfo(createInfo);
+
+		if (library && library->isSupported()){
+			createLinkedPipeline(createInfo);
+			return;
+		}
 
-		if (!file.is_open())
-			throw std::runtime_error("failed to open : " + filepath);
+		VkPipelineCache pipelineCache = cache ? cache->get() : VK_NULL_HANDLE;
+		VkPipeline pipeline;
+
+		if (vkCreateGraphicsPipelines(device, pipelineCache, 1, &createInfo.pipelineInfo, nullptr, &pipeline) != VK_SUCCESS)
+			throw std::runtime_error("failed to create graphics pipeline!");
 		
-		size_t fileSize = file.tellg();
-		std::vector<char> buffer(fileSize);
+		onBuilded(pipeline);
+	}
 
-		file.seekg(0);
-		file.read(buffer.data(), fileSize);
-		file.close();
+	void Pipeline::createLinkedPipeline(CreateInfo &createInfo){
+		const VkGraphicsPipelineCreateInfo &pipelineInfo = createInfo.pipelineInfo;
 
-		return buffer;
+		// each part only gets its own states, the dynamic states are shared by all the parts
+		VkGraphicsPipelineCreateInfo partInfo{};
+		partInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+		partInfo.pDynamicState = pipelineInfo.pDynamicState;
+		partInfo.basePipelineIndex = -1;
+
+		VkGraphicsPipelineCreateInfo vertexInputInfo = partInfo;
+		vertexInputInfo.pVertexInputState = pipelineInfo.pVertexInputState;
+		vertexInputInfo.pInputAssemblyState = pipelineInfo.pInputAssemblyState;
+
+		VkGraphicsPipelineCreateInfo preRasterizationInfo = partInfo;
+		preRasterizationInfo.stageCount = 1;
+		preRasterizationInfo.pStages = &createInfo.shaderStages[0];
+		preRasterizationInfo.pViewportState = pipelineInfo.pViewportState;
+		preRasterizationInfo.pRasterizationState = pipelineInfo.pRasterizationState;
+		preRasterizationInfo.layout = pipelineInfo.layout;
+		preRasterizationInfo.renderPass = pipelineInfo.renderPass;
+		preRasterizationInfo.subpass = pipelineInfo.subpass;
+
+		VkGraphicsPipelineCreateInfo fragmentShaderInfo = partInfo;
+		fragmentShaderInfo.stageCount = 1;
+		fragmentShaderInfo.pStages = &createInfo.shaderStages[1];
+		fragmentShaderInfo.pMultisampleState = pipelineInfo.pMultisampleState;
+		fragmentShaderInfo.pDepthStencilState = pipelineInfo.pDepthStencilState;
+		fragmentShaderInfo.layout = pipelineInfo.layout;
+		fragmentShaderInfo.renderPass = pipelineInfo.renderPass;
+		fragmentShaderInfo.subpass = pipelineInfo.subpass;
+
+		VkGraphicsPipelineCreateInfo fragmentOutputInfo = partInfo;
+		fragmentOutputInfo.pColorBlendState = pipelineInfo.pColorBlendState;
+		fragmentOutputInfo.pMultisampleState = pipelineInfo.pMultisampleState;
+		fragmentOutputInfo.renderPass = pipelineInfo.renderPass;
+		fragmentOutputInfo.subpass = pipelineInfo.subpass;
+
+		GraphicsPipelineLibrary::Parts parts = {
+			library->getPart(VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT, computePartHash(VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT), vertexInputInfo),
+			library->getPart(VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT, computePartHash(VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT), preRasterizationInfo),
+			library->getPart(VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT, computePartHash(VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT), fragmentShaderInfo),
+			library->getPart(VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT, computePartHash(VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT), fragmentOutputInfo)
+		};
+
+		VkPipelineLayout layout = pipelineInfo.layout;
+		ThreadPool *threadPool = library->getThreadPool();
+
+		// without fast linking, the link is as slow as a complete creation, link the optimized pipeline directly
+		if (!library->isFastLinkingSupported() || !threadPool || !backgroundOptimization){
+			optimized = true;
+			onBuilded(library->link(parts, layout, true));
+			return;
+		}
+
+		onBuilded(library->link(parts, layout, false));
+
+		optimizing = threadPool->submit([this, parts, layout](){
+			VkPipeline optimizedPipeline = library->link(parts, layout, true);
+
+			// the fast linked pipeline may still be used by the command buffers in flight, destroyed with the pipeline
+			fastLinkedPipeline = pipeline.exchange(optimizedPipeline);
+			optimized = true;
+		});
 	}
 
-	void Pipeline::createGraphicPipeline(){
-		auto vertShaderCode = readFile(vertPath);
-		auto fragShaderCode = readFile(fragPath);
+	void Pipeline::prepareCreateInfo(CreateInfo &createInfo){
+		// the modules are already loaded when creating a permutation
+		if (!builded){
+			ShaderReflection vertReflection, fragReflection;
+			loadShader(vertPath, vertShaderModule, vertReflection);
+			loadShader(fragPath, fragShaderModule, fragReflection);
+
+			if (config->pipelineLayout == VK_NULL_HANDLE && layoutCache){
+				std::vector<VkDescriptorSetLayoutCreateFlags> setFlags;
+				if (pushSet != NO_PUSH_SET){
+					setFlags.resize(pushSet + 1, 0);
+					setFlags[pushSet] = pushSetFlags;
+				}
 
-		createShaderModule(vertShaderCode, &vertShaderModule);
-		createShaderModule(fragShaderCode, &fragShaderModule);
+				config->pipelineLayout = layoutCache->getReflected({&vertReflection, &fragReflection}, setFlags, fixedSetLayouts);
+				reflectedLayout = true;
+			}
+			
+			pipelineLayout = config->pipelineLayout;
+			if (pushSet != NO_PUSH_SET) preparePushSet();
+		}
 
-		VkPipelineShaderStageCreateInfo shaderStages[2];
+		VkPipelineShaderStageCreateInfo *shaderStages = createInfo.shaderStages;
 		shaderStages[0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
 		shaderStages[0].stage = VK_SHADER_STAGE_VERTEX_BIT;
 		shaderStages[0].module = vertShaderModule;
 		shaderStages[0].pName = "main";
 		shaderStages[0].flags = 0;
 		shaderStages[0].pNext = nullptr;
-		shaderStages[0].pSpecializationInfo = nullptr;
+		shaderStages[0].pSpecializationInfo = vertConstants.getInfo();
 		
 		shaderStages[1].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
 		shaderStages[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
@@ -65,16 +306,31 @@ namespace vk_engine{
 		shaderStages[1].pName = "main";
 		shaderStages[1].flags = 0;
 		shaderStages[1].pNext = nullptr;
-		shaderStages[1].pSpecializationInfo = nullptr;
+		shaderStages[1].pSpecializationInfo = fragConstants.getInfo();
 
-		VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
+		VkPipelineVertexInputStateCreateInfo &vertexInputInfo = createInfo.vertexInputInfo;
+		vertexInputInfo = {};
 		vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
 		vertexInputInfo.vertexBindingDescriptionCount = 0;
 		vertexInputInfo.pVertexBindingDescriptions = nullptr;
 		vertexInputInfo.vertexAttributeDescriptionCount = 0;
 		vertexInputInfo.pVertexAttributeDescriptions = nullptr;
 
-		VkGraphicsPipelineCreateInfo pipelineInfo = {};
+		// the extended dynamic states are added to the config states
+		if (dynamicState && !builded){
+			for (VkDynamicState state : dynamicState->getDynamicStates()){
+				if (std::find(config->dynamicStateEnables.begin(), config->dynamicStateEnables.end(), state) == config->dynamicStateEnables.end())
+					config->dynamicStateEnables.push_back(state);
+			}
+		}
+
+		// the config may have been modified since the default config, update the internal pointers
+		config->colorBlendInfo.pAttachments = &config->colorBlendAttachment;
+		config->dynamicStateInfo.pDynamicStates = config->dynamicStateEnables.data();
+		config->dynamicStateInfo.dynamicStateCount = static_cast<uint32_t>(config->dynamicStateEnables.size());
+
+		VkGraphicsPipelineCreateInfo &pipelineInfo = createInfo.pipelineInfo;
+		pipelineInfo = {};
 		pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
 		pipelineInfo.stageCount = 2;
 		pipelineInfo.pStages = shaderStages;
@@ -94,21 +350,173 @@ namespace vk_engine{
 
 		pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;  // Optional
 		pipelineInfo.basePipelineIndex = -1;               // Optional
+	}
 
-		if (vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &pipeline) != VK_SUCCESS)
-			throw std::runtime_error("failed to create graphics pipeline!");
-		
+	SpecializationConstants &Pipeline::getSpecializationConstants(VkShaderStageFlagBits stage){
+		switch (stage){
+			case VK_SHADER_STAGE_VERTEX_BIT: return vertConstants;
+			case VK_SHADER_STAGE_FRAGMENT_BIT: return fragConstants;
+			default: throw std::runtime_error("unsupported specialization constant shader stage");
+		}
+	}
+
+	uint64_t Pipeline::computeHash() const noexcept{
+		uint64_t seed = HASH_SEED;
+		hashCombine(seed, computePartHash(VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT));
+		hashCombine(seed, computePartHash(VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT));
+		hashCombine(seed, computePartHash(VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT));
+		hashCombine(seed, computePartHash(VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT));
+		return seed;
+	}
+
+	uint64_t Pipeline::computePartHash(VkGraphicsPipelineLibraryFlagBitsEXT part) const noexcept{
+		uint64_t seed = HASH_SEED;
+
+		switch (part){
+			case VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT:
+				hashCombine(seed, vertPath);
+				seed = vertConstants.hash(seed);
+				break;
+			
+			case VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT:
+				hashCombine(seed, fragPath);
+				seed = fragConstants.hash(seed);
+				break;
+			
+			default: break;
+		}
+
+		if (!config) return seed;
+
+		// the dynamic states are part of the pipeline, the extended ones are hashed as prepareCreateInfo appends them to the config
+		// so the hash is the same before and after the build
+		for (const auto &state : config->dynamicStateEnables)
+			hashCombine(seed, state);
+
+		if (dynamicState){
+			for (const auto &state : dynamicState->getDynamicStates()){
+				if (std::find(config->dynamicStateEnables.begin(), config->dynamicStateEnables.end(), state) == config->dynamicStateEnables.end())
+					hashCombine(seed, state);
+			}
+		}
+
+		switch (part){
+			case VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT:
+				if (isDynamic(VK_DYNAMIC_STATE_PRIMITIVE_TOPOLOGY_EXT)){
+					hashCombine(seed, getTopologyClass(config->inputAssemblyInfo.topology));
+				} else {
+					hashCombine(seed, config->inputAssemblyInfo.topology);
+				}
+				if (!isDynamic(VK_DYNAMIC_STATE_PRIMITIVE_RESTART_ENABLE_EXT)) hashCombine(seed, config->inputAssemblyInfo.primitiveRestartEnable);
+				return seed;
+			
+			case VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT:{
+				hashCombine(seed, config->viewportInfo.viewportCount);
+				hashCombine(seed, config->viewportInfo.scissorCount);
+
+				const VkPipelineRasterizationStateCreateInfo &rasterization = config->rasterizationInfo;
+				hashCombine(seed, rasterization.depthClampEnable);
+				if (!isDynamic(VK_DYNAMIC_STATE_RASTERIZER_DISCARD_ENABLE_EXT)) hashCombine(seed, rasterization.rasterizerDiscardEnable);
+				hashCombine(seed, rasterization.polygonMode);
+				hashCombine(seed, rasterization.lineWidth);
+				if (!isDynamic(VK_DYNAMIC_STATE_CULL_MODE_EXT)) hashCombine(seed, rasterization.cullMode);
+				if (!isDynamic(VK_DYNAMIC_STATE_FRONT_FACE_EXT)) hashCombine(seed, rasterization.frontFace);
+				if (!isDynamic(VK_DYNAMIC_STATE_DEPTH_BIAS_ENABLE_EXT)) hashCombine(seed, rasterization.depthBiasEnable);
+				hashCombine(seed, rasterization.depthBiasConstantFactor);
+				hashCombine(seed, rasterization.depthBiasClamp);
+				hashCombine(seed, rasterization.depthBiasSlopeFactor);
+				break;
+			}
+			
+			case VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT:{
+				const VkPipelineDepthStencilStateCreateInfo &depthStencil = config->depthStencilInfo;
+				if (!isDynamic(VK_DYNAMIC_STATE_DEPTH_TEST_ENABLE_EXT)) hashCombine(seed, depthStencil.depthTestEnable);
+				if (!isDynamic(VK_DYNAMIC_STATE_DEPTH_WRITE_ENABLE_EXT)) hashCombine(seed, depthStencil.depthWriteEnable);
+				if (!isDynamic(VK_DYNAMIC_STATE_DEPTH_COMPARE_OP_EXT)) hashCombine(seed, depthStencil.depthCompareOp);
+				hashCombine(seed, depthStencil.depthBoundsTestEnable);
+				hashCombine(seed, depthStencil.stencilTestEnable);
+				hashCombine(seed, depthStencil.front);
+				hashCombine(seed, depthStencil.back);
+				hashCombine(seed, depthStencil.minDepthBounds);
+				hashCombine(seed, depthStencil.maxDepthBounds);
+				break;
+			}
+
+			case VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT:
+				// VkPipelineColorBlendAttachmentState only contains 32 bits fields, no padding
+				hashCombine(seed, config->colorBlendAttachment);
+				hashCombine(seed, config->colorBlendInfo.logicOpEnable);
+				hashCombine(seed, config->colorBlendInfo.logicOp);
+				hashCombine(seed, config->colorBlendInfo.attachmentCount);
+				hashCombine(seed, config->colorBlendInfo.blendConstants);
+				break;
+			
+			default: break;
+		}
+
+		// the multisample state is used by both fragment parts
+		if (part == VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT || part == VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT){
+			const VkPipelineMultisampleStateCreateInfo &multisample = config->multisampleInfo;
+			hashCombine(seed, multisample.rasterizationSamples);
+			hashCombine(seed, multisample.sampleShadingEnable);
+			hashCombine(seed, multisample.minSampleShading);
+			hashCombine(seed, multisample.alphaToCoverageEnable);
+			hashCombine(seed, multisample.alphaToOneEnable);
+		}
+
+		// the layout is not used by the fragment output part
+		if (part != VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT) hashCombine(seed, config->pipelineLayout);
+
+		hashCombine(seed, config->renderPass);
+		hashCombine(seed, config->subpass);
+
+		return seed;
 	}
 
-	void Pipeline::createShaderModule(const std::vector<char>& code, VkShaderModule* shaderModule) {
-		VkShaderModuleCreateInfo createInfo{};
-		createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-		createInfo.codeSize = code.size();
-		createInfo.pCode = reinterpret_cast<const uint32_t*>(code.data());
+	void Pipeline::preparePushSet(){
+		assert(reflectedLayout && "the push set requires a pipeline layout reflected by the layout cache");
+
+		const std::vector<VkDescriptorSetLayout> &setLayouts = layoutCache->getSetLayouts(pipelineLayout);
+		if (pushSet >= setLayouts.size())
+			throw std::runtime_error("the push set " + std::to_string(pushSet) + " is not used by the shaders");
+
+		pushSetLayout = setLayouts[pushSet];
+		if (!pushDescriptor || !pushDescriptor->isSupported()) return;
+
+		uint32_t descriptorCount = 0;
+		for (const auto &binding : layoutCache->getSetLayoutCache().getBindings(pushSetLayout))
+			descriptorCount += binding.count;
 
-		if (vkCreateShaderModule(device, &createInfo, nullptr, shaderModule) != VK_SUCCESS) {
-			throw std::runtime_error("failed to create shader module");
+		if (descriptorCount > pushDescriptor->getMaxPushDescriptors())
+			throw std::runtime_error("the push set " + std::to_string(pushSet) + " has more descriptors than the device can push");
+	}
+
+	void Pipeline::destroyShaderModules() noexcept{
+		// the modules of the cache are owned by it
+		if (!moduleCache){
+			vkDestroyShaderModule(device, fragShaderModule, nullptr);
+			vkDestroyShaderModule(device, vertShaderModule, nullptr);
 		}
+
+		fragShaderModule = VK_NULL_HANDLE;
+		vertShaderModule = VK_NULL_HANDLE;
+	}
+
+	void Pipeline::loadShader(const std::string &filepath, VkShaderModule &module, ShaderReflection &reflection){
+		if (moduleCache){
+			module = moduleCache->getModule(filepath);
+			reflection = moduleCache->getReflection(filepath);
+			return;
+		}
+
+		MappedFile file = ShaderModuleCache::mapFile(filepath);
+		const uint32_t *code = file.as<uint32_t>();
+		size_t wordCount = file.size() / sizeof(uint32_t);
+
+		module = ShaderModuleCache::createShaderModule(device, code, wordCount);
+
+		// the reflection is only used to create the layout
+		if (layoutCache) reflection = ShaderReflection(code, wordCount);
 	}
 
 	void Pipeline::defaultPipelineConfigInfo(ConfigInfo &configInfo){
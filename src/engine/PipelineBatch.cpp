@@ -0,0 +1,74 @@
+#include "engine/PipelineBatch.hpp"
+
+// std
+#include <stdexcept>
+#include <cassert>
+
+namespace vk_engine{
+	PipelineBatch::PipelineBatch(LogicalDevice &device) : device{device}{}
+
+	PipelineBatch::~PipelineBatch(){}
+
+	void PipelineBatch::push(Pipeline &pipeline){
+		assert(!pipeline.isBuilded() && "cannot push an already builded pipeline into a batch");
+		pipelines.push_back(&pipeline);
+	}
+
+	void PipelineBatch::build(){
+		if (pipelines.empty()) return;
+
+		// the create infos point to each others, the vector must not be resized after this point
+		std::vector<Pipeline::CreateInfo> createInfos(pipelines.size());
+		std::vector<VkGraphicsPipelineCreateInfo> pipelineInfos(pipelines.size());
+
+		for (size_t i=0; i<pipelines.size(); i++){
+			try {
+				pipelines[i]->prepareCreateInfo(createInfos[i]);
+			} catch (const std::exception &){
+				// the modules of the prepared pipelines would be loaded again by the next build
+				for (size_t j=0; j<=i; j++)
+					pipelines[j]->destroyShaderModules();
+				throw;
+			}
+
+			pipelineInfos[i] = createInfos[i].pipelineInfo;
+
+			if (derivatives){
+				if (i == 0){
+					pipelineInfos[i].flags |= VK_PIPELINE_CREATE_ALLOW_DERIVATIVES_BIT;
+				} else {
+					pipelineInfos[i].flags |= VK_PIPELINE_CREATE_DERIVATIVE_BIT;
+					pipelineInfos[i].basePipelineHandle = VK_NULL_HANDLE;
+					pipelineInfos[i].basePipelineIndex = 0;
+				}
+			}
+		}
+
+		// if the cache of the batch is not set, use the one of the first pipeline
+		VkPipelineCache pipelineCache = VK_NULL_HANDLE;
+		if (cache){
+			pipelineCache = cache->get();
+		} else if (pipelines[0]->cache){
+			pipelineCache = pipelines[0]->cache->get();
+		}
+
+		std::vector<VkPipeline> handles(pipelines.size(), VK_NULL_HANDLE);
+		VkResult result = vkCreateGraphicsPipelines(device, pipelineCache, static_cast<uint32_t>(pipelineInfos.size()), pipelineInfos.data(), nullptr, handles.data());
+
+		if (result != VK_SUCCESS){
+			// on failure, some pipelines may still have been created
+			for (auto &handle : handles)
+				vkDestroyPipeline(device, handle, nullptr);
+
+			for (auto &pipeline : pipelines)
+				pipeline->destroyShaderModules();
+
+			throw std::runtime_error("failed to create graphics pipelines batch");
+		}
+
+		for (size_t i=0; i<pipelines.size(); i++)
+			pipelines[i]->onBuilded(handles[i]);
+
+		pipelines.clear();
+	}
+}
\ No newline at end of file
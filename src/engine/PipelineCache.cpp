@@ -0,0 +1,81 @@
+#include "engine/PipelineCache.hpp"
+
+// std
+#include <stdexcept>
+#include <fstream>
+#include <cstring>
+#include <cassert>
+
+namespace vk_engine{
+	PipelineCache::PipelineCache(LogicalDevice &device) : device{device}{}
+
+	PipelineCache::~PipelineCache(){
+		vkDestroyPipelineCache(device, cache, nullptr);
+	}
+
+	void PipelineCache::build(){
+		std::vector<char> data;
+
+		if (!filepath.empty()){
+			std::ifstream file(filepath, std::ios::ate | std::ios::binary);
+
+			if (file.is_open()){
+				data.resize(static_cast<size_t>(file.tellg()));
+				file.seekg(0);
+				file.read(data.data(), data.size());
+			}
+
+			// a cache from an other driver or device is rejected, start from an empty one
+			if (!isCompatible(data)) data.clear();
+		}
+
+		VkPipelineCacheCreateInfo createInfo{};
+		createInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+		createInfo.initialDataSize = data.size();
+		createInfo.pInitialData = data.empty() ? nullptr : data.data();
+
+		if (vkCreatePipelineCache(device, &createInfo, nullptr, &cache) != VK_SUCCESS)
+			throw std::runtime_error("failed to create pipeline cache");
+	}
+
+	std::vector<char> PipelineCache::getData() const{
+		size_t size = 0;
+		vkGetPipelineCacheData(device, cache, &size, nullptr);
+
+		std::vector<char> data(size);
+		if (size > 0 && vkGetPipelineCacheData(device, cache, &size, data.data()) != VK_SUCCESS)
+			throw std::runtime_error("failed to get pipeline cache data");
+
+		return data;
+	}
+
+	void PipelineCache::save(){
+		assert(cache != VK_NULL_HANDLE && "cannot save a pipeline cache before the build");
+		if (filepath.empty()) return;
+
+		std::vector<char> data = getData();
+
+		std::ofstream file(filepath, std::ios::binary | std::ios::trunc);
+		if (!file.is_open())
+			throw std::runtime_error("failed to open : " + filepath);
+
+		file.write(data.data(), data.size());
+	}
+
+	bool PipelineCache::isCompatible(const std::vector<char> &data) const noexcept{
+		// header layout : length, version, vendorID, deviceID, pipelineCacheUUID
+		constexpr size_t headerSize = 16 + VK_UUID_SIZE;
+		if (data.size() < headerSize) return false;
+
+		uint32_t header[4];
+		memcpy(header, data.data(), sizeof(header));
+
+		VkPhysicalDeviceProperties properties = device.getPhysicalDevice().getProperties();
+
+		if (header[0] < headerSize) return false;
+		if (header[1] != VK_PIPELINE_CACHE_HEADER_VERSION_ONE) return false;
+		if (header[2] != properties.vendorID || header[3] != properties.deviceID) return false;
+
+		return memcmp(data.data() + 16, properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,152 @@
+#include "engine/PipelineLayoutCache.hpp"
+#include "engine/Hash.hpp"
+
+// std
+#include <stdexcept>
+#include <algorithm>
+#include <map>
+
+namespace vk_engine{
+	PipelineLayoutCache::PipelineLayoutCache(LogicalDevice &device, DescriptorSetLayoutCache &setLayoutCache) : device{device}, setLayoutCache{setLayoutCache}{}
+
+	PipelineLayoutCache::~PipelineLayoutCache(){
+		for (auto &layout : layouts)
+			vkDestroyPipelineLayout(device, layout.second, nullptr);
+	}
+
+	VkPipelineLayout PipelineLayoutCache::get(const std::vector<VkDescriptorSetLayout> &setLayouts, std::vector<VkPushConstantRange> pushConstantRanges){
+		normalize(pushConstantRanges);
+
+		Key key;
+		key.setLayouts = setLayouts;
+		key.pushConstantRanges = std::move(pushConstantRanges);
+
+		std::lock_guard<std::mutex> lock(mutex);
+
+		auto it = layouts.find(key);
+		if (it != layouts.end()) return it->second;
+
+		VkPipelineLayoutCreateInfo createInfo{};
+		createInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+		createInfo.setLayoutCount = static_cast<uint32_t>(key.setLayouts.size());
+		createInfo.pSetLayouts = key.setLayouts.data();
+		createInfo.pushConstantRangeCount = static_cast<uint32_t>(key.pushConstantRanges.size());
+		createInfo.pPushConstantRanges = key.pushConstantRanges.data();
+
+		VkPipelineLayout layout;
+		if (vkCreatePipelineLayout(device, &createInfo, nullptr, &layout) != VK_SUCCESS)
+			throw std::runtime_error("failed to create pipeline layout");
+
+		auto inserted = layouts.emplace(std::move(key), layout).first;
+		keys[layout] = &inserted->first;
+
+		return layout;
+	}
+
+	VkPipelineLayout PipelineLayoutCache::getReflected(const std::vector<const ShaderReflection*> &shaders, const std::vector<VkDescriptorSetLayoutCreateFlags> &setFlags, const std::vector<VkDescriptorSetLayout> &fixedSetLayouts){
+		std::map<uint32_t, std::vector<DescriptorSetLayoutCache::Binding>> sets;
+		VkPushConstantRange pushConstantRange{};
+
+		auto isFixed = [&](uint32_t set){return set < fixedSetLayouts.size() && fixedSetLayouts[set] != VK_NULL_HANDLE;};
+
+		for (const ShaderReflection *shader : shaders){
+			for (const auto &reflected : shader->getBindings()){
+				if (isFixed(reflected.set)) continue;
+
+				if (reflected.count == 0)
+					throw std::runtime_error("cannot reflect the unbounded descriptor array of the set " + std::to_string(reflected.set) + " binding " + std::to_string(reflected.binding) + ", give the layout of the set");
+
+				DescriptorSetLayoutCache::Binding binding;
+				binding.binding = reflected.binding;
+				binding.type = reflected.type;
+				binding.count = reflected.count;
+				binding.stages = reflected.stages;
+				sets[reflected.set].push_back(binding);
+			}
+
+			VkPushConstantRange range = shader->getPushConstantRange();
+			if (range.size > 0){
+				pushConstantRange.size = std::max(pushConstantRange.size, range.offset + range.size);
+				pushConstantRange.stageFlags |= range.stageFlags;
+			}
+		}
+
+		uint32_t setCount = sets.empty() ? 0 : sets.rbegin()->first + 1;
+		for (uint32_t set=0; set<fixedSetLayouts.size(); set++){
+			if (isFixed(set)) setCount = std::max(setCount, set + 1);
+		}
+
+		std::vector<VkDescriptorSetLayout> setLayouts(setCount, VK_NULL_HANDLE);
+
+		for (auto &set : sets){
+			VkDescriptorSetLayoutCreateFlags flags = set.first < setFlags.size() ? setFlags[set.first] : 0;
+			setLayouts[set.first] = setLayoutCache.get(set.second, flags);
+		}
+
+		for (uint32_t set=0; set<setCount; set++){
+			if (isFixed(set)) setLayouts[set] = fixedSetLayouts[set];
+		}
+
+		// the holes get an empty layout
+		for (auto &setLayout : setLayouts){
+			if (setLayout == VK_NULL_HANDLE) setLayout = setLayoutCache.get({});
+		}
+
+		std::vector<VkPushConstantRange> pushConstantRanges;
+		if (pushConstantRange.size > 0) pushConstantRanges.push_back(pushConstantRange);
+
+		return get(setLayouts, pushConstantRanges);
+	}
+
+	const std::vector<VkDescriptorSetLayout> &PipelineLayoutCache::getSetLayouts(VkPipelineLayout layout){
+		std::lock_guard<std::mutex> lock(mutex);
+
+		auto it = keys.find(layout);
+		if (it == keys.end())
+			throw std::runtime_error("the pipeline layout has not been created by this cache");
+
+		return it->second->setLayouts;
+	}
+
+	void PipelineLayoutCache::normalize(std::vector<VkPushConstantRange> &ranges){
+		std::sort(ranges.begin(), ranges.end(), [](const VkPushConstantRange &a, const VkPushConstantRange &b){
+			if (a.offset != b.offset) return a.offset < b.offset;
+			if (a.size != b.size) return a.size < b.size;
+			return a.stageFlags < b.stageFlags;
+		});
+
+		std::vector<VkPushConstantRange> merged;
+		for (const auto &range : ranges){
+			if (!merged.empty() && merged.back().offset == range.offset && merged.back().size == range.size){
+				merged.back().stageFlags |= range.stageFlags;
+				continue;
+			}
+			merged.push_back(range);
+		}
+
+		ranges = std::move(merged);
+	}
+
+	bool PipelineLayoutCache::Key::operator==(const Key &other) const noexcept{
+		if (setLayouts != other.setLayouts || pushConstantRanges.size() != other.pushConstantRanges.size()) return false;
+
+		for (size_t i=0; i<pushConstantRanges.size(); i++){
+			const VkPushConstantRange &a = pushConstantRanges[i];
+			const VkPushConstantRange &b = other.pushConstantRanges[i];
+			if (a.offset != b.offset || a.size != b.size || a.stageFlags != b.stageFlags) return false;
+		}
+		return true;
+	}
+
+	size_t PipelineLayoutCache::KeyHash::operator()(const Key &key) const noexcept{
+		uint64_t seed = HASH_SEED;
+
+		for (const auto &setLayout : key.setLayouts)
+			hashCombine(seed, setLayout);
+
+		for (const auto &range : key.pushConstantRanges)
+			hashCombine(seed, range);
+
+		return static_cast<size_t>(seed);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,341 @@
+#include "engine/PipelineManifest.hpp"
+#include "engine/Pipeline.hpp"
+#include "engine/Hash.hpp"
+
+// std
+#include <stdexcept>
+#include <fstream>
+#include <cstring>
+#include <type_traits>
+#include <initializer_list>
+#include <cstddef>
+#include <algorithm>
+
+namespace vk_engine{
+	template<typename T> static void write(std::vector<char> &data, const T &value){
+		static_assert(std::is_trivially_copyable<T>::value, "only trivially copyable types can be serialized");
+		const char *bytes = reinterpret_cast<const char*>(&value);
+		data.insert(data.end(), bytes, bytes + sizeof(T));
+	}
+
+	// the pointers of the current run are cleared so the same state gives the same bytes in every run
+	template<typename T> static void writeState(std::vector<char> &data, const T &state, std::initializer_list<size_t> pointers){
+		const size_t offset = data.size();
+		write(data, state);
+
+		for (size_t pointer : pointers)
+			memset(data.data() + offset + pointer, 0, sizeof(void*));
+	}
+
+	static void writeBytes(std::vector<char> &data, const std::vector<char> &bytes){
+		write(data, static_cast<uint32_t>(bytes.size()));
+		data.insert(data.end(), bytes.begin(), bytes.end());
+	}
+
+	static void writeString(std::vector<char> &data, const std::string &str){
+		writeBytes(data, std::vector<char>(str.begin(), str.end()));
+	}
+
+	template<typename T> static T read(const std::vector<char> &data, size_t &offset){
+		static_assert(std::is_trivially_copyable<T>::value, "only trivially copyable types can be serialized");
+		if (offset + sizeof(T) > data.size())
+			throw std::runtime_error("corrupted pipeline manifest");
+
+		T value;
+		memcpy(&value, data.data() + offset, sizeof(T));
+		offset += sizeof(T);
+		return value;
+	}
+
+	static std::vector<char> readBytes(const std::vector<char> &data, size_t &offset){
+		uint32_t size = read<uint32_t>(data, offset);
+		if (offset + size > data.size())
+			throw std::runtime_error("corrupted pipeline manifest");
+
+		std::vector<char> bytes(data.begin() + offset, data.begin() + offset + size);
+		offset += size;
+		return bytes;
+	}
+
+	static std::string readString(const std::vector<char> &data, size_t &offset){
+		std::vector<char> bytes = readBytes(data, offset);
+		return std::string(bytes.begin(), bytes.end());
+	}
+
+	static void writeConstants(std::vector<char> &data, const SpecializationConstants &constants){
+		write(data, static_cast<uint32_t>(constants.getConstants().size()));
+		for (const auto &constant : constants.getConstants()){
+			write(data, constant.first);
+			writeBytes(data, constant.second);
+		}
+	}
+
+	static void readConstants(const std::vector<char> &data, size_t &offset, SpecializationConstants &constants){
+		uint32_t count = read<uint32_t>(data, offset);
+		for (uint32_t i=0; i<count; i++){
+			uint32_t id = read<uint32_t>(data, offset);
+			std::vector<char> value = readBytes(data, offset);
+			constants.setRaw(id, value.data(), value.size());
+		}
+	}
+
+	PipelineManifest::PipelineManifest(LogicalDevice &device) : device{device}{}
+
+	PipelineManifest::~PipelineManifest(){
+		wait();
+	}
+
+	void PipelineManifest::load(){
+		std::ifstream file(filepath, std::ios::ate | std::ios::binary);
+		if (!file.is_open()) return;
+
+		std::vector<char> data(static_cast<size_t>(file.tellg()));
+		file.seekg(0);
+		file.read(data.data(), data.size());
+
+		std::lock_guard<std::mutex> lock(mutex);
+
+		try {
+			size_t offset = 0;
+			if (read<uint32_t>(data, offset) != MAGIC) return;
+
+			// the structures are stored as is, a manifest from an other version or architecture is ignored
+			if (read<uint32_t>(data, offset) != MANIFEST_VERSION) return;
+			if (read<uint32_t>(data, offset) != sizeof(void*)) return;
+
+			// the states depend on the features of the device, a manifest from an other device is ignored
+			if (!isDeviceCompatible(data, offset)) return;
+
+			uint32_t count = read<uint32_t>(data, offset);
+			for (uint32_t i=0; i<count; i++){
+				uint64_t hash = read<uint64_t>(data, offset);
+				entries[hash] = readBytes(data, offset);
+			}
+		} catch (const std::runtime_error &){
+			entries.clear();
+		}
+	}
+
+	bool PipelineManifest::isDeviceCompatible(const std::vector<char> &data, size_t &offset) const{
+		if (offset + VK_UUID_SIZE > data.size())
+			throw std::runtime_error("corrupted pipeline manifest");
+
+		VkPhysicalDeviceProperties properties = device.getPhysicalDevice().getProperties();
+		bool compatible = memcmp(data.data() + offset, properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+
+		offset += VK_UUID_SIZE;
+		return compatible;
+	}
+
+	void PipelineManifest::save(){
+		std::lock_guard<std::mutex> lock(mutex);
+		if (!modified || filepath.empty()) return;
+
+		std::vector<char> data;
+		write(data, MAGIC);
+		write(data, MANIFEST_VERSION);
+		write(data, static_cast<uint32_t>(sizeof(void*)));
+
+		VkPhysicalDeviceProperties properties = device.getPhysicalDevice().getProperties();
+		data.insert(data.end(), properties.pipelineCacheUUID, properties.pipelineCacheUUID + VK_UUID_SIZE);
+
+		write(data, static_cast<uint32_t>(entries.size()));
+
+		for (const auto &entry : entries){
+			write(data, entry.first);
+			writeBytes(data, entry.second);
+		}
+
+		std::ofstream file(filepath, std::ios::binary | std::ios::trunc);
+		if (!file.is_open())
+			throw std::runtime_error("failed to open : " + filepath);
+
+		file.write(data.data(), data.size());
+		modified = false;
+	}
+
+	void PipelineManifest::registerRenderPass(uint32_t id, VkRenderPass renderPass){
+		std::lock_guard<std::mutex> lock(mutex);
+		renderPasses[id] = renderPass;
+	}
+
+	void PipelineManifest::registerPipelineLayout(uint32_t id, VkPipelineLayout layout){
+		std::lock_guard<std::mutex> lock(mutex);
+		pipelineLayouts[id] = layout;
+	}
+
+	void PipelineManifest::record(const Pipeline &pipeline){
+		std::lock_guard<std::mutex> lock(mutex);
+
+		std::vector<char> data = serialize(pipeline);
+		if (data.empty()) return;
+
+		// keyed by the serialized state, the runtime handles differ from a run to the next
+		uint64_t hash = hashBytes(data.data(), data.size());
+		if (entries.find(hash) != entries.end()) return;
+
+		entries[hash] = std::move(data);
+		modified = true;
+	}
+
+	std::vector<char> PipelineManifest::serialize(const Pipeline &pipeline) const{
+		const Pipeline::ConfigInfo &config = *pipeline.config;
+
+		uint32_t renderPassId = NO_ID;
+		for (const auto &renderPass : renderPasses){
+			if (renderPass.second == config.renderPass) renderPassId = renderPass.first;
+		}
+
+		uint32_t layoutId = NO_ID;
+		if (!pipeline.reflectedLayout){
+			for (const auto &layout : pipelineLayouts){
+				if (layout.second == config.pipelineLayout) layoutId = layout.first;
+			}
+			if (layoutId == NO_ID) return {};
+		}
+
+		if (renderPassId == NO_ID) return {};
+
+		// the fixed set layouts are runtime handles, as the unregistered layouts
+		if (!pipeline.fixedSetLayouts.empty()) return {};
+
+		std::vector<char> data;
+		writeString(data, pipeline.vertPath);
+		writeString(data, pipeline.fragPath);
+		writeConstants(data, pipeline.vertConstants);
+		writeConstants(data, pipeline.fragConstants);
+
+		write(data, renderPassId);
+		write(data, layoutId);
+		write(data, config.subpass);
+
+		// the flags of the push set and the extended dynamic states are recomputed from the support of the device on the replay
+		write(data, pipeline.pushSet);
+		write(data, static_cast<uint8_t>(pipeline.dynamicState != nullptr));
+
+		// the pointers are restored by the pipeline on the build
+		writeState(data, config.viewportInfo, {offsetof(VkPipelineViewportStateCreateInfo, pNext), offsetof(VkPipelineViewportStateCreateInfo, pViewports), offsetof(VkPipelineViewportStateCreateInfo, pScissors)});
+		writeState(data, config.inputAssemblyInfo, {offsetof(VkPipelineInputAssemblyStateCreateInfo, pNext)});
+		writeState(data, config.rasterizationInfo, {offsetof(VkPipelineRasterizationStateCreateInfo, pNext)});
+		writeState(data, config.multisampleInfo, {offsetof(VkPipelineMultisampleStateCreateInfo, pNext), offsetof(VkPipelineMultisampleStateCreateInfo, pSampleMask)});
+		write(data, config.colorBlendAttachment);
+		writeState(data, config.colorBlendInfo, {offsetof(VkPipelineColorBlendStateCreateInfo, pNext), offsetof(VkPipelineColorBlendStateCreateInfo, pAttachments)});
+		writeState(data, config.depthStencilInfo, {offsetof(VkPipelineDepthStencilStateCreateInfo, pNext)});
+
+		std::vector<VkDynamicState> dynamicStates;
+		for (const auto &state : config.dynamicStateEnables){
+			if (!pipeline.dynamicState || std::find(pipeline.dynamicState->getDynamicStates().begin(), pipeline.dynamicState->getDynamicStates().end(), state) == pipeline.dynamicState->getDynamicStates().end())
+				dynamicStates.push_back(state);
+		}
+
+		write(data, static_cast<uint32_t>(dynamicStates.size()));
+		for (const auto &state : dynamicStates)
+			write(data, state);
+
+		return data;
+	}
+
+	void PipelineManifest::replay(ThreadPool &threadPool){
+		std::lock_guard<std::mutex> lock(mutex);
+
+		for (const auto &entry : entries){
+			const std::vector<char> *data = &entry.second;
+
+			replays.push_back(threadPool.submit([this, data](){
+				try {
+					replayEntry(*data);
+				} catch (const std::exception &){
+					// a stale entry, the shaders may have been removed or modified
+					failedCount++;
+				}
+			}));
+		}
+	}
+
+	void PipelineManifest::wait(){
+		for (auto &replay : replays)
+			replay.wait();
+
+		replays.clear();
+	}
+
+	void PipelineManifest::replayEntry(const std::vector<char> &data){
+		Pipeline pipeline(device);
+		Pipeline::ConfigInfo &config = pipeline.getConfig();
+
+		size_t offset = 0;
+		pipeline.vertPath = readString(data, offset);
+		pipeline.fragPath = readString(data, offset);
+		readConstants(data, offset, pipeline.vertConstants);
+		readConstants(data, offset, pipeline.fragConstants);
+
+		uint32_t renderPassId = read<uint32_t>(data, offset);
+		uint32_t layoutId = read<uint32_t>(data, offset);
+		config.subpass = read<uint32_t>(data, offset);
+		uint32_t pushSet = read<uint32_t>(data, offset);
+		bool extendedDynamicState = read<uint8_t>(data, offset) != 0;
+
+		config.viewportInfo = read<VkPipelineViewportStateCreateInfo>(data, offset);
+		config.inputAssemblyInfo = read<VkPipelineInputAssemblyStateCreateInfo>(data, offset);
+		config.rasterizationInfo = read<VkPipelineRasterizationStateCreateInfo>(data, offset);
+		config.multisampleInfo = read<VkPipelineMultisampleStateCreateInfo>(data, offset);
+		config.colorBlendAttachment = read<VkPipelineColorBlendAttachmentState>(data, offset);
+		config.colorBlendInfo = read<VkPipelineColorBlendStateCreateInfo>(data, offset);
+		config.depthStencilInfo = read<VkPipelineDepthStencilStateCreateInfo>(data, offset);
+
+		config.dynamicStateEnables.resize(read<uint32_t>(data, offset));
+		for (auto &state : config.dynamicStateEnables)
+			state = read<VkDynamicState>(data, offset);
+
+		// the pointers of the previous run
+		config.viewportInfo.pNext = nullptr;
+		config.viewportInfo.pViewports = nullptr;
+		config.viewportInfo.pScissors = nullptr;
+		config.inputAssemblyInfo.pNext = nullptr;
+		config.rasterizationInfo.pNext = nullptr;
+		config.multisampleInfo.pNext = nullptr;
+		config.multisampleInfo.pSampleMask = nullptr;
+		config.colorBlendInfo.pNext = nullptr;
+		config.depthStencilInfo.pNext = nullptr;
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+
+			auto renderPass = renderPasses.find(renderPassId);
+			if (renderPass == renderPasses.end())
+				throw std::runtime_error("unregistered render pass id");
+			config.renderPass = renderPass->second;
+
+			if (layoutId != NO_ID){
+				auto layout = pipelineLayouts.find(layoutId);
+				if (layout == pipelineLayouts.end())
+					throw std::runtime_error("unregistered pipeline layout id");
+				config.pipelineLayout = layout->second;
+			}
+		}
+
+		if (layoutId == NO_ID && !layoutCache)
+			throw std::runtime_error("a pipeline layout cache is required to replay reflected layouts");
+
+		if (pushSet != Pipeline::NO_PUSH_SET){
+			if (!pushDescriptor)
+				throw std::runtime_error("a push descriptor is required to replay push sets");
+			pipeline.setPushDescriptorSet(*pushDescriptor, pushSet);
+		}
+
+		if (extendedDynamicState){
+			if (!dynamicState)
+				throw std::runtime_error("an extended dynamic state is required to replay dynamic pipelines");
+			pipeline.setExtendedDynamicState(*dynamicState);
+		}
+
+		if (cache) pipeline.setPipelineCache(*cache);
+		if (moduleCache) pipeline.setShaderModuleCache(*moduleCache);
+		if (layoutCache) pipeline.setPipelineLayoutCache(*layoutCache);
+		if (library) pipeline.setGraphicsPipelineLibrary(*library);
+
+		// already on a worker thread, the optimized pipeline is linked directly
+		pipeline.backgroundOptimization = false;
+		pipeline.build();
+	}
+}
\ No newline at end of file
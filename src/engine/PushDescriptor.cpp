@@ -0,0 +1,24 @@
+#include "engine/PushDescriptor.hpp"
+
+// std
+#include <stdexcept>
+
+namespace vk_engine{
+	PushDescriptor::PushDescriptor(LogicalDevice &device) : device{device}{}
+
+	void PushDescriptor::require(){
+		device.requireOptionalExtension(VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME);
+	}
+
+	void PushDescriptor::build(){
+		supported = device.isExtensionEnabled(VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME);
+		if (!supported) return;
+
+		cmdPushDescriptorSet = device.getProcAddr<PFN_vkCmdPushDescriptorSetKHR>("vkCmdPushDescriptorSetKHR");
+		if (!cmdPushDescriptorSet)
+			throw std::runtime_error("failed to load the VK_KHR_push_descriptor commands");
+
+		auto properties = device.getPhysicalDevice().getProperties<VkPhysicalDevicePushDescriptorPropertiesKHR>(VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PUSH_DESCRIPTOR_PROPERTIES_KHR);
+		maxPushDescriptors = properties.maxPushDescriptors;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,726 @@
+#include "engine/RenderGraph.hpp"
+#include "engine/ImageStateTracker.hpp"
+
+// std
+#include <stdexcept>
+#include <cassert>
+#include <algorithm>
+
+namespace vk_engine{
+	static constexpr VkAccessFlags WRITE_ACCESS = VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT |
+		VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_HOST_WRITE_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+
+	void RenderGraph::PassBuilder::writeColor(ResourceId image, VkAttachmentLoadOp loadOp, VkClearColorValue clearColor){
+		bool load = loadOp == VK_ATTACHMENT_LOAD_OP_LOAD;
+
+		VkClearValue clearValue{};
+		clearValue.color = clearColor;
+		graph.passes[pass].colorAttachments.push_back({image, loadOp, clearValue});
+
+		VkAccessFlags access = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | (load ? VK_ACCESS_COLOR_ATTACHMENT_READ_BIT : 0);
+		graph.addAccess(pass, {image, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, access, load, true}, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT);
+	}
+
+	void RenderGraph::PassBuilder::writeDepth(ResourceId image, VkAttachmentLoadOp loadOp, VkClearDepthStencilValue clearValue){
+		assert(graph.passes[pass].depthAttachment.resource == INVALID_RESOURCE && "a pass can only have one depth attachment");
+		bool load = loadOp == VK_ATTACHMENT_LOAD_OP_LOAD;
+
+		VkClearValue value{};
+		value.depthStencil = clearValue;
+		graph.passes[pass].depthAttachment = {image, loadOp, value};
+
+		VkPipelineStageFlags stages = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+		VkAccessFlags access = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+		graph.addAccess(pass, {image, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, stages, access, load, true}, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT);
+	}
+
+	void RenderGraph::PassBuilder::readTexture(ResourceId image, VkPipelineStageFlags stages){
+		graph.addAccess(pass, {image, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, stages, VK_ACCESS_SHADER_READ_BIT, true, false}, VK_IMAGE_USAGE_SAMPLED_BIT);
+	}
+
+	void RenderGraph::PassBuilder::readStorageImage(ResourceId image, VkPipelineStageFlags stages){
+		graph.addAccess(pass, {image, VK_IMAGE_LAYOUT_GENERAL, stages, VK_ACCESS_SHADER_READ_BIT, true, false}, VK_IMAGE_USAGE_STORAGE_BIT);
+	}
+
+	void RenderGraph::PassBuilder::writeStorageImage(ResourceId image, VkPipelineStageFlags stages){
+		graph.addAccess(pass, {image, VK_IMAGE_LAYOUT_GENERAL, stages, VK_ACCESS_SHADER_WRITE_BIT, false, true}, VK_IMAGE_USAGE_STORAGE_BIT);
+	}
+
+	void RenderGraph::PassBuilder::readBuffer(ResourceId buffer, VkPipelineStageFlags stages, VkAccessFlags access, VkBufferUsageFlags usage){
+		graph.addAccess(pass, {buffer, VK_IMAGE_LAYOUT_UNDEFINED, stages, access, true, false}, usage);
+	}
+
+	void RenderGraph::PassBuilder::writeBuffer(ResourceId buffer, VkPipelineStageFlags stages, VkAccessFlags access, VkBufferUsageFlags usage){
+		graph.addAccess(pass, {buffer, VK_IMAGE_LAYOUT_UNDEFINED, stages, access, false, true}, usage);
+	}
+
+	void RenderGraph::PassBuilder::setSideEffects() noexcept{
+		graph.passes[pass].sideEffects = true;
+	}
+
+	RenderGraph::RenderGraph(LogicalDevice &device) : device{device}{}
+
+	RenderGraph::~RenderGraph(){
+		clear();
+	}
+
+	RenderGraph::ResourceId RenderGraph::createImage(const std::string &name, const ImageInfo &info){
+		assert(!compiled && "cannot declare a resource in a compiled graph");
+
+		Resource resource;
+		resource.name = name;
+		resource.format = info.format;
+		resource.extent = info.extent;
+		resource.layers = info.layers;
+		resource.samples = info.samples;
+		resource.imageUsage = info.usage;
+
+		resources.push_back(resource);
+		return static_cast<ResourceId>(resources.size() - 1);
+	}
+
+	RenderGraph::ResourceId RenderGraph::createBuffer(const std::string &name, const BufferInfo &info){
+		assert(!compiled && "cannot declare a resource in a compiled graph");
+
+		Resource resource;
+		resource.name = name;
+		resource.isImage = false;
+		resource.size = info.size;
+		resource.bufferUsage = info.usage;
+
+		resources.push_back(resource);
+		return static_cast<ResourceId>(resources.size() - 1);
+	}
+
+	RenderGraph::ResourceId RenderGraph::importImage(const std::string &name, const ImportedImageInfo &info){
+		assert(!compiled && "cannot declare a resource in a compiled graph");
+
+		Resource resource;
+		resource.name = name;
+		resource.imported = true;
+		resource.output = true;
+		resource.image = info.image;
+		resource.view = info.view;
+		resource.format = info.format;
+		resource.extent = info.extent;
+		resource.samples = info.samples;
+		resource.initialLayout = info.initialLayout;
+		resource.initialStage = info.initialStage;
+		resource.initialAccess = info.initialAccess;
+		resource.finalLayout = info.finalLayout;
+
+		resources.push_back(resource);
+		return static_cast<ResourceId>(resources.size() - 1);
+	}
+
+	RenderGraph::ResourceId RenderGraph::importBuffer(const std::string &name, VkBuffer buffer, VkDeviceSize size, VkPipelineStageFlags initialStage, VkAccessFlags initialAccess){
+		assert(!compiled && "cannot declare a resource in a compiled graph");
+
+		Resource resource;
+		resource.name = name;
+		resource.isImage = false;
+		resource.imported = true;
+		resource.output = true;
+		resource.buffer = buffer;
+		resource.size = size;
+		resource.initialStage = initialStage;
+		resource.initialAccess = initialAccess;
+
+		resources.push_back(resource);
+		return static_cast<ResourceId>(resources.size() - 1);
+	}
+
+	void RenderGraph::setImportedImage(ResourceId image, VkImage vkImage, VkImageView view){
+		assert(image < resources.size() && resources[image].imported && resources[image].isImage && "the resource is not an imported image");
+		resources[image].image = vkImage;
+		resources[image].view = view;
+	}
+
+	void RenderGraph::setOutput(ResourceId resource){
+		assert(resource < resources.size() && "invalid resource");
+		resources[resource].output = true;
+	}
+
+	RenderGraph::PassId RenderGraph::addPass(const std::string &name, const std::function<void(PassBuilder&)> &setup, Execute execute){
+		assert(!compiled && "cannot add a pass to a compiled graph");
+
+		passes.emplace_back();
+		passes.back().name = name;
+		passes.back().execute = std::move(execute);
+
+		PassId id = static_cast<PassId>(passes.size() - 1);
+		PassBuilder builder(*this, id);
+		setup(builder);
+
+		return id;
+	}
+
+	void RenderGraph::addAccess(PassId pass, const Access &access, VkFlags usage){
+		assert(access.resource < resources.size() && "invalid resource");
+		Resource &resource = resources[access.resource];
+
+		if (resource.isImage){
+			resource.imageUsage |= usage;
+		} else {
+			resource.bufferUsage |= usage;
+		}
+
+		// the same resource used twice by a pass
+		for (auto &previous : passes[pass].accesses){
+			if (previous.resource != access.resource) continue;
+
+			if (previous.layout != access.layout)
+				throw std::runtime_error("the pass " + passes[pass].name + " uses " + resource.name + " in two different layouts");
+
+			previous.stages |= access.stages;
+			previous.access |= access.access;
+			previous.read |= access.read;
+			previous.write |= access.write;
+			return;
+		}
+
+		passes[pass].accesses.push_back(access);
+	}
+
+	void RenderGraph::compile(){
+		assert(!compiled && "the graph is already compiled");
+
+		cullPasses();
+		computeLifetimes();
+		createResources();
+		createRenderPasses();
+		computeBarriers();
+
+		compiled = true;
+	}
+
+	void RenderGraph::cullPasses(){
+		std::vector<bool> needed(resources.size());
+		for (size_t i=0; i<resources.size(); i++)
+			needed[i] = resources[i].output;
+
+		// from the last pass, a pass is kept if a following pass or the user reads one of its writes
+		for (size_t i=passes.size(); i-- > 0;){
+			Pass &pass = passes[i];
+
+			bool alive = pass.sideEffects;
+			for (const auto &access : pass.accesses)
+				alive |= access.write && needed[access.resource];
+
+			pass.culled = !alive;
+			if (!alive) continue;
+
+			// the previous content of an overwritten resource is not needed anymore
+			for (const auto &access : pass.accesses){
+				if (access.write && !access.read) needed[access.resource] = false;
+			}
+
+			for (const auto &access : pass.accesses){
+				if (access.read) needed[access.resource] = true;
+			}
+		}
+	}
+
+	void RenderGraph::computeLifetimes(){
+		for (uint32_t i=0; i<passes.size(); i++){
+			if (passes[i].culled) continue;
+
+			for (const auto &access : passes[i].accesses){
+				Resource &resource = resources[access.resource];
+				resource.firstPass = std::min(resource.firstPass, i);
+				resource.lastPass = std::max(resource.lastPass, i);
+			}
+		}
+	}
+
+	void RenderGraph::createResources(){
+		std::vector<ResourceId> transients;
+
+		for (ResourceId id=0; id<resources.size(); id++){
+			Resource &resource = resources[id];
+
+			// the imported and the unused resources
+			if (resource.imported || resource.firstPass == ~0U) continue;
+
+			if (resource.isImage){
+				VkImageCreateInfo createInfo{};
+				createInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+				createInfo.imageType = VK_IMAGE_TYPE_2D;
+				createInfo.format = resource.format;
+				createInfo.extent = {resource.extent.width, resource.extent.height, 1};
+				createInfo.mipLevels = 1;
+				createInfo.arrayLayers = resource.layers;
+				createInfo.samples = resource.samples;
+				createInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+				createInfo.usage = resource.imageUsage;
+				createInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+				createInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+				if (vkCreateImage(device, &createInfo, nullptr, &resource.image) != VK_SUCCESS)
+					throw std::runtime_error("failed to create the image " + resource.name);
+			} else {
+				VkBufferCreateInfo createInfo{};
+				createInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+				createInfo.size = resource.size;
+				createInfo.usage = resource.bufferUsage;
+				createInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+				if (vkCreateBuffer(device, &createInfo, nullptr, &resource.buffer) != VK_SUCCESS)
+					throw std::runtime_error("failed to create the buffer " + resource.name);
+			}
+
+			transients.push_back(id);
+		}
+
+		allocateMemory(transients);
+
+		for (ResourceId id : transients){
+			Resource &resource = resources[id];
+			if (!resource.isImage) continue;
+
+			VkImageViewCreateInfo viewInfo{};
+			viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+			viewInfo.image = resource.image;
+			viewInfo.viewType = resource.layers > 1 ? VK_IMAGE_VIEW_TYPE_2D_ARRAY : VK_IMAGE_VIEW_TYPE_2D;
+			viewInfo.format = resource.format;
+			viewInfo.subresourceRange = {ImageStateTracker::getFormatAspect(resource.format), 0, 1, 0, resource.layers};
+
+			if (vkCreateImageView(device, &viewInfo, nullptr, &resource.view) != VK_SUCCESS)
+				throw std::runtime_error("failed to create the image view of " + resource.name);
+		}
+	}
+
+	void RenderGraph::allocateMemory(const std::vector<ResourceId> &transients){
+		std::vector<std::pair<ResourceId, VkMemoryRequirements>> requirements;
+		requirements.reserve(transients.size());
+
+		for (ResourceId id : transients){
+			VkMemoryRequirements memoryRequirements;
+			if (resources[id].isImage){
+				vkGetImageMemoryRequirements(device, resources[id].image, &memoryRequirements);
+			} else {
+				vkGetBufferMemoryRequirements(device, resources[id].buffer, &memoryRequirements);
+			}
+			requirements.push_back({id, memoryRequirements});
+		}
+
+		// the biggest resources first, the smaller ones then fit in their blocks
+		std::stable_sort(requirements.begin(), requirements.end(), [](const auto &a, const auto &b){return a.second.size > b.second.size;});
+
+		for (const auto &requirement : requirements){
+			Resource &resource = resources[requirement.first];
+
+			// a block whose resources are all used in other parts of the frame
+			for (size_t i=0; i<blocks.size() && resource.block == -1; i++){
+				MemoryBlock &block = blocks[i];
+				if (block.isImage != resource.isImage || (block.memoryTypeBits & requirement.second.memoryTypeBits) == 0) continue;
+
+				bool overlap = false;
+				for (ResourceId other : block.resources){
+					const Resource &aliased = resources[other];
+					overlap |= resource.firstPass <= aliased.lastPass && aliased.firstPass <= resource.lastPass;
+				}
+				if (overlap) continue;
+
+				block.size = std::max(block.size, requirement.second.size);
+				block.memoryTypeBits &= requirement.second.memoryTypeBits;
+				block.resources.push_back(requirement.first);
+				resource.block = static_cast<int>(i);
+			}
+
+			if (resource.block != -1) continue;
+
+			MemoryBlock block;
+			block.size = requirement.second.size;
+			block.memoryTypeBits = requirement.second.memoryTypeBits;
+			block.isImage = resource.isImage;
+			block.resources.push_back(requirement.first);
+			blocks.push_back(block);
+			resource.block = static_cast<int>(blocks.size() - 1);
+		}
+
+		for (auto &block : blocks){
+			VkMemoryAllocateInfo allocInfo{};
+			allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+			allocInfo.allocationSize = block.size;
+			allocInfo.memoryTypeIndex = device.getPhysicalDevice().findMemoryType(block.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+			if (vkAllocateMemory(device, &allocInfo, nullptr, &block.memory) != VK_SUCCESS)
+				throw std::runtime_error("failed to allocate the memory of the render graph");
+
+			for (ResourceId id : block.resources){
+				VkResult result = resources[id].isImage ? vkBindImageMemory(device, resources[id].image, block.memory, 0) : vkBindBufferMemory(device, resources[id].buffer, block.memory, 0);
+				if (result != VK_SUCCESS)
+					throw std::runtime_error("failed to bind the memory of " + resources[id].name);
+			}
+		}
+
+		// the first use of a resource waits for everything done on its memory, by the previous resources of the block or by the previous frame
+		for (const auto &pass : passes){
+			if (pass.culled) continue;
+
+			for (const auto &access : pass.accesses){
+				int block = resources[access.resource].block;
+				if (block == -1) continue;
+
+				blocks[block].stages |= access.stages;
+				if (access.write) blocks[block].writeAccess |= access.access & WRITE_ACCESS;
+			}
+		}
+	}
+
+	void RenderGraph::createRenderPasses(){
+		for (PassId id=0; id<passes.size(); id++){
+			Pass &pass = passes[id];
+			if (pass.culled || (pass.colorAttachments.empty() && pass.depthAttachment.resource == INVALID_RESOURCE)) continue;
+
+			std::vector<VkAttachmentDescription> attachments;
+			std::vector<VkAttachmentReference> colorReferences;
+			VkAttachmentReference depthReference{};
+
+			// the layouts are set by the barriers of the graph, the render pass does not transition them
+			for (const auto &attachment : pass.colorAttachments){
+				const Resource &resource = resources[attachment.resource];
+
+				VkAttachmentDescription description{};
+				description.format = resource.format;
+				description.samples = resource.samples;
+				description.loadOp = attachment.loadOp;
+				description.storeOp = isUsedAfter(attachment.resource, id) ? VK_ATTACHMENT_STORE_OP_STORE : VK_ATTACHMENT_STORE_OP_DONT_CARE;
+				description.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+				description.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+				description.initialLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+				description.finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+				colorReferences.push_back({static_cast<uint32_t>(attachments.size()), VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL});
+				attachments.push_back(description);
+			}
+
+			if (pass.depthAttachment.resource != INVALID_RESOURCE){
+				const Attachment &attachment = pass.depthAttachment;
+				const Resource &resource = resources[attachment.resource];
+				bool stencil = ImageStateTracker::getFormatAspect(resource.format) & VK_IMAGE_ASPECT_STENCIL_BIT;
+
+				VkAttachmentDescription description{};
+				description.format = resource.format;
+				description.samples = resource.samples;
+				description.loadOp = attachment.loadOp;
+				description.storeOp = isUsedAfter(attachment.resource, id) ? VK_ATTACHMENT_STORE_OP_STORE : VK_ATTACHMENT_STORE_OP_DONT_CARE;
+				description.stencilLoadOp = stencil ? description.loadOp : VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+				description.stencilStoreOp = stencil ? description.storeOp : VK_ATTACHMENT_STORE_OP_DONT_CARE;
+				description.initialLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+				description.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+				depthReference = {static_cast<uint32_t>(attachments.size()), VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL};
+				attachments.push_back(description);
+			}
+
+			VkSubpassDescription subpass{};
+			subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+			subpass.colorAttachmentCount = static_cast<uint32_t>(colorReferences.size());
+			subpass.pColorAttachments = colorReferences.data();
+			subpass.pDepthStencilAttachment = pass.depthAttachment.resource != INVALID_RESOURCE ? &depthReference : nullptr;
+
+			VkRenderPassCreateInfo createInfo{};
+			createInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+			createInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
+			createInfo.pAttachments = attachments.data();
+			createInfo.subpassCount = 1;
+			createInfo.pSubpasses = &subpass;
+
+			if (vkCreateRenderPass(device, &createInfo, nullptr, &pass.renderPass) != VK_SUCCESS)
+				throw std::runtime_error("failed to create the render pass of " + pass.name);
+		}
+	}
+
+	void RenderGraph::computeBarriers(){
+		std::vector<State> states(resources.size());
+
+		for (size_t i=0; i<resources.size(); i++){
+			const Resource &resource = resources[i];
+			State &state = states[i];
+
+			if (resource.imported){
+				state.layout = resource.initialLayout;
+				state.writeStages = resource.initialStage;
+				state.writeAccess = resource.initialAccess;
+			} else if (resource.block != -1){
+				state.writeStages = blocks[resource.block].stages;
+				state.writeAccess = blocks[resource.block].writeAccess;
+			}
+		}
+
+		for (auto &pass : passes){
+			pass.barriers = {};
+			if (pass.culled) continue;
+
+			for (const auto &access : pass.accesses)
+				addBarrier(pass.barriers, states[access.resource], access);
+		}
+
+		// the imported images are left in their final layout
+		finalBarriers = {};
+		for (ResourceId id=0; id<resources.size(); id++){
+			const Resource &resource = resources[id];
+			const State &state = states[id];
+			if (!resource.imported || !resource.isImage || resource.finalLayout == VK_IMAGE_LAYOUT_UNDEFINED || resource.finalLayout == state.layout) continue;
+
+			// the next uses of the image are synchronized by the user (the present semaphore for a swap chain image)
+			VkImageMemoryBarrier2KHR barrier{};
+			barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2_KHR;
+			barrier.srcStageMask = state.writeStages | state.readStages;
+			barrier.srcAccessMask = state.writeAccess;
+			barrier.dstStageMask = VK_PIPELINE_STAGE_2_NONE_KHR;
+			barrier.dstAccessMask = VK_ACCESS_2_NONE_KHR;
+			barrier.oldLayout = state.layout;
+			barrier.newLayout = resource.finalLayout;
+			barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier.subresourceRange = {ImageStateTracker::getFormatAspect(resource.format), 0, VK_REMAINING_MIP_LEVELS, 0, VK_REMAINING_ARRAY_LAYERS};
+
+			finalBarriers.images.push_back({id, barrier});
+		}
+	}
+
+	void RenderGraph::addBarrier(Barriers &barriers, State &state, const Access &access){
+		const Resource &resource = resources[access.resource];
+		bool transition = resource.isImage && access.layout != state.layout;
+
+		VkPipelineStageFlags srcStages = 0;
+		VkAccessFlags srcAccess = 0;
+		bool needed = false;
+
+		if (access.write || transition){
+			// wait for all the previous accesses, the reads included
+			srcStages = state.writeStages | state.readStages;
+			srcAccess = state.writeAccess;
+			needed = transition || srcStages != 0;
+		} else if (state.writeStages != 0 && ((access.stages & ~state.visibleStages) || (access.access & ~state.visibleAccess))){
+			// a read of the last write, not yet synchronized for these stages
+			srcStages = state.writeStages;
+			srcAccess = state.writeAccess;
+			needed = true;
+		}
+
+		// each barrier waits for its own stages, an empty source scope is VK_PIPELINE_STAGE_2_NONE_KHR (top of pipe without synchronization2)
+		if (needed && resource.isImage){
+			VkImageMemoryBarrier2KHR barrier{};
+			barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2_KHR;
+			barrier.srcStageMask = srcStages;
+			barrier.srcAccessMask = srcAccess;
+			barrier.dstStageMask = access.stages;
+			barrier.dstAccessMask = access.access;
+			barrier.oldLayout = state.layout;
+			barrier.newLayout = access.layout;
+			barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier.subresourceRange = {ImageStateTracker::getFormatAspect(resource.format), 0, VK_REMAINING_MIP_LEVELS, 0, VK_REMAINING_ARRAY_LAYERS};
+			barriers.images.push_back({access.resource, barrier});
+
+		} else if (needed){
+			VkBufferMemoryBarrier2KHR barrier{};
+			barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2_KHR;
+			barrier.srcStageMask = srcStages;
+			barrier.srcAccessMask = srcAccess;
+			barrier.dstStageMask = access.stages;
+			barrier.dstAccessMask = access.access;
+			barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier.offset = 0;
+			barrier.size = VK_WHOLE_SIZE;
+			barriers.buffers.push_back({access.resource, barrier});
+		}
+
+		if (access.write){
+			state.layout = access.layout;
+			state.writeStages = access.stages;
+			state.writeAccess = access.access & WRITE_ACCESS;
+			state.readStages = 0;
+			state.visibleStages = 0;
+			state.visibleAccess = 0;
+		} else if (transition){
+			// the transition is the last write, the following reads of other stages chain with the stages of this one
+			state.layout = access.layout;
+			state.writeStages = access.stages;
+			state.writeAccess = 0;
+			state.readStages = access.stages;
+			state.visibleStages = access.stages;
+			state.visibleAccess = access.access;
+		} else {
+			state.readStages |= access.stages;
+			if (needed){
+				state.visibleStages |= access.stages;
+				state.visibleAccess |= access.access;
+			}
+		}
+	}
+
+	void RenderGraph::Barriers::record(VkCommandBuffer commandBuffer, const std::vector<Resource> &resources, const Synchronization2 *synchronization2) const{
+		if (images.empty() && buffers.empty()) return;
+
+		// the imported handles may change between two executions
+		std::vector<VkImageMemoryBarrier2KHR> imageBarriers;
+		imageBarriers.reserve(images.size());
+		for (const auto &image : images){
+			imageBarriers.push_back(image.barrier);
+			imageBarriers.back().image = resources[image.resource].image;
+		}
+
+		std::vector<VkBufferMemoryBarrier2KHR> bufferBarriers;
+		bufferBarriers.reserve(buffers.size());
+		for (const auto &buffer : buffers){
+			bufferBarriers.push_back(buffer.barrier);
+			bufferBarriers.back().buffer = resources[buffer.resource].buffer;
+		}
+
+		VkDependencyInfoKHR dependency{};
+		dependency.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO_KHR;
+		dependency.bufferMemoryBarrierCount = static_cast<uint32_t>(bufferBarriers.size());
+		dependency.pBufferMemoryBarriers = bufferBarriers.data();
+		dependency.imageMemoryBarrierCount = static_cast<uint32_t>(imageBarriers.size());
+		dependency.pImageMemoryBarriers = imageBarriers.data();
+
+		if (synchronization2){
+			synchronization2->pipelineBarrier(commandBuffer, dependency);
+		} else {
+			Synchronization2::legacyPipelineBarrier(commandBuffer, dependency);
+		}
+	}
+
+	void RenderGraph::execute(VkCommandBuffer commandBuffer){
+		assert(compiled && "cannot execute a graph before the compilation");
+
+		for (auto &pass : passes){
+			if (pass.culled) continue;
+
+			pass.barriers.record(commandBuffer, resources, synchronization2);
+
+			if (pass.renderPass == VK_NULL_HANDLE){
+				pass.execute(commandBuffer);
+				continue;
+			}
+
+			const Resource &first = resources[pass.colorAttachments.empty() ? pass.depthAttachment.resource : pass.colorAttachments.front().resource];
+
+			std::vector<VkClearValue> clearValues;
+			for (const auto &attachment : pass.colorAttachments)
+				clearValues.push_back(attachment.clearValue);
+
+			if (pass.depthAttachment.resource != INVALID_RESOURCE)
+				clearValues.push_back(pass.depthAttachment.clearValue);
+
+			VkRenderPassBeginInfo beginInfo{};
+			beginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+			beginInfo.renderPass = pass.renderPass;
+			beginInfo.framebuffer = getFramebuffer(pass);
+			beginInfo.renderArea.offset = {0, 0};
+			beginInfo.renderArea.extent = first.extent;
+			beginInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
+			beginInfo.pClearValues = clearValues.data();
+
+			vkCmdBeginRenderPass(commandBuffer, &beginInfo, VK_SUBPASS_CONTENTS_INLINE);
+
+			VkViewport viewport{0.f, 0.f, static_cast<float>(first.extent.width), static_cast<float>(first.extent.height), 0.f, 1.f};
+			VkRect2D scissor{{0, 0}, first.extent};
+			vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+			vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+
+			pass.execute(commandBuffer);
+			vkCmdEndRenderPass(commandBuffer);
+		}
+
+		finalBarriers.record(commandBuffer, resources, synchronization2);
+	}
+
+	VkFramebuffer RenderGraph::getFramebuffer(Pass &pass){
+		std::vector<VkImageView> views;
+		for (const auto &attachment : pass.colorAttachments)
+			views.push_back(resources[attachment.resource].view);
+
+		if (pass.depthAttachment.resource != INVALID_RESOURCE)
+			views.push_back(resources[pass.depthAttachment.resource].view);
+
+		auto it = pass.framebuffers.find(views);
+		if (it != pass.framebuffers.end()) return it->second;
+
+		const Resource &first = resources[pass.colorAttachments.empty() ? pass.depthAttachment.resource : pass.colorAttachments.front().resource];
+
+		VkFramebufferCreateInfo createInfo{};
+		createInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+		createInfo.renderPass = pass.renderPass;
+		createInfo.attachmentCount = static_cast<uint32_t>(views.size());
+		createInfo.pAttachments = views.data();
+		createInfo.width = first.extent.width;
+		createInfo.height = first.extent.height;
+		createInfo.layers = 1;
+
+		VkFramebuffer framebuffer;
+		if (vkCreateFramebuffer(device, &createInfo, nullptr, &framebuffer) != VK_SUCCESS)
+			throw std::runtime_error("failed to create the framebuffer of " + pass.name);
+
+		pass.framebuffers[views] = framebuffer;
+		return framebuffer;
+	}
+
+	void RenderGraph::clear(){
+		for (auto &pass : passes){
+			for (auto &framebuffer : pass.framebuffers)
+				vkDestroyFramebuffer(device, framebuffer.second, nullptr);
+
+			if (pass.renderPass != VK_NULL_HANDLE) vkDestroyRenderPass(device, pass.renderPass, nullptr);
+		}
+
+		for (auto &resource : resources){
+			if (resource.imported) continue;
+
+			// the descriptor sets cached with the resources are freed by the callbacks
+			device.notifyDestroyed(resource.view);
+			device.notifyDestroyed(resource.image);
+			device.notifyDestroyed(resource.buffer);
+
+			if (resource.view != VK_NULL_HANDLE) vkDestroyImageView(device, resource.view, nullptr);
+			if (resource.image != VK_NULL_HANDLE) vkDestroyImage(device, resource.image, nullptr);
+			if (resource.buffer != VK_NULL_HANDLE) vkDestroyBuffer(device, resource.buffer, nullptr);
+		}
+
+		for (auto &block : blocks){
+			if (block.memory != VK_NULL_HANDLE) vkFreeMemory(device, block.memory, nullptr);
+		}
+
+		resources.clear();
+		passes.clear();
+		blocks.clear();
+		finalBarriers = {};
+		compiled = false;
+	}
+
+	VkRenderPass RenderGraph::getRenderPass(PassId pass) const{
+		assert(pass < passes.size() && "invalid pass");
+		return passes[pass].renderPass;
+	}
+
+	bool RenderGraph::isCulled(PassId pass) const{
+		assert(pass < passes.size() && "invalid pass");
+		return passes[pass].culled;
+	}
+
+	VkImage RenderGraph::getImage(ResourceId image) const{
+		assert(image < resources.size() && resources[image].isImage && "the resource is not an image");
+		return resources[image].image;
+	}
+
+	VkImageView RenderGraph::getImageView(ResourceId image) const{
+		assert(image < resources.size() && resources[image].isImage && "the resource is not an image");
+		return resources[image].view;
+	}
+
+	VkBuffer RenderGraph::getBuffer(ResourceId buffer) const{
+		assert(buffer < resources.size() && !resources[buffer].isImage && "the resource is not a buffer");
+		return resources[buffer].buffer;
+	}
+
+	bool RenderGraph::isUsedAfter(ResourceId resource, PassId pass) const{
+		const Resource &used = resources[resource];
+		return used.output || used.lastPass > pass;
+	}
+}
\ No newline at end of file
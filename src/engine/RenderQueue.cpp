@@ -0,0 +1,325 @@
+#include "engine/RenderQueue.hpp"
+#include "engine/Hash.hpp"
+
+// std
+#include <cassert>
+#include <stdexcept>
+#include <cstring>
+#include <algorithm>
+#include <array>
+#include <future>
+
+namespace vk_engine{
+	namespace{
+		// below this count the sort is faster on the calling thread
+		constexpr size_t PARALLEL_SORT_THRESHOLD = 16384;
+		constexpr size_t MIN_CHUNK_SIZE = 4096;
+
+		template<typename F> void forEachChunk(ThreadPool *threadPool, uint32_t chunkCount, const F &task){
+			if (chunkCount == 1){
+				task(0);
+				return;
+			}
+
+			std::vector<std::future<void>> tasks;
+			tasks.reserve(chunkCount);
+
+			for (uint32_t i=0; i<chunkCount; i++)
+				tasks.push_back(threadPool->submit([&task, i](){task(i);}));
+
+			// the tasks reference the locals of the caller, wait for all of them before rethrowing
+			for (auto &chunk : tasks)
+				chunk.wait();
+
+			for (auto &chunk : tasks)
+				chunk.get();
+		}
+	}
+
+	RenderQueue::RenderQueue(LogicalDevice &device) : device{device}{}
+
+	void RenderQueue::build(){
+		assert(framesInFlight > 0 && "cannot build a render queue without frames");
+
+		instanceBuffers.clear();
+		if (instanceCapacity == 0) return;
+
+		for (uint32_t i=0; i<framesInFlight; i++){
+			auto buffer = std::make_unique<Buffer>(device, sizeof(glm::mat4), instanceCapacity, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+
+			if (buffer->map() != VK_SUCCESS)
+				throw std::runtime_error("failed to map the instance buffer");
+
+			instanceBuffers.push_back(std::move(buffer));
+		}
+	}
+
+	void RenderQueue::beginFrame(uint32_t frameIndex){
+		assert((instanceBuffers.empty() || frameIndex < instanceBuffers.size()) && "invalid frame index");
+
+		clear();
+		currentFrame = frameIndex;
+		instanceCount = 0;
+	}
+
+	void RenderQueue::push(uint64_t key, const Draw &draw){
+		assert(draw.pipeline != nullptr && "cannot push a draw without pipeline");
+
+		items.push_back({key, static_cast<uint32_t>(draws.size()), NO_TRANSFORM});
+		draws.push_back(draw);
+		sorted = false;
+	}
+
+	void RenderQueue::push(const Draw &draw, uint32_t pass, float depth, bool backToFront){
+		uint32_t quantized = quantizeDepth(depth);
+		if (backToFront) quantized = ((1U << DEPTH_BITS) - 1) - quantized;
+
+		push(makeKey(pass, getPipelineId(draw.pipeline), getMaterialId(draw.descriptorSet), quantized), draw);
+	}
+
+	void RenderQueue::push(const Draw &draw, const glm::mat4 &transform, uint32_t pass, float depth, bool backToFront){
+		assert(instanceCapacity > 0 && "cannot push an instance without instance capacity");
+		assert(draw.instanceCount == 1 && draw.firstInstance == 0 && "an instanced draw must have a single instance");
+
+		uint32_t depthField = getMeshId(draw);
+		if (backToFront) depthField = ((1U << DEPTH_BITS) - 1) - quantizeDepth(depth);
+
+		push(makeKey(pass, getPipelineId(draw.pipeline), getMaterialId(draw.descriptorSet), depthField), draw);
+
+		items.back().transform = static_cast<uint32_t>(transforms.size());
+		transforms.push_back(transform);
+	}
+
+	void RenderQueue::sort(){
+		if (sorted) return;
+
+		const size_t count = items.size();
+		sortBuffer.resize(count);
+
+		uint32_t chunkCount = 1;
+		if (threadPool && count >= PARALLEL_SORT_THRESHOLD && ThreadPool::getWorkerIndex() == ThreadPool::NO_WORKER)
+			chunkCount = static_cast<uint32_t>(std::max<size_t>(1, std::min<size_t>(threadPool->getThreadCount(), count / MIN_CHUNK_SIZE)));
+
+		const size_t chunkSize = (count + chunkCount - 1) / chunkCount;
+
+		// the bits set in differing vary between the keys, the digits without them are already sorted
+		std::vector<uint64_t> chunkDiffering(chunkCount, 0);
+		forEachChunk(threadPool, chunkCount, [&](uint32_t chunk){
+			const size_t begin = chunk * chunkSize;
+			const size_t end = std::min(count, begin + chunkSize);
+			const uint64_t first = items[0].key;
+
+			uint64_t bits = 0;
+			for (size_t i=begin; i<end; i++)
+				bits |= items[i].key ^ first;
+
+			chunkDiffering[chunk] = bits;
+		});
+
+		uint64_t differing = 0;
+		for (uint64_t bits : chunkDiffering)
+			differing |= bits;
+
+		// least significant digit first, each pass is stable
+		std::vector<std::array<uint32_t, 256>> histograms(chunkCount);
+		Item *source = items.data();
+		Item *destination = sortBuffer.data();
+
+		for (uint32_t shift=0; shift<64; shift+=8){
+			if (((differing >> shift) & 0xFF) == 0) continue;
+
+			forEachChunk(threadPool, chunkCount, [&](uint32_t chunk){
+				const size_t begin = chunk * chunkSize;
+				const size_t end = std::min(count, begin + chunkSize);
+
+				auto &histogram = histograms[chunk];
+				histogram.fill(0);
+
+				for (size_t i=begin; i<end; i++)
+					histogram[(source[i].key >> shift) & 0xFF]++;
+			});
+
+			// the items of a digit are placed chunk after chunk to keep the order
+			uint32_t offset = 0;
+			for (uint32_t digit=0; digit<256; digit++){
+				for (auto &histogram : histograms){
+					uint32_t digitCount = histogram[digit];
+					histogram[digit] = offset;
+					offset += digitCount;
+				}
+			}
+
+			forEachChunk(threadPool, chunkCount, [&](uint32_t chunk){
+				const size_t begin = chunk * chunkSize;
+				const size_t end = std::min(count, begin + chunkSize);
+
+				auto &histogram = histograms[chunk];
+				for (size_t i=begin; i<end; i++)
+					destination[histogram[(source[i].key >> shift) & 0xFF]++] = source[i];
+			});
+
+			std::swap(source, destination);
+		}
+
+		if (source != items.data()) items.swap(sortBuffer);
+		sorted = true;
+	}
+
+	void RenderQueue::submit(VkCommandBuffer commandBuffer){
+		assert(sorted && "cannot submit a render queue before the sort");
+		record(commandBuffer, 0, items.size());
+	}
+
+	void RenderQueue::submit(VkCommandBuffer commandBuffer, uint32_t pass){
+		assert(sorted && "cannot submit a render queue before the sort");
+
+		auto begin = std::lower_bound(items.begin(), items.end(), pass, [](const Item &item, uint32_t pass){return getPass(item.key) < pass;});
+		auto end = std::upper_bound(begin, items.end(), pass, [](uint32_t pass, const Item &item){return pass < getPass(item.key);});
+
+		record(commandBuffer, begin - items.begin(), end - items.begin());
+	}
+
+	void RenderQueue::record(VkCommandBuffer commandBuffer, size_t begin, size_t end){
+		BoundState bound;
+
+		for (size_t i=begin; i<end; i++){
+			const Draw &draw = draws[items[i].draw];
+
+			// the run of instances of the same mesh and material, a single draw without transform otherwise
+			uint32_t instanceCount = draw.instanceCount;
+			uint32_t firstInstance = draw.firstInstance;
+			size_t runEnd = i + 1;
+
+			if (items[i].transform != NO_TRANSFORM){
+				runEnd = writeInstances(i, end, firstInstance);
+				instanceCount = static_cast<uint32_t>(runEnd - i);
+			}
+
+			if (draw.pipeline != bound.pipeline){
+				draw.pipeline->bind(commandBuffer);
+				stats.pipelineBinds++;
+
+				// the sets stay bound with a compatible layout, the material set is rebound otherwise
+				VkPipelineLayout layout = draw.pipeline->getPipelineLayout();
+				if (layout != bound.layout) bound.descriptorSet = VK_NULL_HANDLE;
+
+				bound.pipeline = draw.pipeline;
+				bound.layout = layout;
+			}
+
+			if (draw.descriptorSet != VK_NULL_HANDLE && draw.descriptorSet != bound.descriptorSet){
+				vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, bound.layout, materialSet, 1, &draw.descriptorSet, 0, nullptr);
+				stats.descriptorSetBinds++;
+				bound.descriptorSet = draw.descriptorSet;
+			}
+
+			if (draw.vertexBuffer != VK_NULL_HANDLE && (draw.vertexBuffer != bound.vertexBuffer || draw.vertexBufferOffset != bound.vertexBufferOffset)){
+				vkCmdBindVertexBuffers(commandBuffer, 0, 1, &draw.vertexBuffer, &draw.vertexBufferOffset);
+				stats.vertexBufferBinds++;
+				bound.vertexBuffer = draw.vertexBuffer;
+				bound.vertexBufferOffset = draw.vertexBufferOffset;
+			}
+
+			if (draw.indexBuffer == VK_NULL_HANDLE){
+				vkCmdDraw(commandBuffer, draw.count, instanceCount, draw.first, firstInstance);
+				stats.draws++;
+				i = runEnd - 1;
+				continue;
+			}
+
+			if (draw.indexBuffer != bound.indexBuffer || draw.indexBufferOffset != bound.indexBufferOffset || draw.indexType != bound.indexType){
+				vkCmdBindIndexBuffer(commandBuffer, draw.indexBuffer, draw.indexBufferOffset, draw.indexType);
+				stats.indexBufferBinds++;
+				bound.indexBuffer = draw.indexBuffer;
+				bound.indexBufferOffset = draw.indexBufferOffset;
+				bound.indexType = draw.indexType;
+			}
+
+			vkCmdDrawIndexed(commandBuffer, draw.count, instanceCount, draw.first, draw.vertexOffset, firstInstance);
+			stats.draws++;
+			i = runEnd - 1;
+		}
+	}
+
+	size_t RenderQueue::writeInstances(size_t begin, size_t end, uint32_t &firstInstance){
+		assert(!instanceBuffers.empty() && "cannot record instances before the build");
+		const Draw &draw = draws[items[begin].draw];
+
+		size_t runEnd = begin + 1;
+		while (runEnd < end && items[runEnd].transform != NO_TRANSFORM && sameMesh(draw, draws[items[runEnd].draw]))
+			runEnd++;
+
+		uint32_t count = static_cast<uint32_t>(runEnd - begin);
+		if (instanceCount + count > instanceCapacity)
+			throw std::runtime_error("failed to write the instances, the instance capacity is too small");
+
+		// the transforms of a run are consecutive, gl_InstanceIndex starts at the first instance of the draw
+		glm::mat4 *mapped = static_cast<glm::mat4*>(instanceBuffers[currentFrame]->getMappedMemory()) + instanceCount;
+		for (size_t i=begin; i<runEnd; i++)
+			std::memcpy(mapped++, &transforms[items[i].transform], sizeof(glm::mat4));
+
+		firstInstance = instanceCount;
+		instanceCount += count;
+		stats.instances += count;
+		return runEnd;
+	}
+
+	void RenderQueue::clear(){
+		draws.clear();
+		items.clear();
+		transforms.clear();
+		sorted = true;
+		stats = {};
+
+		pipelineIds.clear();
+		materialIds.clear();
+		meshIds.clear();
+	}
+
+	uint32_t RenderQueue::getPipelineId(const Pipeline *pipeline){
+		// the ids only wrap past the bits of the field with more pipelines in a frame, the draws stay sorted but their grouping is lost
+		auto it = pipelineIds.emplace(pipeline, static_cast<uint32_t>(pipelineIds.size()) & ((1U << PIPELINE_BITS) - 1)).first;
+		return it->second;
+	}
+
+	uint32_t RenderQueue::getMaterialId(VkDescriptorSet descriptorSet){
+		auto it = materialIds.emplace(LogicalDevice::getHandleKey(descriptorSet), static_cast<uint32_t>(materialIds.size()) & ((1U << MATERIAL_BITS) - 1)).first;
+		return it->second;
+	}
+
+	uint32_t RenderQueue::getMeshId(const Draw &draw){
+		uint64_t hash = HASH_SEED;
+		hashCombine(hash, LogicalDevice::getHandleKey(draw.vertexBuffer));
+		hashCombine(hash, draw.vertexBufferOffset);
+		hashCombine(hash, LogicalDevice::getHandleKey(draw.indexBuffer));
+		hashCombine(hash, draw.indexBufferOffset);
+		hashCombine(hash, draw.count);
+		hashCombine(hash, draw.first);
+		hashCombine(hash, draw.vertexOffset);
+
+		// a collision only groups two meshes together, the runs compare the draws
+		auto it = meshIds.emplace(hash, static_cast<uint32_t>(meshIds.size()) & ((1U << DEPTH_BITS) - 1)).first;
+		return it->second;
+	}
+
+	bool RenderQueue::sameMesh(const Draw &a, const Draw &b) noexcept{
+		return a.pipeline == b.pipeline && a.descriptorSet == b.descriptorSet && a.vertexBuffer == b.vertexBuffer && a.vertexBufferOffset == b.vertexBufferOffset &&
+			a.indexBuffer == b.indexBuffer && a.indexBufferOffset == b.indexBufferOffset && a.indexType == b.indexType && a.count == b.count && a.first == b.first &&
+			a.vertexOffset == b.vertexOffset;
+	}
+
+	uint64_t RenderQueue::makeKey(uint32_t pass, uint32_t pipeline, uint32_t material, uint32_t depth) noexcept{
+		assert(pass < (1U << PASS_BITS) && "the pass does not fit in the key");
+		assert(pipeline < (1U << PIPELINE_BITS) && "the pipeline id does not fit in the key");
+		assert(material < (1U << MATERIAL_BITS) && "the material id does not fit in the key");
+		assert(depth < (1U << DEPTH_BITS) && "the depth does not fit in the key");
+
+		return (static_cast<uint64_t>(pass) << PASS_SHIFT) | (static_cast<uint64_t>(pipeline) << PIPELINE_SHIFT) |
+			(static_cast<uint64_t>(material) << MATERIAL_SHIFT) | (static_cast<uint64_t>(depth) << DEPTH_SHIFT);
+	}
+
+	uint32_t RenderQueue::quantizeDepth(float depth) noexcept{
+		depth = std::min(std::max(depth, 0.f), 1.f);
+		return static_cast<uint32_t>(depth * static_cast<float>((1U << DEPTH_BITS) - 1));
+	}
+}
\ No newline at end of file
@@ -8,7 +8,7 @@
 #include <cmath>
 
 namespace vk_engine{
-	Renderer::Renderer(LogicalDevice &device, CommandPool &commandPool) : device{device}, commandPool{commandPool}{
+	Renderer::Renderer(LogicalDevice &device, CommandPool &commandPool) : device{device}, commandPool{commandPool}, imageStates{device}, descriptorAllocator{device}{
 		recreateSwapChain();
 		viewport.x = 0.0f;
 		viewport.y = 0.0f;
@@ -22,31 +22,40 @@ namespace vk_engine{
 		scissor.extent = {1, 1};
 	}
 
-	Renderer::~Renderer(){
-		freeCommandBuffers();
-	}
+	Renderer::~Renderer(){}
 
 	void Renderer::build(){
 		swapChain->build();
-		createCommandBuffers();
-	}
+		trackSwapChainImages();
+		createFramePools();
 
-	void Renderer::createCommandBuffers(){
-		commandBuffers.resize(swapChain->getFramesInFlight());
+		descriptorAllocator.setFramesInFlight(swapChain->getFramesInFlight());
+		descriptorAllocator.build();
 
-		VkCommandBufferAllocateInfo allocInfo{};
-		allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-		allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-		allocInfo.commandPool = commandPool;
-		allocInfo.commandBufferCount = static_cast<uint32_t>(commandBuffers.size());
+		if (parallelRecorder){
+			parallelRecorder->setFamily(commandPool.getFamily());
+			parallelRecorder->setFramesInFlight(swapChain->getFramesInFlight());
+			parallelRecorder->build();
+		}
+	}
 
-		if (vkAllocateCommandBuffers(device, &allocInfo, commandBuffers.data()) != VK_SUCCESS)
-			throw std::runtime_error("failed to allocate command buffers");
+	void Renderer::setSynchronization2(const Synchronization2 &synchronization2){
+		swapChain->setSynchronization2(&synchronization2);
+		imageStates.setSynchronization2(synchronization2);
 	}
 
-	void Renderer::freeCommandBuffers(){
-		vkFreeCommandBuffers(device, commandPool, static_cast<uint32_t>(commandBuffers.size()), commandBuffers.data());
-		commandBuffers.clear();
+	void Renderer::setThreadPool(ThreadPool &threadPool){
+		parallelRecorder = std::make_unique<ParallelRecorder>(device, threadPool);
+	}
+
+	void Renderer::createFramePools(){
+		framePools.resize(swapChain->getFramesInFlight());
+
+		for (auto &framePool : framePools){
+			framePool = std::make_unique<FrameCommandPool>(device);
+			framePool->setFamily(commandPool.getFamily());
+			framePool->build();
+		}
 	}
 
 	void Renderer::recreateSwapChain(){
@@ -68,7 +77,9 @@ namespace vk_engine{
 			// set properties
 			swapChain->setRefreshType(oldSwapChain->getRefreshType());
 			swapChain->setSurfaceFormat(oldSwapChain->getWantedFormat());
+			swapChain->setSynchronization2(oldSwapChain->getSynchronization2());
 			swapChain->build();
+			trackSwapChainImages();
 
 			if (!oldSwapChain->compareSwapFormats(*swapChain.get()))
 				throw std::runtime_error("swap chain image or depth format has changed");
@@ -81,6 +92,11 @@ namespace vk_engine{
 		}
 	}
 
+	void Renderer::trackSwapChainImages(){
+		for (size_t i=0; i<swapChain->imageCount(); i++)
+			imageStates.add(swapChain->getImage(static_cast<int>(i)), VK_IMAGE_ASPECT_COLOR_BIT);
+	}
+
 	VkCommandBuffer Renderer::beginFrame(){
 		assert(!isFrameStarted && "Can't call beginFrame while already in progress");
 
@@ -96,9 +112,22 @@ namespace vk_engine{
 
 		isFrameStarted = true;
 
+		// the content of the acquired image is discarded, the acquire semaphore is waited at the color output stage
+		imageStates.setState(swapChain->getImage(static_cast<int>(currentImageIndex)), {VK_IMAGE_LAYOUT_UNDEFINED, 0, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT});
+
+		// the fence of the frame has been waited by the swap chain, the descriptor sets of the previous use of the frame are free
+		descriptorAllocator.beginFrame(currentFrameIndex);
+		if (bindlessTable) bindlessTable->beginFrame();
+		if (parallelRecorder) parallelRecorder->beginFrame(currentFrameIndex);
+
+		FrameCommandPool &framePool = *framePools[currentFrameIndex];
+		framePool.reset();
+		currentCommandBuffer = framePool.get();
+
 		auto commandBuffer = getCurrentCommandBuffer();
 		VkCommandBufferBeginInfo beginInfo{};
 		beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+		beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
 
 		if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS) {
 			throw std::runtime_error("failed to begin recording command buffer!");
@@ -110,6 +139,10 @@ namespace vk_engine{
 		assert(isFrameStarted && "can't call endFrame while frame isn't in progress");
 		VkCommandBuffer commandBuffer = getCurrentCommandBuffer();
 
+		// nothing is recorded if the last use of the image was the swap chain render pass
+		imageStates.require(swapChain->getImage(static_cast<int>(currentImageIndex)), VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+		imageStates.flush(commandBuffer);
+
 		if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS)
 			throw std::runtime_error("failed to record command buffer");
 		
@@ -127,7 +160,7 @@ namespace vk_engine{
 		currentFrameIndex = (currentFrameIndex + 1) % swapChain->getFramesInFlight();
 	}
 
-	void Renderer::beginSwapChainRenderPass(VkCommandBuffer commandBuffer){
+	void Renderer::beginSwapChainRenderPass(VkCommandBuffer commandBuffer, VkSubpassContents contents){
 		assert(isFrameStarted && "Can't call beginSwapChainRenderPass if frame isn't in progress");
 		assert(commandBuffer == getCurrentCommandBuffer() && "Can't begin render pass on command buffer from a different frame");
 		
@@ -147,22 +180,64 @@ namespace vk_engine{
 		renderPassBeginInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
 		renderPassBeginInfo.pClearValues = clearValues.data();
 
-		vkCmdBeginRenderPass(commandBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
-
 		viewport.width = static_cast<float>(swapChain->getSwapChainExtent().width);
 		viewport.height = static_cast<float>(swapChain->getSwapChainExtent().height);
 		scissor.extent = swapChain->getSwapChainExtent();
 
-		vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
-		vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+		vkCmdBeginRenderPass(commandBuffer, &renderPassBeginInfo, contents);
+
+		// only vkCmdExecuteCommands is allowed in a subpass with secondary contents, the states are set in the secondary command buffers
+		if (contents == VK_SUBPASS_CONTENTS_INLINE){
+			vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+			vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+		}
+	}
+
+	void Renderer::recordSwapChainRenderPass(VkCommandBuffer commandBuffer, uint32_t taskCount, const ParallelRecorder::Task &task){
+		assert(isFrameStarted && "Can't call recordSwapChainRenderPass if frame isn't in progress");
+		assert(parallelRecorder && "the parallel recording requires a thread pool");
+
+		VkCommandBufferInheritanceInfo inheritanceInfo{};
+		inheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+		inheritanceInfo.renderPass = swapChain->getRenderPass();
+		inheritanceInfo.subpass = 0;
+		inheritanceInfo.framebuffer = swapChain->getFrameBuffer(currentImageIndex);
+
+		// the dynamic states are not inherited
+		parallelRecorder->record(commandBuffer, inheritanceInfo, taskCount, [this, &task](VkCommandBuffer secondaryCommandBuffer, uint32_t index){
+			vkCmdSetViewport(secondaryCommandBuffer, 0, 1, &viewport);
+			vkCmdSetScissor(secondaryCommandBuffer, 0, 1, &scissor);
+			task(secondaryCommandBuffer, index);
+		});
 	}
 
 	void Renderer::endSwapChainRenderPass(VkCommandBuffer commandBuffer){
 		assert(isFrameStarted && "Can't call endSwapChainRenderPass if frame isn't in progress");
 		assert(commandBuffer == getCurrentCommandBuffer() && "Can't end render pass on command buffer from a different frame");
 		vkCmdEndRenderPass(commandBuffer);
+
+		// the final layout of the render pass
+		imageStates.setState(swapChain->getImage(static_cast<int>(currentImageIndex)), {VK_IMAGE_LAYOUT_PRESENT_SRC_KHR, VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT});
 	}
 	
+	void Renderer::pushDescriptorSet(VkCommandBuffer commandBuffer, const Pipeline &pipeline, std::vector<VkWriteDescriptorSet> writes){
+		assert(isFrameStarted && "Cannot push descriptors whene frame not in progress");
+		assert(pipeline.getPushSet() != Pipeline::NO_PUSH_SET && "the pipeline has no push set");
+
+		if (pushDescriptor && pushDescriptor->isSupported()){
+			pushDescriptor->push(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline.getPipelineLayout(), pipeline.getPushSet(), writes);
+			return;
+		}
+
+		// the fallback, a transient set valid for the frame
+		VkDescriptorSet set = descriptorAllocator.allocate(pipeline.getPushSetLayout());
+		for (auto &write : writes)
+			write.dstSet = set;
+
+		vkUpdateDescriptorSets(device, static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+		vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline.getPipelineLayout(), pipeline.getPushSet(), 1, &set, 0, nullptr);
+	}
+
 	void Renderer::setClearColor(const float &r, const float &g, const float &b, const float &a) noexcept{
 		clearColor.float32[0] = r;
 		clearColor.float32[1] = g;
@@ -0,0 +1,77 @@
+#include "engine/ShaderArchive.hpp"
+#include "engine/Hash.hpp"
+
+// std
+#include <stdexcept>
+#include <algorithm>
+
+namespace vk_engine{
+	std::string ShaderArchive::getVariantName(const std::string &name, std::vector<std::string> keywords){
+		std::sort(keywords.begin(), keywords.end());
+		keywords.erase(std::unique(keywords.begin(), keywords.end()), keywords.end());
+
+		std::string variantName = name;
+		for (const auto &keyword : keywords)
+			variantName += "|" + keyword;
+
+		return variantName;
+	}
+
+	uint64_t ShaderArchive::getKey(const std::string &variantName) noexcept{
+		uint64_t key = hashBytes(variantName.data(), variantName.size());
+
+		// 0 marks the empty slots
+		return key == 0 ? 1 : key;
+	}
+
+	ShaderArchive::ShaderArchive(const std::string &filepath){
+		open(filepath);
+	}
+
+	void ShaderArchive::open(const std::string &filepath){
+		header = nullptr;
+		slots = nullptr;
+		file.open(filepath);
+
+		if (file.size() < sizeof(Header))
+			throw std::runtime_error("invalid shader archive : " + filepath);
+
+		const Header *fileHeader = file.as<Header>();
+		if (fileHeader->magic != MAGIC || fileHeader->version != ARCHIVE_VERSION)
+			throw std::runtime_error("invalid shader archive : " + filepath);
+
+		uint32_t slotCount = fileHeader->slotCount;
+		if (slotCount == 0 || (slotCount & (slotCount - 1)) != 0 || file.size() < sizeof(Header) + slotCount * sizeof(Slot))
+			throw std::runtime_error("corrupted shader archive : " + filepath);
+
+		header = fileHeader;
+		slots = file.as<Slot>(sizeof(Header));
+	}
+
+	bool ShaderArchive::find(const std::string &variantName, const uint32_t *&code, size_t &wordCount) const{
+		if (!header) return false;
+
+		uint64_t key = getKey(variantName);
+		uint32_t mask = header->slotCount - 1;
+
+		// linear probing, the table is never full
+		for (uint32_t i=static_cast<uint32_t>(key) & mask; slots[i].key != 0; i = (i + 1) & mask){
+			const Slot &slot = slots[i];
+			if (slot.key != key) continue;
+
+			if (static_cast<size_t>(slot.offset) + slot.size > file.size() || slot.offset % CODE_ALIGNMENT != 0)
+				throw std::runtime_error("corrupted shader archive : " + file.getFilepath());
+
+			code = file.as<uint32_t>(slot.offset);
+			wordCount = slot.size / sizeof(uint32_t);
+			return true;
+		}
+		return false;
+	}
+
+	bool ShaderArchive::contains(const std::string &variantName) const{
+		const uint32_t *code;
+		size_t wordCount;
+		return find(variantName, code, wordCount);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,91 @@
+#include "engine/ShaderModuleCache.hpp"
+
+// std
+#include <stdexcept>
+
+namespace vk_engine{
+	ShaderModuleCache::ShaderModuleCache(LogicalDevice &device) : device{device}{}
+
+	ShaderModuleCache::~ShaderModuleCache(){
+		clear();
+	}
+
+	void ShaderModuleCache::clear(){
+		std::lock_guard<std::mutex> lock(mutex);
+
+		for (auto &entry : entries)
+			vkDestroyShaderModule(device, entry.second.module, nullptr);
+
+		entries.clear();
+	}
+
+	VkShaderModule ShaderModuleCache::getModule(const std::string &filepath){
+		return get(filepath).module;
+	}
+
+	const ShaderReflection &ShaderModuleCache::getReflection(const std::string &filepath){
+		return get(filepath).reflection;
+	}
+
+	ShaderModuleCache::Entry &ShaderModuleCache::get(const std::string &filepath){
+		std::lock_guard<std::mutex> lock(mutex);
+
+		auto it = entries.find(filepath);
+		if (it != entries.end()) return it->second;
+
+		MappedFile file;
+		const uint32_t *code;
+		size_t wordCount;
+
+		if (archive && archive->find(filepath, code, wordCount)){
+			validate(code, wordCount * sizeof(uint32_t), filepath);
+		} else {
+			file = mapFile(filepath);
+			code = file.as<uint32_t>();
+			wordCount = file.size() / sizeof(uint32_t);
+		}
+
+		Entry entry;
+		entry.reflection = ShaderReflection(code, wordCount);
+		entry.module = createShaderModule(device, code, wordCount);
+
+		// the map is node based, the reference stay valid until the clear
+		return entries.emplace(filepath, std::move(entry)).first->second;
+	}
+
+	MappedFile ShaderModuleCache::mapFile(const std::string &filepath){
+		MappedFile file(filepath);
+		validate(file.data(), file.size(), filepath);
+		return file;
+	}
+
+	void ShaderModuleCache::validate(const void *code, size_t size, const std::string &name){
+		// the header alone is 5 words
+		if (size < 5 * sizeof(uint32_t) || size % sizeof(uint32_t) != 0)
+			throw std::runtime_error("invalid SPIR-V size : " + name);
+
+		// the alignment of mapped files and of std::vector<uint32_t> is always respected, only the custom buffers may fail
+		if (reinterpret_cast<uintptr_t>(code) % alignof(uint32_t) != 0)
+			throw std::runtime_error("misaligned SPIR-V code : " + name);
+
+		uint32_t magic = *static_cast<const uint32_t*>(code);
+		if (magic == __builtin_bswap32(ShaderReflection::SPIRV_MAGIC))
+			throw std::runtime_error("SPIR-V with the wrong endianness : " + name);
+
+		if (magic != ShaderReflection::SPIRV_MAGIC)
+			throw std::runtime_error("invalid SPIR-V magic number : " + name);
+	}
+
+	VkShaderModule ShaderModuleCache::createShaderModule(LogicalDevice &device, const uint32_t *code, size_t wordCount){
+		VkShaderModuleCreateInfo createInfo{};
+		createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+		createInfo.codeSize = wordCount * sizeof(uint32_t);
+		createInfo.pCode = code;
+
+		VkShaderModule module;
+		if (vkCreateShaderModule(device, &createInfo, nullptr, &module) != VK_SUCCESS)
+			throw std::runtime_error("failed to create shader module");
+
+		return module;
+	}
+}
\ No newline at end of file
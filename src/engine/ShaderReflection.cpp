@@ -0,0 +1,342 @@
+#include "engine/ShaderReflection.hpp"
+
+// std
+#include <stdexcept>
+#include <algorithm>
+
+namespace vk_engine{
+
+	// the subset of the SPIR-V specification used by the reflection
+	namespace spv{
+		enum Op{
+			OP_ENTRY_POINT = 15,
+			OP_EXECUTION_MODE = 16,
+			OP_TYPE_BOOL = 20,
+			OP_TYPE_INT = 21,
+			OP_TYPE_FLOAT = 22,
+			OP_TYPE_VECTOR = 23,
+			OP_TYPE_MATRIX = 24,
+			OP_TYPE_IMAGE = 25,
+			OP_TYPE_SAMPLER = 26,
+			OP_TYPE_SAMPLED_IMAGE = 27,
+			OP_TYPE_ARRAY = 28,
+			OP_TYPE_RUNTIME_ARRAY = 29,
+			OP_TYPE_STRUCT = 30,
+			OP_TYPE_POINTER = 32,
+			OP_CONSTANT = 43,
+			OP_CONSTANT_COMPOSITE = 44,
+			OP_SPEC_CONSTANT = 50,
+			OP_SPEC_CONSTANT_COMPOSITE = 51,
+			OP_VARIABLE = 59,
+			OP_DECORATE = 71,
+			OP_MEMBER_DECORATE = 72,
+			OP_TYPE_ACCELERATION_STRUCTURE = 5341
+		};
+
+		enum Decoration{
+			DECORATION_SPEC_ID = 1,
+			DECORATION_BUFFER_BLOCK = 3,
+			DECORATION_ARRAY_STRIDE = 6,
+			DECORATION_MATRIX_STRIDE = 7,
+			DECORATION_BUILT_IN = 11,
+			DECORATION_BINDING = 33,
+			DECORATION_DESCRIPTOR_SET = 34,
+			DECORATION_OFFSET = 35
+		};
+
+		enum StorageClass{
+			STORAGE_CLASS_UNIFORM_CONSTANT = 0,
+			STORAGE_CLASS_UNIFORM = 2,
+			STORAGE_CLASS_PUSH_CONSTANT = 9,
+			STORAGE_CLASS_STORAGE_BUFFER = 12
+		};
+
+		static constexpr uint32_t EXECUTION_MODE_LOCAL_SIZE = 17;
+		static constexpr uint32_t EXECUTION_MODE_LOCAL_SIZE_ID = 38;
+		static constexpr uint32_t BUILT_IN_WORKGROUP_SIZE = 25;
+		static constexpr uint32_t DIM_BUFFER = 5;
+		static constexpr uint32_t DIM_SUBPASS_DATA = 6;
+
+		struct Member{
+			uint32_t offset = 0;
+			uint32_t matrixStride = 0;
+		};
+
+		struct Id{
+			uint32_t opcode = 0;
+			const uint32_t *operands = nullptr;
+			uint32_t operandCount = 0;
+
+			uint32_t set = ~0U;
+			uint32_t binding = ~0U;
+			uint32_t specId = ShaderReflection::NO_SPEC_ID;
+			uint32_t arrayStride = 0;
+			uint32_t builtIn = ~0U;
+			bool bufferBlock = false;
+			std::vector<Member> members;
+		};
+	}
+
+	static VkShaderStageFlagBits executionModelToStage(uint32_t model){
+		switch (model){
+			case 0: return VK_SHADER_STAGE_VERTEX_BIT;
+			case 1: return VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT;
+			case 2: return VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT;
+			case 3: return VK_SHADER_STAGE_GEOMETRY_BIT;
+			case 4: return VK_SHADER_STAGE_FRAGMENT_BIT;
+			case 5: return VK_SHADER_STAGE_COMPUTE_BIT;
+			default: throw std::runtime_error("unsupported shader execution model");
+		}
+	}
+
+	ShaderReflection::ShaderReflection(const uint32_t *code, size_t wordCount){
+		reflect(code, wordCount);
+	}
+
+	void ShaderReflection::reflect(const uint32_t *code, size_t wordCount){
+		if (wordCount < 5 || code[0] != SPIRV_MAGIC)
+			throw std::runtime_error("invalid SPIR-V code");
+
+		std::vector<spv::Id> ids(code[3]);
+		auto id = [&](uint32_t index) -> spv::Id& {
+			if (index >= ids.size()) throw std::runtime_error("invalid SPIR-V id");
+			return ids[index];
+		};
+
+		std::vector<uint32_t> variables;
+		std::array<uint32_t, 3> localSizeIds = {0, 0, 0};
+		bool hasLocalSizeIds = false;
+		uint32_t workgroupSize = ~0U;
+
+		// first pass, register the ids and the decorations
+		size_t i = 5;
+		while (i < wordCount){
+			uint32_t opcode = code[i] & 0xFFFF;
+			uint32_t count = code[i] >> 16;
+
+			if (count == 0 || i + count > wordCount)
+				throw std::runtime_error("corrupted SPIR-V code");
+
+			const uint32_t *operands = code + i + 1;
+			uint32_t operandCount = count - 1;
+
+			switch (opcode){
+				case spv::OP_ENTRY_POINT:
+					// only the first entry point is reflected
+					if (stage == VK_SHADER_STAGE_ALL) stage = executionModelToStage(operands[0]);
+					break;
+
+				case spv::OP_EXECUTION_MODE:
+					if (operands[1] == spv::EXECUTION_MODE_LOCAL_SIZE && operandCount >= 5){
+						localSize.size = {operands[2], operands[3], operands[4]};
+					} else if (operands[1] == spv::EXECUTION_MODE_LOCAL_SIZE_ID && operandCount >= 5){
+						// resolved once all the constants are known
+						localSizeIds = {operands[2], operands[3], operands[4]};
+						hasLocalSizeIds = true;
+					}
+					break;
+
+				case spv::OP_DECORATE:{
+					spv::Id &target = id(operands[0]);
+					uint32_t decoration = operands[1];
+
+					if (decoration == spv::DECORATION_DESCRIPTOR_SET) target.set = operands[2];
+					else if (decoration == spv::DECORATION_BINDING) target.binding = operands[2];
+					else if (decoration == spv::DECORATION_SPEC_ID) target.specId = operands[2];
+					else if (decoration == spv::DECORATION_ARRAY_STRIDE) target.arrayStride = operands[2];
+					else if (decoration == spv::DECORATION_BUFFER_BLOCK) target.bufferBlock = true;
+					else if (decoration == spv::DECORATION_BUILT_IN){
+						target.builtIn = operands[2];
+						if (operands[2] == spv::BUILT_IN_WORKGROUP_SIZE) workgroupSize = operands[0];
+					}
+					break;
+				}
+
+				case spv::OP_MEMBER_DECORATE:{
+					spv::Id &target = id(operands[0]);
+					uint32_t member = operands[1];
+					uint32_t decoration = operands[2];
+
+					if (target.members.size() <= member) target.members.resize(member + 1);
+
+					if (decoration == spv::DECORATION_OFFSET) target.members[member].offset = operands[3];
+					else if (decoration == spv::DECORATION_MATRIX_STRIDE) target.members[member].matrixStride = operands[3];
+					break;
+				}
+
+				case spv::OP_TYPE_BOOL:
+				case spv::OP_TYPE_INT:
+				case spv::OP_TYPE_FLOAT:
+				case spv::OP_TYPE_VECTOR:
+				case spv::OP_TYPE_MATRIX:
+				case spv::OP_TYPE_IMAGE:
+				case spv::OP_TYPE_SAMPLER:
+				case spv::OP_TYPE_SAMPLED_IMAGE:
+				case spv::OP_TYPE_ARRAY:
+				case spv::OP_TYPE_RUNTIME_ARRAY:
+				case spv::OP_TYPE_STRUCT:
+				case spv::OP_TYPE_POINTER:
+				case spv::OP_TYPE_ACCELERATION_STRUCTURE:{
+					spv::Id &type = id(operands[0]);
+					type.opcode = opcode;
+					type.operands = operands;
+					type.operandCount = operandCount;
+					break;
+				}
+
+				case spv::OP_CONSTANT:
+				case spv::OP_CONSTANT_COMPOSITE:
+				case spv::OP_SPEC_CONSTANT:
+				case spv::OP_SPEC_CONSTANT_COMPOSITE:{
+					spv::Id &constant = id(operands[1]);
+					constant.opcode = opcode;
+					constant.operands = operands;
+					constant.operandCount = operandCount;
+					break;
+				}
+
+				case spv::OP_VARIABLE:{
+					spv::Id &variable = id(operands[1]);
+					variable.opcode = opcode;
+					variable.operands = operands;
+					variable.operandCount = operandCount;
+					variables.push_back(operands[1]);
+					break;
+				}
+			}
+
+			i += count;
+		}
+
+		// scalar constant, operands : result type, result id, value
+		auto constantValue = [&](uint32_t index) -> uint32_t {
+			const spv::Id &constant = id(index);
+			if ((constant.opcode != spv::OP_CONSTANT && constant.opcode != spv::OP_SPEC_CONSTANT) || constant.operandCount < 3)
+				throw std::runtime_error("unsupported SPIR-V constant");
+			return constant.operands[2];
+		};
+
+		// the size in bytes of a type inside a block, the strides come from the decorations
+		auto typeSize = [&](auto &&self, uint32_t index, uint32_t matrixStride) -> uint32_t {
+			const spv::Id &type = id(index);
+			switch (type.opcode){
+				case spv::OP_TYPE_BOOL: return 4;
+				case spv::OP_TYPE_INT:
+				case spv::OP_TYPE_FLOAT: return type.operands[1] / 8;
+				case spv::OP_TYPE_VECTOR: return self(self, type.operands[1], 0) * type.operands[2];
+				case spv::OP_TYPE_MATRIX: {
+					uint32_t column = matrixStride ? matrixStride : self(self, type.operands[1], 0);
+					return column * type.operands[2];
+				}
+				case spv::OP_TYPE_ARRAY: {
+					uint32_t stride = type.arrayStride ? type.arrayStride : self(self, type.operands[1], matrixStride);
+					return stride * constantValue(type.operands[2]);
+				}
+				case spv::OP_TYPE_RUNTIME_ARRAY: return 0;
+				case spv::OP_TYPE_STRUCT: {
+					uint32_t size = 0;
+					for (uint32_t m=1; m<type.operandCount; m++){
+						spv::Member member = m - 1 < type.members.size() ? type.members[m - 1] : spv::Member{};
+						size = std::max(size, member.offset + self(self, type.operands[m], member.matrixStride));
+					}
+					return size;
+				}
+				default: return 0;
+			}
+		};
+
+		for (uint32_t variableIndex : variables){
+			const spv::Id &variable = id(variableIndex);
+			uint32_t storageClass = variable.operands[2];
+
+			const spv::Id &pointer = id(variable.operands[0]);
+			if (pointer.opcode != spv::OP_TYPE_POINTER) continue;
+
+			uint32_t typeIndex = pointer.operands[2];
+
+			if (storageClass == spv::STORAGE_CLASS_PUSH_CONSTANT){
+				pushConstantRange.offset = 0;
+				pushConstantRange.size = typeSize(typeSize, typeIndex, 0);
+				continue;
+			}
+
+			if (storageClass != spv::STORAGE_CLASS_UNIFORM_CONSTANT && storageClass != spv::STORAGE_CLASS_UNIFORM && storageClass != spv::STORAGE_CLASS_STORAGE_BUFFER) continue;
+			if (variable.set == ~0U || variable.binding == ~0U) continue;
+
+			Binding binding;
+			binding.set = variable.set;
+			binding.binding = variable.binding;
+			binding.stages = stage;
+
+			// unwrap the arrays of descriptors
+			const spv::Id *type = &id(typeIndex);
+			if (type->opcode == spv::OP_TYPE_ARRAY){
+				binding.count = constantValue(type->operands[2]);
+				type = &id(type->operands[1]);
+			} else if (type->opcode == spv::OP_TYPE_RUNTIME_ARRAY){
+				binding.count = 0;
+				type = &id(type->operands[1]);
+			}
+
+			switch (type->opcode){
+				case spv::OP_TYPE_SAMPLER: binding.type = VK_DESCRIPTOR_TYPE_SAMPLER; break;
+				case spv::OP_TYPE_SAMPLED_IMAGE: binding.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER; break;
+				case spv::OP_TYPE_ACCELERATION_STRUCTURE: binding.type = VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR; break;
+
+				case spv::OP_TYPE_IMAGE:{
+					// operands : result id, sampled type, dim, depth, arrayed, ms, sampled, format
+					uint32_t dim = type->operands[2];
+					uint32_t sampled = type->operands[6];
+
+					if (dim == spv::DIM_SUBPASS_DATA) binding.type = VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;
+					else if (dim == spv::DIM_BUFFER) binding.type = sampled == 2 ? VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER : VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER;
+					else binding.type = sampled == 2 ? VK_DESCRIPTOR_TYPE_STORAGE_IMAGE : VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+					break;
+				}
+
+				case spv::OP_TYPE_STRUCT:
+					if (storageClass == spv::STORAGE_CLASS_STORAGE_BUFFER || type->bufferBlock){
+						binding.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+					} else {
+						binding.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+					}
+					break;
+
+				default:
+					throw std::runtime_error("unsupported SPIR-V descriptor type");
+			}
+
+			bindings.push_back(binding);
+		}
+
+		std::sort(bindings.begin(), bindings.end(), [](const Binding &a, const Binding &b){
+			return a.set != b.set ? a.set < b.set : a.binding < b.binding;
+		});
+
+		if (stage == VK_SHADER_STAGE_ALL)
+			throw std::runtime_error("the SPIR-V code does not have an entry point");
+
+		pushConstantRange.stageFlags = pushConstantRange.size > 0 ? stage : 0;
+
+		// resolve the workgroup size given as constants, gl_WorkGroupSize override the execution mode
+		auto resolveDimension = [&](int dimension, uint32_t constantIndex){
+			localSize.size[dimension] = constantValue(constantIndex);
+			localSize.specIds[dimension] = id(constantIndex).specId;
+		};
+
+		if (hasLocalSizeIds){
+			for (int d=0; d<3; d++){
+				resolveDimension(d, localSizeIds[d]);
+			}
+		}
+
+		if (workgroupSize != ~0U){
+			const spv::Id &composite = id(workgroupSize);
+			if (composite.operandCount >= 5){
+				for (int d=0; d<3; d++){
+					resolveDimension(d, composite.operands[2 + d]);
+				}
+			}
+		}
+	}
+}
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include "engine/SingleTimeCommands.hpp"
+#include "engine/ImageStateTracker.hpp"
 
 // std
 #include <stdexcept>
@@ -78,11 +79,19 @@ namespace vk_engine{
 		vkCmdCopyBufferToImage(commandBuffer, buffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
 	}
 
-	void transitionImageLayout(CommandPool &commandPool, LogicalDevice &device, VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout){
+	void transitionImageLayout(CommandPool &commandPool, LogicalDevice &device, VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout, const Synchronization2 *synchronization2){
 		SingleTimeCommands commandBuffer(commandPool, device, device.getQueues()[0][FAMILY_GRAPHIC]);
 
-		VkImageMemoryBarrier barrier{};
-		barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+		// the usual accesses of the layouts, any pair of layouts can be transitioned
+		ImageStateTracker::State src = ImageStateTracker::getLayoutState(oldLayout);
+		ImageStateTracker::State dst = ImageStateTracker::getLayoutState(newLayout);
+
+		VkImageMemoryBarrier2KHR barrier{};
+		barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2_KHR;
+		barrier.srcStageMask = src.stages;
+		barrier.srcAccessMask = src.access & ImageStateTracker::WRITE_ACCESS;
+		barrier.dstStageMask = dst.stages;
+		barrier.dstAccessMask = dst.access;
 		barrier.oldLayout = oldLayout;
 		barrier.newLayout = newLayout;
 
@@ -90,41 +99,22 @@ namespace vk_engine{
 		barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
 
 		barrier.image = image;
-		barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		barrier.subresourceRange.aspectMask = ImageStateTracker::getFormatAspect(format);
 		barrier.subresourceRange.baseMipLevel = 0;
 		barrier.subresourceRange.levelCount = 1;
 		barrier.subresourceRange.baseArrayLayer = 0;
 		barrier.subresourceRange.layerCount = 1;
 
-		VkPipelineStageFlags sourceStage;
-		VkPipelineStageFlags destinationStage;
-
-		if (oldLayout == VK_IMAGE_LAYOUT_UNDEFINED && newLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL){
-			barrier.srcAccessMask = 0;
-			barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-
-			sourceStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
-			destinationStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
-
-		} else if (oldLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL && newLayout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL){
-			barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-			barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-
-			sourceStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
-			destinationStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
-		
-		} else if (oldLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL && newLayout == VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL){
-			barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-			barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
-
-			sourceStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
-			destinationStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
-
-		} else
-			throw std::runtime_error("unsupported layout transition !");
-		
+		VkDependencyInfoKHR dependency{};
+		dependency.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO_KHR;
+		dependency.imageMemoryBarrierCount = 1;
+		dependency.pImageMemoryBarriers = &barrier;
 
-		vkCmdPipelineBarrier(commandBuffer, sourceStage, destinationStage, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+		if (synchronization2){
+			synchronization2->pipelineBarrier(commandBuffer, dependency);
+		} else {
+			Synchronization2::legacyPipelineBarrier(commandBuffer, dependency);
+		}
 	}
 
 	void blitImage(CommandPool &commandPool, LogicalDevice &device, VkImage srcImage, VkImageLayout srcLayout, VkImage dstImage, VkImageLayout dstLayout, uint32_t regionCount, VkImageBlit *regions, VkFilter filter){
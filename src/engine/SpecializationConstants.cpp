@@ -0,0 +1,50 @@
+#include "engine/SpecializationConstants.hpp"
+#include "engine/Hash.hpp"
+
+// std
+#include <cstring>
+
+namespace vk_engine{
+	void SpecializationConstants::setRaw(uint32_t constantID, const void *data, size_t size){
+		std::vector<char> &value = constants[constantID];
+		value.resize(size);
+		memcpy(value.data(), data, size);
+	}
+
+	void SpecializationConstants::remove(uint32_t constantID){
+		constants.erase(constantID);
+	}
+
+	const VkSpecializationInfo *SpecializationConstants::getInfo(){
+		if (constants.empty()) return nullptr;
+
+		entries.clear();
+		data.clear();
+
+		for (const auto &constant : constants){
+			VkSpecializationMapEntry entry{};
+			entry.constantID = constant.first;
+			entry.offset = static_cast<uint32_t>(data.size());
+			entry.size = constant.second.size();
+
+			entries.push_back(entry);
+			data.insert(data.end(), constant.second.begin(), constant.second.end());
+		}
+
+		info.mapEntryCount = static_cast<uint32_t>(entries.size());
+		info.pMapEntries = entries.data();
+		info.dataSize = data.size();
+		info.pData = data.data();
+
+		return &info;
+	}
+
+	uint64_t SpecializationConstants::hash(uint64_t seed) const noexcept{
+		for (const auto &constant : constants){
+			hashCombine(seed, constant.first);
+			seed = hashBytes(constant.second.data(), constant.second.size(), seed);
+		}
+		hashCombine(seed, constants.size());
+		return seed;
+	}
+}
\ No newline at end of file
@@ -17,20 +17,28 @@ namespace vk_engine{
 	}
 
 	SwapChain::~SwapChain(){
-		for (auto imageView : swapChainImageViews)
+		for (auto imageView : swapChainImageViews){
+			device.notifyDestroyed(imageView);
 			vkDestroyImageView(device, imageView, nullptr);
+		}
 		
 		swapChainImageViews.clear();
 
+		// the images are owned by the swap chain
+		for (auto image : swapChainImages)
+			device.notifyDestroyed(image);
+
 		if (swapChain != VK_NULL_HANDLE) {
 			vkDestroySwapchainKHR(device, swapChain, nullptr);
 			swapChain = VK_NULL_HANDLE;
 		}
 
 		for (int i=0; i<static_cast<int>(depthImages.size()); i++) {
+			device.notifyDestroyed(depthImageViews[i]);
 			vkDestroyImageView(device, depthImageViews[i], nullptr);
 
 			if (depthBufferEnable){
+				device.notifyDestroyed(depthImages[i]);
 				vkDestroyImage(device, depthImages[i], nullptr);
 				vkFreeMemory(device, depthImageMemorys[i], nullptr);
 			}
@@ -250,7 +258,28 @@ namespace vk_engine{
 		renderPassInfo.dependencyCount = 1;
 		renderPassInfo.pDependencies = &dependency;
 
-		if (vkCreateRenderPass(device, &renderPassInfo, nullptr, &renderPass) != VK_SUCCESS)
+		VkResult result;
+		if (synchronization2){
+			// the previous depth writes are done in the late fragment tests, the color waits on the acquire semaphore
+			VkMemoryBarrier2KHR barrier{};
+			barrier.srcStageMask = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT_KHR;
+			barrier.srcAccessMask = VK_ACCESS_2_NONE_KHR;
+			barrier.dstStageMask = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT_KHR;
+			barrier.dstAccessMask = VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT_KHR;
+
+			if (depthBufferEnable){
+				barrier.srcStageMask |= VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT_KHR;
+				barrier.srcAccessMask |= VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT_KHR;
+				barrier.dstStageMask |= VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT_KHR;
+				barrier.dstAccessMask |= VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT_KHR;
+			}
+
+			result = synchronization2->createRenderPass(renderPassInfo, {barrier}, &renderPass);
+		} else {
+			result = vkCreateRenderPass(device, &renderPassInfo, nullptr, &renderPass);
+		}
+
+		if (result != VK_SUCCESS)
 			throw std::runtime_error("failed to create render pass");
 		
 	}
@@ -0,0 +1,280 @@
+#include "engine/Synchronization2.hpp"
+
+// std
+#include <stdexcept>
+
+namespace vk_engine{
+	Synchronization2::Synchronization2(LogicalDevice &device) : device{device}{}
+
+	void Synchronization2::require(){
+		PhysicalDevice &physicalDevice = device.getPhysicalDevice();
+		if (!physicalDevice.isExtensionSupported(VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME)) return;
+
+		auto features = physicalDevice.getFeatures<VkPhysicalDeviceSynchronization2FeaturesKHR>(VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SYNCHRONIZATION_2_FEATURES_KHR);
+		if (!features.synchronization2) return;
+
+		device.requireOptionalExtension(VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME);
+		device.requireFeatures<VkPhysicalDeviceSynchronization2FeaturesKHR>(VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SYNCHRONIZATION_2_FEATURES_KHR).synchronization2 = VK_TRUE;
+
+		// the memory barriers of the subpass dependencies are chained to VkSubpassDependency2
+		if (physicalDevice.isExtensionSupported(VK_KHR_CREATE_RENDERPASS_2_EXTENSION_NAME) && physicalDevice.isExtensionSupported(VK_KHR_MULTIVIEW_EXTENSION_NAME) && physicalDevice.isExtensionSupported(VK_KHR_MAINTENANCE2_EXTENSION_NAME)){
+			device.requireOptionalExtension(VK_KHR_MULTIVIEW_EXTENSION_NAME);
+			device.requireOptionalExtension(VK_KHR_MAINTENANCE2_EXTENSION_NAME);
+			device.requireOptionalExtension(VK_KHR_CREATE_RENDERPASS_2_EXTENSION_NAME);
+		}
+	}
+
+	void Synchronization2::build(){
+		auto features = device.getEnabledFeatures<VkPhysicalDeviceSynchronization2FeaturesKHR>(VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SYNCHRONIZATION_2_FEATURES_KHR);
+		supported = device.isExtensionEnabled(VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME) && features && features->synchronization2;
+		renderPass2 = false;
+
+		if (!supported) return;
+
+		cmdPipelineBarrier2 = device.getProcAddr<PFN_vkCmdPipelineBarrier2KHR>("vkCmdPipelineBarrier2KHR");
+		if (!cmdPipelineBarrier2)
+			throw std::runtime_error("failed to load the VK_KHR_synchronization2 commands");
+
+		if (device.isExtensionEnabled(VK_KHR_CREATE_RENDERPASS_2_EXTENSION_NAME)){
+			createRenderPass2 = device.getProcAddr<PFN_vkCreateRenderPass2KHR>("vkCreateRenderPass2KHR");
+			renderPass2 = createRenderPass2 != nullptr;
+		}
+	}
+
+	void Synchronization2::pipelineBarrier(VkCommandBuffer commandBuffer, const VkDependencyInfoKHR &dependency) const{
+		if (supported){
+			cmdPipelineBarrier2(commandBuffer, &dependency);
+		} else {
+			legacyPipelineBarrier(commandBuffer, dependency);
+		}
+	}
+
+	void Synchronization2::pipelineBarrier(VkCommandBuffer commandBuffer, const std::vector<VkImageMemoryBarrier2KHR> &imageBarriers, const std::vector<VkBufferMemoryBarrier2KHR> &bufferBarriers) const{
+		if (imageBarriers.empty() && bufferBarriers.empty()) return;
+
+		VkDependencyInfoKHR dependency{};
+		dependency.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO_KHR;
+		dependency.imageMemoryBarrierCount = static_cast<uint32_t>(imageBarriers.size());
+		dependency.pImageMemoryBarriers = imageBarriers.data();
+		dependency.bufferMemoryBarrierCount = static_cast<uint32_t>(bufferBarriers.size());
+		dependency.pBufferMemoryBarriers = bufferBarriers.data();
+
+		pipelineBarrier(commandBuffer, dependency);
+	}
+
+	VkResult Synchronization2::createRenderPass(const VkRenderPassCreateInfo &createInfo, const std::vector<VkMemoryBarrier2KHR> &dependencyBarriers, VkRenderPass *renderPass) const{
+		if (!renderPass2 || dependencyBarriers.empty())
+			return vkCreateRenderPass(device, &createInfo, nullptr, renderPass);
+
+		if (dependencyBarriers.size() != createInfo.dependencyCount)
+			throw std::runtime_error("the count of dependency barriers does not match the count of subpass dependencies");
+
+		std::vector<VkAttachmentDescription2> attachments(createInfo.attachmentCount);
+		for (uint32_t i=0; i<createInfo.attachmentCount; i++){
+			const VkAttachmentDescription &src = createInfo.pAttachments[i];
+			VkAttachmentDescription2 &dst = attachments[i];
+
+			dst.sType = VK_STRUCTURE_TYPE_ATTACHMENT_DESCRIPTION_2;
+			dst.flags = src.flags;
+			dst.format = src.format;
+			dst.samples = src.samples;
+			dst.loadOp = src.loadOp;
+			dst.storeOp = src.storeOp;
+			dst.stencilLoadOp = src.stencilLoadOp;
+			dst.stencilStoreOp = src.stencilStoreOp;
+			dst.initialLayout = src.initialLayout;
+			dst.finalLayout = src.finalLayout;
+		}
+
+		// the references of all the subpasses, the subpasses point into it once filled
+		std::vector<VkAttachmentReference2> references;
+		std::vector<uint32_t> preserveAttachments;
+		std::vector<VkSubpassDescription2> subpasses(createInfo.subpassCount);
+
+		auto convertReferences = [&](const VkAttachmentReference *src, uint32_t count){
+			for (uint32_t i=0; i<count; i++){
+				VkAttachmentReference2 reference{};
+				reference.sType = VK_STRUCTURE_TYPE_ATTACHMENT_REFERENCE_2;
+				reference.attachment = src[i].attachment;
+				reference.layout = src[i].layout;
+
+				// the aspect is only read for the input attachments, all the aspects of the format are used
+				reference.aspectMask = 0;
+				references.push_back(reference);
+			}
+		};
+
+		for (uint32_t i=0; i<createInfo.subpassCount; i++){
+			const VkSubpassDescription &src = createInfo.pSubpasses[i];
+			convertReferences(src.pInputAttachments, src.inputAttachmentCount);
+			convertReferences(src.pColorAttachments, src.colorAttachmentCount);
+			if (src.pResolveAttachments) convertReferences(src.pResolveAttachments, src.colorAttachmentCount);
+			if (src.pDepthStencilAttachment) convertReferences(src.pDepthStencilAttachment, 1);
+			preserveAttachments.insert(preserveAttachments.end(), src.pPreserveAttachments, src.pPreserveAttachments + src.preserveAttachmentCount);
+		}
+
+		size_t reference = 0;
+		size_t preserve = 0;
+		for (uint32_t i=0; i<createInfo.subpassCount; i++){
+			const VkSubpassDescription &src = createInfo.pSubpasses[i];
+			VkSubpassDescription2 &dst = subpasses[i];
+
+			dst.sType = VK_STRUCTURE_TYPE_SUBPASS_DESCRIPTION_2;
+			dst.flags = src.flags;
+			dst.pipelineBindPoint = src.pipelineBindPoint;
+			dst.viewMask = 0;
+
+			dst.inputAttachmentCount = src.inputAttachmentCount;
+			dst.pInputAttachments = references.data() + reference;
+			reference += src.inputAttachmentCount;
+
+			// the aspect of an input attachment is required
+			for (uint32_t j=0; j<src.inputAttachmentCount; j++){
+				VkAttachmentReference2 &input = references[reference - src.inputAttachmentCount + j];
+				if (input.attachment == VK_ATTACHMENT_UNUSED) continue;
+
+				VkFormat format = createInfo.pAttachments[input.attachment].format;
+				bool depth = format == VK_FORMAT_D16_UNORM || format == VK_FORMAT_X8_D24_UNORM_PACK32 || format == VK_FORMAT_D32_SFLOAT;
+				bool depthStencil = format == VK_FORMAT_D16_UNORM_S8_UINT || format == VK_FORMAT_D24_UNORM_S8_UINT || format == VK_FORMAT_D32_SFLOAT_S8_UINT;
+				input.aspectMask = depthStencil ? VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT : depth ? VK_IMAGE_ASPECT_DEPTH_BIT : VK_IMAGE_ASPECT_COLOR_BIT;
+			}
+
+			dst.colorAttachmentCount = src.colorAttachmentCount;
+			dst.pColorAttachments = references.data() + reference;
+			reference += src.colorAttachmentCount;
+
+			if (src.pResolveAttachments){
+				dst.pResolveAttachments = references.data() + reference;
+				reference += src.colorAttachmentCount;
+			}
+
+			if (src.pDepthStencilAttachment){
+				dst.pDepthStencilAttachment = references.data() + reference;
+				reference++;
+			}
+
+			dst.preserveAttachmentCount = src.preserveAttachmentCount;
+			dst.pPreserveAttachments = preserveAttachments.data() + preserve;
+			preserve += src.preserveAttachmentCount;
+		}
+
+		// the masks of a dependency are ignored when a memory barrier is chained
+		std::vector<VkMemoryBarrier2KHR> barriers = dependencyBarriers;
+		std::vector<VkSubpassDependency2> dependencies(createInfo.dependencyCount);
+
+		for (uint32_t i=0; i<createInfo.dependencyCount; i++){
+			const VkSubpassDependency &src = createInfo.pDependencies[i];
+			VkSubpassDependency2 &dst = dependencies[i];
+
+			barriers[i].sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2_KHR;
+			barriers[i].pNext = nullptr;
+
+			dst.sType = VK_STRUCTURE_TYPE_SUBPASS_DEPENDENCY_2;
+			dst.pNext = &barriers[i];
+			dst.srcSubpass = src.srcSubpass;
+			dst.dstSubpass = src.dstSubpass;
+			dst.dependencyFlags = src.dependencyFlags;
+		}
+
+		VkRenderPassCreateInfo2 createInfo2{};
+		createInfo2.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO_2;
+		createInfo2.flags = createInfo.flags;
+		createInfo2.attachmentCount = static_cast<uint32_t>(attachments.size());
+		createInfo2.pAttachments = attachments.data();
+		createInfo2.subpassCount = static_cast<uint32_t>(subpasses.size());
+		createInfo2.pSubpasses = subpasses.data();
+		createInfo2.dependencyCount = static_cast<uint32_t>(dependencies.size());
+		createInfo2.pDependencies = dependencies.data();
+
+		return createRenderPass2(device, &createInfo2, nullptr, renderPass);
+	}
+
+	void Synchronization2::legacyPipelineBarrier(VkCommandBuffer commandBuffer, const VkDependencyInfoKHR &dependency){
+		VkPipelineStageFlags2KHR srcStages = 0;
+		VkPipelineStageFlags2KHR dstStages = 0;
+
+		std::vector<VkMemoryBarrier> memoryBarriers(dependency.memoryBarrierCount);
+		for (uint32_t i=0; i<dependency.memoryBarrierCount; i++){
+			const VkMemoryBarrier2KHR &src = dependency.pMemoryBarriers[i];
+			VkMemoryBarrier &dst = memoryBarriers[i];
+
+			dst.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+			dst.srcAccessMask = toLegacyAccess(src.srcAccessMask);
+			dst.dstAccessMask = toLegacyAccess(src.dstAccessMask);
+
+			srcStages |= src.srcStageMask;
+			dstStages |= src.dstStageMask;
+		}
+
+		std::vector<VkBufferMemoryBarrier> bufferBarriers(dependency.bufferMemoryBarrierCount);
+		for (uint32_t i=0; i<dependency.bufferMemoryBarrierCount; i++){
+			const VkBufferMemoryBarrier2KHR &src = dependency.pBufferMemoryBarriers[i];
+			VkBufferMemoryBarrier &dst = bufferBarriers[i];
+
+			dst.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+			dst.srcAccessMask = toLegacyAccess(src.srcAccessMask);
+			dst.dstAccessMask = toLegacyAccess(src.dstAccessMask);
+			dst.srcQueueFamilyIndex = src.srcQueueFamilyIndex;
+			dst.dstQueueFamilyIndex = src.dstQueueFamilyIndex;
+			dst.buffer = src.buffer;
+			dst.offset = src.offset;
+			dst.size = src.size;
+
+			srcStages |= src.srcStageMask;
+			dstStages |= src.dstStageMask;
+		}
+
+		std::vector<VkImageMemoryBarrier> imageBarriers(dependency.imageMemoryBarrierCount);
+		for (uint32_t i=0; i<dependency.imageMemoryBarrierCount; i++){
+			const VkImageMemoryBarrier2KHR &src = dependency.pImageMemoryBarriers[i];
+			VkImageMemoryBarrier &dst = imageBarriers[i];
+
+			dst.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+			dst.srcAccessMask = toLegacyAccess(src.srcAccessMask);
+			dst.dstAccessMask = toLegacyAccess(src.dstAccessMask);
+			dst.oldLayout = src.oldLayout;
+			dst.newLayout = src.newLayout;
+			dst.srcQueueFamilyIndex = src.srcQueueFamilyIndex;
+			dst.dstQueueFamilyIndex = src.dstQueueFamilyIndex;
+			dst.image = src.image;
+			dst.subresourceRange = src.subresourceRange;
+
+			srcStages |= src.srcStageMask;
+			dstStages |= src.dstStageMask;
+		}
+
+		vkCmdPipelineBarrier(commandBuffer, toLegacyStages(srcStages, true), toLegacyStages(dstStages, false), dependency.dependencyFlags,
+			static_cast<uint32_t>(memoryBarriers.size()), memoryBarriers.data(),
+			static_cast<uint32_t>(bufferBarriers.size()), bufferBarriers.data(),
+			static_cast<uint32_t>(imageBarriers.size()), imageBarriers.data());
+	}
+
+	VkPipelineStageFlags Synchronization2::toLegacyStages(VkPipelineStageFlags2KHR stages, bool src) noexcept{
+		// the stages of synchronization2 below 32 bits have the same values
+		VkPipelineStageFlags legacy = static_cast<VkPipelineStageFlags>(stages & 0xFFFFFFFFULL);
+
+		if (stages & (VK_PIPELINE_STAGE_2_COPY_BIT_KHR | VK_PIPELINE_STAGE_2_RESOLVE_BIT_KHR | VK_PIPELINE_STAGE_2_BLIT_BIT_KHR | VK_PIPELINE_STAGE_2_CLEAR_BIT_KHR))
+			legacy |= VK_PIPELINE_STAGE_TRANSFER_BIT;
+
+		if (stages & (VK_PIPELINE_STAGE_2_INDEX_INPUT_BIT_KHR | VK_PIPELINE_STAGE_2_VERTEX_ATTRIBUTE_INPUT_BIT_KHR))
+			legacy |= VK_PIPELINE_STAGE_VERTEX_INPUT_BIT;
+
+		if (stages & VK_PIPELINE_STAGE_2_PRE_RASTERIZATION_SHADERS_BIT_KHR)
+			legacy |= VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_TESSELLATION_CONTROL_SHADER_BIT | VK_PIPELINE_STAGE_TESSELLATION_EVALUATION_SHADER_BIT | VK_PIPELINE_STAGE_GEOMETRY_SHADER_BIT;
+
+		if (legacy == 0) legacy = src ? VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT : VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+		return legacy;
+	}
+
+	VkAccessFlags Synchronization2::toLegacyAccess(VkAccessFlags2KHR access) noexcept{
+		VkAccessFlags legacy = static_cast<VkAccessFlags>(access & 0xFFFFFFFFULL);
+
+		if (access & (VK_ACCESS_2_SHADER_SAMPLED_READ_BIT_KHR | VK_ACCESS_2_SHADER_STORAGE_READ_BIT_KHR))
+			legacy |= VK_ACCESS_SHADER_READ_BIT;
+
+		if (access & VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT_KHR)
+			legacy |= VK_ACCESS_SHADER_WRITE_BIT;
+
+		return legacy;
+	}
+}
\ No newline at end of file
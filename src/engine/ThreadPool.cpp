@@ -0,0 +1,73 @@
+#include "engine/ThreadPool.hpp"
+
+// std
+#include <algorithm>
+
+namespace vk_engine{
+	static thread_local uint32_t workerIndex = ThreadPool::NO_WORKER;
+
+	ThreadPool::ThreadPool(uint32_t threadCount){
+		if (threadCount == 0) threadCount = std::max(1U, std::thread::hardware_concurrency());
+
+		threads.reserve(threadCount);
+		for (uint32_t i=0; i<threadCount; i++)
+			threads.emplace_back(&ThreadPool::work, this, i);
+	}
+
+	ThreadPool::~ThreadPool(){
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stop = true;
+		}
+		taskCondition.notify_all();
+
+		// the remaining tasks are executed before the threads exit
+		for (auto &thread : threads)
+			thread.join();
+	}
+
+	void ThreadPool::push(std::function<void()> task){
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			tasks.push_back(std::move(task));
+		}
+		taskCondition.notify_one();
+	}
+
+	void ThreadPool::wait(){
+		std::unique_lock<std::mutex> lock(mutex);
+		idleCondition.wait(lock, [this](){return tasks.empty() && activeTasks == 0;});
+	}
+
+	uint32_t ThreadPool::getWorkerIndex() noexcept{
+		return workerIndex;
+	}
+
+	void ThreadPool::work(uint32_t index){
+		workerIndex = index;
+
+		while (true){
+			std::function<void()> task;
+
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				taskCondition.wait(lock, [this](){return stop || !tasks.empty();});
+
+				if (tasks.empty()) return;
+
+				task = std::move(tasks.front());
+				tasks.pop_front();
+				activeTasks++;
+			}
+
+			// the exceptions are stored in the future of the task
+			task();
+
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				activeTasks--;
+				if (tasks.empty() && activeTasks == 0) idleCondition.notify_all();
+			}
+		}
+	}
+}
\ No newline at end of file
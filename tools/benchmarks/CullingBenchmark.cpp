@@ -0,0 +1,380 @@
+// culling_benchmark - time the frustum culling of random bounding volumes on the cpu, linear and with a bounding volume hierarchy, headless
+//
+// usage : culling_benchmark [options]
+//     --count <count>          a count of objects, may be repeated, default 10000, 100000 and 1000000
+//     --iterations <count>     the count of culls of each variant, default 100
+//     --threads <count>        the workers of the thread pool, default the count of hardware threads
+//
+// every supported instruction set of the linear culling is timed on the calling thread then split on the thread pool, the camera
+// turns around the center of the objects so each cull sees a different part of them. The visible spheres of each variant are
+// checked against the scalar culling on the calling thread.
+// the hierarchy is built over the boxes of the spheres and timed for its build, its refits, its culls and its ray and box queries,
+// its results are checked against a test of every box
+
+#include "engine/CpuCulling.hpp"
+#include "engine/BoundingVolumeHierarchy.hpp"
+#include "engine/ThreadPool.hpp"
+
+// libs
+#include <glm/ext/matrix_clip_space.hpp>
+#include <glm/ext/matrix_transform.hpp>
+#include <glm/vector_relational.hpp>
+
+// std
+#include <iostream>
+#include <iomanip>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+using vk_engine::CpuCulling;
+using vk_engine::BoundingVolumeHierarchy;
+using vk_engine::Frustum;
+using vk_engine::ThreadPool;
+
+using Milliseconds = std::chrono::duration<double, std::milli>;
+
+struct Options{
+	std::vector<uint32_t> counts;
+	uint32_t iterations = 100;
+	uint32_t threads = 0;
+};
+
+static uint32_t parseCount(const std::string &option, const char *value){
+	char *end = nullptr;
+	unsigned long count = std::strtoul(value, &end, 10);
+	if (*end != '\0' || count == 0)
+		throw std::runtime_error("invalid value for " + option + " : " + value);
+
+	return static_cast<uint32_t>(count);
+}
+
+static Options parseArguments(int argc, char **argv){
+	Options options;
+
+	for (int i=1; i<argc; i++){
+		std::string argument = argv[i];
+
+		if (i + 1 >= argc)
+			throw std::runtime_error("missing value for " + argument);
+
+		if (argument == "--count"){
+			options.counts.push_back(parseCount(argument, argv[++i]));
+		} else if (argument == "--iterations"){
+			options.iterations = parseCount(argument, argv[++i]);
+		} else if (argument == "--threads"){
+			options.threads = parseCount(argument, argv[++i]);
+		} else {
+			throw std::runtime_error("unknown option : " + argument);
+		}
+	}
+
+	if (options.counts.empty())
+		options.counts = {10000, 100000, 1000000};
+
+	return options;
+}
+
+// the spheres fill a cube of 1000 units around the origin
+static std::vector<glm::vec4> generateSpheres(uint32_t count){
+	std::mt19937 random(42);
+	std::uniform_real_distribution<float> position(-500.f, 500.f);
+	std::uniform_real_distribution<float> radius(0.5f, 4.f);
+
+	std::vector<glm::vec4> spheres(count);
+	for (auto &sphere : spheres)
+		sphere = glm::vec4(position(random), position(random), position(random), radius(random));
+
+	return spheres;
+}
+
+static glm::mat4 getViewProjection(uint32_t iteration, uint32_t iterations){
+	const float angle = glm::two_pi<float>() * static_cast<float>(iteration) / static_cast<float>(iterations);
+	const glm::vec3 direction(std::cos(angle), 0.2f * std::sin(3.f * angle), std::sin(angle));
+
+	glm::mat4 view = glm::lookAt(glm::vec3(0.f), direction, glm::vec3(0.f, 1.f, 0.f));
+	glm::mat4 projection = glm::perspectiveRH_ZO(glm::radians(60.f), 16.f / 9.f, 0.1f, 400.f);
+	return projection * view;
+}
+
+static const char *getName(CpuCulling::InstructionSet set){
+	switch (set){
+		case CpuCulling::INSTRUCTION_SET_SCALAR: return "scalar";
+		case CpuCulling::INSTRUCTION_SET_SSE: return "sse";
+		case CpuCulling::INSTRUCTION_SET_AVX: return "avx";
+	}
+	return "unknown";
+}
+
+static void printTime(const std::string &name, const std::string &variant, double milliseconds){
+	std::cout << std::left << std::setw(16) << name << std::setw(10) << variant
+		<< std::right << std::fixed << std::setprecision(3) << std::setw(10) << milliseconds << " ms";
+}
+
+static void printMismatches(uint32_t mismatches, bool &valid){
+	if (mismatches > 0){
+		std::cout << "  " << mismatches << " mismatches";
+		valid = false;
+	}
+	std::cout << std::endl;
+}
+
+static void benchmarkLinear(const std::vector<glm::vec4> &spheres, const Options &options, ThreadPool &threadPool, bool &valid){
+	CpuCulling reference;
+	reference.setInstructionSet(CpuCulling::INSTRUCTION_SET_SCALAR);
+	for (const auto &sphere : spheres)
+		reference.add(sphere);
+
+	// the visible spheres of the reference culling
+	std::vector<std::vector<uint32_t>> references(options.iterations);
+	for (uint32_t i=0; i<options.iterations; i++)
+		references[i] = reference.cull(getViewProjection(i, options.iterations));
+
+	const CpuCulling::InstructionSet sets[] = {CpuCulling::INSTRUCTION_SET_SCALAR, CpuCulling::INSTRUCTION_SET_SSE, CpuCulling::INSTRUCTION_SET_AVX};
+
+	for (auto set : sets){
+		if (!CpuCulling::isSupported(set)){
+			std::cout << std::left << std::setw(16) << std::string("linear ") + getName(set) << "unsupported" << std::endl;
+			continue;
+		}
+
+		for (bool threaded : {false, true}){
+			CpuCulling culling;
+			culling.setInstructionSet(set);
+			if (threaded) culling.setThreadPool(threadPool);
+
+			culling.reserve(static_cast<uint32_t>(spheres.size()));
+			for (const auto &sphere : spheres)
+				culling.add(sphere);
+
+			Milliseconds time{0};
+			size_t visible = 0;
+			uint32_t mismatches = 0;
+
+			for (uint32_t i=0; i<options.iterations; i++){
+				const glm::mat4 viewProjection = getViewProjection(i, options.iterations);
+
+				auto start = std::chrono::steady_clock::now();
+				const std::vector<uint32_t> &result = culling.cull(viewProjection);
+				time += std::chrono::steady_clock::now() - start;
+
+				visible += result.size();
+				if (result != references[i]) mismatches++;
+			}
+
+			printTime(std::string("linear ") + getName(set), threaded ? "threaded" : "single", time.count() / options.iterations);
+			std::cout << std::setw(12) << visible / options.iterations << " visible";
+			printMismatches(mismatches, valid);
+		}
+	}
+}
+
+// the objects whose box is visible, tested one by one
+static std::vector<uint32_t> cullBoxes(const std::vector<glm::vec3> &mins, const std::vector<glm::vec3> &maxs, const Frustum &frustum){
+	std::vector<uint32_t> visible;
+	for (uint32_t i=0; i<mins.size(); i++)
+		if (frustum.intersectsBox(mins[i], maxs[i])) visible.push_back(i);
+
+	return visible;
+}
+
+// the objects whose box overlaps the given box, tested one by one
+static std::vector<uint32_t> overlapBoxes(const std::vector<glm::vec3> &mins, const std::vector<glm::vec3> &maxs, const glm::vec3 &min, const glm::vec3 &max){
+	std::vector<uint32_t> overlapping;
+	for (uint32_t i=0; i<mins.size(); i++){
+		if (glm::all(glm::lessThanEqual(mins[i], max)) && glm::all(glm::lessThanEqual(min, maxs[i]))) overlapping.push_back(i);
+	}
+
+	return overlapping;
+}
+
+// the distance along the ray where it enters the box, FLT_MAX if it misses it. A ray parallel to a slab is inside it if its origin is
+static float intersectBox(const glm::vec3 &min, const glm::vec3 &max, const glm::vec3 &origin, const glm::vec3 &direction){
+	float entry = 0.f;
+	float exit = FLT_MAX;
+
+	for (int i=0; i<3; i++){
+		if (direction[i] == 0.f){
+			if (origin[i] < min[i] || origin[i] > max[i]) return FLT_MAX;
+			continue;
+		}
+
+		const float toMin = (min[i] - origin[i]) / direction[i];
+		const float toMax = (max[i] - origin[i]) / direction[i];
+		entry = std::max(entry, std::min(toMin, toMax));
+		exit = std::min(exit, std::max(toMin, toMax));
+	}
+
+	return entry <= exit ? entry : FLT_MAX;
+}
+
+static void benchmarkHierarchy(const std::vector<glm::vec4> &spheres, const Options &options, ThreadPool &threadPool, bool &valid){
+	const uint32_t count = static_cast<uint32_t>(spheres.size());
+	std::vector<glm::vec3> mins(count);
+	std::vector<glm::vec3> maxs(count);
+
+	for (uint32_t i=0; i<count; i++){
+		mins[i] = glm::vec3(spheres[i]) - spheres[i].w;
+		maxs[i] = glm::vec3(spheres[i]) + spheres[i].w;
+	}
+
+	BoundingVolumeHierarchy hierarchy;
+	hierarchy.reserve(count);
+	for (uint32_t i=0; i<count; i++)
+		hierarchy.add(mins[i], maxs[i]);
+
+	// the build on the calling thread then on the thread pool
+	auto start = std::chrono::steady_clock::now();
+	hierarchy.build();
+	printTime("bvh build", "single", Milliseconds(std::chrono::steady_clock::now() - start).count());
+	std::cout << std::setw(12) << hierarchy.getNodes().size() << " nodes" << std::endl;
+
+	hierarchy.setThreadPool(threadPool);
+	start = std::chrono::steady_clock::now();
+	hierarchy.build();
+	printTime("bvh build", "threaded", Milliseconds(std::chrono::steady_clock::now() - start).count());
+	std::cout << std::setw(12) << std::setprecision(2) << hierarchy.getCost() << " cost" << std::endl;
+
+	// move a part of the objects by a few units, the partial refit is under BRANCH_REFIT_RATIO
+	std::mt19937 random(7);
+	std::uniform_real_distribution<float> offset(-2.f, 2.f);
+
+	for (uint32_t percent : {1U, 100U}){
+		const uint32_t moved = std::max(1U, static_cast<uint32_t>(static_cast<uint64_t>(count) * percent / 100));
+
+		for (uint32_t i=0; i<moved; i++){
+			const uint32_t object = percent == 100 ? i : static_cast<uint32_t>(random() % count);
+			const glm::vec3 move(offset(random), offset(random), offset(random));
+
+			mins[object] += move;
+			maxs[object] += move;
+			hierarchy.set(object, mins[object], maxs[object]);
+		}
+
+		start = std::chrono::steady_clock::now();
+		hierarchy.refit();
+		printTime("bvh refit", std::to_string(percent) + "%", Milliseconds(std::chrono::steady_clock::now() - start).count());
+		std::cout << std::setw(12) << std::setprecision(2) << hierarchy.getCost() << " cost" << std::endl;
+	}
+
+	// the culls
+	Milliseconds time{0};
+	size_t visible = 0;
+	uint32_t mismatches = 0;
+	std::vector<uint32_t> result;
+
+	for (uint32_t i=0; i<options.iterations; i++){
+		const Frustum frustum = Frustum::fromMatrix(getViewProjection(i, options.iterations));
+
+		start = std::chrono::steady_clock::now();
+		hierarchy.cull(frustum, result);
+		time += std::chrono::steady_clock::now() - start;
+
+		visible += result.size();
+		std::sort(result.begin(), result.end());
+		if (result != cullBoxes(mins, maxs, frustum)) mismatches++;
+	}
+
+	printTime("bvh cull", "single", time.count() / options.iterations);
+	std::cout << std::setw(12) << visible / options.iterations << " visible";
+	printMismatches(mismatches, valid);
+
+	// the picking rays from the center, checked against every box for the first ones
+	constexpr uint32_t RAY_COUNT = 1000;
+	constexpr uint32_t CHECKED_RAYS = 20;
+	std::normal_distribution<float> axis(0.f, 1.f);
+
+	time = Milliseconds{0};
+	mismatches = 0;
+
+	for (uint32_t i=0; i<RAY_COUNT; i++){
+		const glm::vec3 origin(0.f);
+		const glm::vec3 direction = glm::normalize(glm::vec3(axis(random), axis(random), axis(random)));
+
+		start = std::chrono::steady_clock::now();
+		const BoundingVolumeHierarchy::Hit hit = hierarchy.raycast(origin, direction);
+		time += std::chrono::steady_clock::now() - start;
+
+		if (i >= CHECKED_RAYS) continue;
+
+		float nearest = FLT_MAX;
+		for (uint32_t object=0; object<count; object++)
+			nearest = std::min(nearest, intersectBox(mins[object], maxs[object], origin, direction));
+
+		if (std::abs(hit.distance - nearest) > 1e-3f * std::max(1.f, nearest)) mismatches++;
+	}
+
+	printTime("bvh raycast", "single", time.count() / RAY_COUNT);
+
+	// the axis aligned rays from the corner of an object, its origin is on the slab planes of the parallel axes
+	for (uint32_t i=0; i<CHECKED_RAYS; i++){
+		const uint32_t object = static_cast<uint32_t>(random() % count);
+		const glm::vec3 origin = mins[object];
+		glm::vec3 direction(0.f);
+		direction[i % 3] = i % 2 == 0 ? 1.f : -1.f;
+
+		const BoundingVolumeHierarchy::Hit hit = hierarchy.raycast(origin, direction);
+
+		float nearest = FLT_MAX;
+		for (uint32_t other=0; other<count; other++)
+			nearest = std::min(nearest, intersectBox(mins[other], maxs[other], origin, direction));
+
+		if (hit.distance != nearest || nearest != 0.f) mismatches++;
+	}
+
+	printMismatches(mismatches, valid);
+
+	// the box queries around random objects
+	constexpr uint32_t BOX_COUNT = 1000;
+	time = Milliseconds{0};
+	mismatches = 0;
+	size_t overlapping = 0;
+
+	for (uint32_t i=0; i<BOX_COUNT; i++){
+		const uint32_t object = static_cast<uint32_t>(random() % count);
+		const glm::vec3 min = mins[object] - 10.f;
+		const glm::vec3 max = maxs[object] + 10.f;
+
+		start = std::chrono::steady_clock::now();
+		hierarchy.overlap(min, max, result);
+		time += std::chrono::steady_clock::now() - start;
+
+		overlapping += result.size();
+		std::sort(result.begin(), result.end());
+		if (result != overlapBoxes(mins, maxs, min, max)) mismatches++;
+	}
+
+	printTime("bvh overlap", "single", time.count() / BOX_COUNT);
+	std::cout << std::setw(12) << overlapping / BOX_COUNT << " found";
+	printMismatches(mismatches, valid);
+}
+
+int main(int argc, char **argv){
+	try {
+		Options options = parseArguments(argc, argv);
+		ThreadPool threadPool(options.threads);
+		bool valid = true;
+
+		for (uint32_t count : options.counts){
+			std::cout << count << " objects, " << options.iterations << " iterations, " << threadPool.getThreadCount() << " workers" << std::endl;
+
+			const std::vector<glm::vec4> spheres = generateSpheres(count);
+			benchmarkLinear(spheres, options, threadPool, valid);
+			benchmarkHierarchy(spheres, options, threadPool, valid);
+			std::cout << std::endl;
+		}
+
+		if (!valid)
+			throw std::runtime_error("the results differ from the reference");
+
+	} catch (const std::exception &e){
+		std::cerr << e.what() << std::endl;
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
\ No newline at end of file
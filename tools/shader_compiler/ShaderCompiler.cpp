@@ -0,0 +1,304 @@
+// shader_compiler - expand the includes and the permutations of the shaders of a directory, compile every variant and pack them into a ShaderArchive
+//
+// usage : shader_compiler [options] <shader directory>
+//     --output <file>      the archive to write, default shaders.pak
+//     --compiler <path>    the offline compiler, default glslc
+//     --flags <flags>      extra flags given to the compiler, default -O
+//     --temp <directory>   the directory of the intermediate files, default the system temporary directory
+//     -D<NAME>             a define added to every variant
+//
+// the permutations are declared in the shaders with one line per group of keywords :
+//     #pragma keywords SKINNING              -> without and with SKINNING
+//     #pragma keywords _ LOW_QUALITY HIGH_QUALITY  -> one keyword of the group, '_' for none
+// every combination of the groups is compiled, the enabled keywords are given to the compiler as defines
+
+#define STB_INCLUDE_IMPLEMENTATION
+#define STB_INCLUDE_LINE_GLSL
+#include <stb/stb_include.h>
+
+#include "engine/ShaderArchive.hpp"
+
+// std
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <map>
+#include <cstdlib>
+#include <cstring>
+
+namespace fs = std::filesystem;
+using vk_engine::ShaderArchive;
+
+struct Options{
+	fs::path directory;
+	fs::path output = "shaders.pak";
+	fs::path temp = fs::temp_directory_path();
+	std::string compiler = "glslc";
+	std::string flags = "-O";
+	std::vector<std::string> defines;
+};
+
+struct Variant{
+	std::string name;
+	std::vector<char> code;
+};
+
+static const std::map<std::string, std::string> STAGES = {
+	{".vert", "vertex"},
+	{".frag", "fragment"},
+	{".comp", "compute"},
+	{".geom", "geometry"},
+	{".tesc", "tesscontrol"},
+	{".tese", "tesseval"}
+};
+
+static std::string readText(const fs::path &path){
+	std::ifstream file(path, std::ios::binary);
+	if (!file.is_open())
+		throw std::runtime_error("failed to open : " + path.string());
+
+	std::stringstream stream;
+	stream << file.rdbuf();
+	return stream.str();
+}
+
+static std::vector<char> readBinary(const fs::path &path){
+	std::ifstream file(path, std::ios::ate | std::ios::binary);
+	if (!file.is_open())
+		throw std::runtime_error("failed to open : " + path.string());
+
+	std::vector<char> data(static_cast<size_t>(file.tellg()));
+	file.seekg(0);
+	file.read(data.data(), data.size());
+	return data;
+}
+
+// remove the keywords declarations, keeping the line count
+static std::string parseKeywords(const std::string &source, std::vector<std::vector<std::string>> &groups){
+	std::istringstream stream(source);
+	std::string result, line;
+
+	while (std::getline(stream, line)){
+		std::istringstream words(line);
+		std::string hash, pragma, keyword;
+		words >> hash;
+
+		if (hash == "#pragma" && (words >> pragma) && pragma == "keywords"){
+			std::vector<std::string> group;
+			while (words >> keyword) group.push_back(keyword);
+
+			// a single keyword is a toggle
+			if (group.size() == 1) group.insert(group.begin(), "_");
+			if (!group.empty()) groups.push_back(group);
+
+			result += "\n";
+			continue;
+		}
+
+		result += line + "\n";
+	}
+	return result;
+}
+
+static void enumerate(const std::vector<std::vector<std::string>> &groups, size_t index, std::vector<std::string> &keywords, std::vector<std::vector<std::string>> &variants){
+	if (index == groups.size()){
+		variants.push_back(keywords);
+		return;
+	}
+
+	for (const auto &keyword : groups[index]){
+		if (keyword != "_") keywords.push_back(keyword);
+		enumerate(groups, index + 1, keywords, variants);
+		if (keyword != "_") keywords.pop_back();
+	}
+}
+
+static std::string quote(const std::string &str){
+	return "\"" + str + "\"";
+}
+
+static std::vector<char> compile(const Options &options, const fs::path &source, const std::string &stage, const std::string &text, const std::string &defines, const std::string &variantName){
+	std::string tempName = "vk_engine_" + std::to_string(ShaderArchive::getKey(variantName));
+	fs::path tempSource = options.temp / (tempName + ".glsl");
+	fs::path tempOutput = options.temp / (tempName + ".spv");
+
+	{
+		std::ofstream file(tempSource, std::ios::binary | std::ios::trunc);
+		if (!file.is_open())
+			throw std::runtime_error("failed to open : " + tempSource.string());
+		file << text;
+	}
+
+	std::string command = quote(options.compiler) + " -fshader-stage=" + stage + " " + options.flags + defines + " -o " + quote(tempOutput.string()) + " " + quote(tempSource.string());
+
+	#ifdef _WIN32
+		// cmd.exe removes the first and the last quotes of the command
+		command = quote(command);
+	#endif
+
+	if (std::system(command.c_str()) != 0)
+		throw std::runtime_error("failed to compile " + variantName + " (" + source.string() + ")");
+
+	std::vector<char> code = readBinary(tempOutput);
+
+	fs::remove(tempSource);
+	fs::remove(tempOutput);
+
+	if (code.size() < 4 || code.size() % 4 != 0)
+		throw std::runtime_error("the compiler produced an invalid SPIR-V file for " + variantName);
+
+	return code;
+}
+
+static void compileShader(const Options &options, const fs::path &path, const std::string &stage, std::vector<Variant> &variants){
+	std::vector<std::vector<std::string>> groups;
+	std::string source = parseKeywords(readText(path), groups);
+	std::string name = fs::relative(path, options.directory).generic_string();
+
+	std::vector<std::vector<std::string>> permutations;
+	std::vector<std::string> keywords;
+	enumerate(groups, 0, keywords, permutations);
+
+	for (const auto &permutation : permutations){
+		std::string defines;
+		for (const auto &define : options.defines) defines += " -D" + define + "=1";
+		for (const auto &keyword : permutation) defines += " -D" + keyword + "=1";
+
+		// stb_include takes mutable strings
+		std::vector<char> sourceBuffer(source.begin(), source.end());
+		sourceBuffer.push_back('\0');
+		std::string includePath = path.parent_path().string();
+		std::vector<char> includeBuffer(includePath.begin(), includePath.end());
+		includeBuffer.push_back('\0');
+		std::string filename = path.filename().string();
+		std::vector<char> filenameBuffer(filename.begin(), filename.end());
+		filenameBuffer.push_back('\0');
+
+		char error[256] = {};
+		char *expanded = stb_include_string(sourceBuffer.data(), nullptr, includeBuffer.data(), filenameBuffer.data(), error);
+		if (!expanded)
+			throw std::runtime_error(path.string() + " : " + error);
+
+		std::string text = expanded;
+		free(expanded);
+
+		Variant variant;
+		variant.name = ShaderArchive::getVariantName(name, permutation);
+		variant.code = compile(options, path, stage, text, defines, variant.name);
+
+		std::cout << "compiled " << variant.name << " (" << variant.code.size() << " bytes)" << std::endl;
+		variants.push_back(std::move(variant));
+	}
+}
+
+static void writeArchive(const fs::path &output, const std::vector<Variant> &variants){
+	// at most half full, the probes stay short
+	uint32_t slotCount = 1;
+	while (slotCount < variants.size() * 2) slotCount *= 2;
+
+	std::vector<ShaderArchive::Slot> slots(slotCount, ShaderArchive::Slot{0, 0, 0});
+
+	size_t offset = sizeof(ShaderArchive::Header) + slotCount * sizeof(ShaderArchive::Slot);
+	auto align = [](size_t value){return (value + ShaderArchive::CODE_ALIGNMENT - 1) / ShaderArchive::CODE_ALIGNMENT * ShaderArchive::CODE_ALIGNMENT;};
+
+	std::vector<size_t> offsets;
+	for (const auto &variant : variants){
+		offset = align(offset);
+		offsets.push_back(offset);
+
+		uint64_t key = ShaderArchive::getKey(variant.name);
+		uint32_t i = static_cast<uint32_t>(key) & (slotCount - 1);
+
+		while (slots[i].key != 0){
+			if (slots[i].key == key)
+				throw std::runtime_error("hash collision on the variant " + variant.name);
+			i = (i + 1) & (slotCount - 1);
+		}
+
+		slots[i].key = key;
+		slots[i].offset = static_cast<uint32_t>(offset);
+		slots[i].size = static_cast<uint32_t>(variant.code.size());
+		offset += variant.code.size();
+	}
+
+	ShaderArchive::Header header;
+	header.magic = ShaderArchive::MAGIC;
+	header.version = ShaderArchive::ARCHIVE_VERSION;
+	header.entryCount = static_cast<uint32_t>(variants.size());
+	header.slotCount = slotCount;
+
+	std::vector<char> data(offset, 0);
+	memcpy(data.data(), &header, sizeof(header));
+	memcpy(data.data() + sizeof(header), slots.data(), slots.size() * sizeof(ShaderArchive::Slot));
+
+	for (size_t i=0; i<variants.size(); i++)
+		memcpy(data.data() + offsets[i], variants[i].code.data(), variants[i].code.size());
+
+	std::ofstream file(output, std::ios::binary | std::ios::trunc);
+	if (!file.is_open())
+		throw std::runtime_error("failed to open : " + output.string());
+
+	file.write(data.data(), data.size());
+}
+
+static Options parseArguments(int argc, char **argv){
+	Options options;
+
+	for (int i=1; i<argc; i++){
+		std::string arg = argv[i];
+
+		auto next = [&](){
+			if (i + 1 >= argc) throw std::runtime_error("missing value after " + arg);
+			return std::string(argv[++i]);
+		};
+
+		if (arg == "--output"){
+			options.output = next();
+		} else if (arg == "--compiler"){
+			options.compiler = next();
+		} else if (arg == "--flags"){
+			options.flags = next();
+		} else if (arg == "--temp"){
+			options.temp = next();
+		} else if (arg.rfind("-D", 0) == 0 && arg.size() > 2){
+			options.defines.push_back(arg.substr(2));
+		} else if (options.directory.empty()){
+			options.directory = arg;
+		} else {
+			throw std::runtime_error("unknown argument : " + arg);
+		}
+	}
+
+	if (options.directory.empty())
+		throw std::runtime_error("usage : shader_compiler [--output file] [--compiler path] [--flags flags] [--temp directory] [-DNAME] <shader directory>");
+
+	return options;
+}
+
+int main(int argc, char **argv){
+	try {
+		Options options = parseArguments(argc, argv);
+		std::vector<Variant> variants;
+
+		for (const auto &entry : fs::recursive_directory_iterator(options.directory)){
+			if (!entry.is_regular_file()) continue;
+
+			auto stage = STAGES.find(entry.path().extension().string());
+			if (stage == STAGES.end()) continue;
+
+			compileShader(options, entry.path(), stage->second, variants);
+		}
+
+		writeArchive(options.output, variants);
+		std::cout << variants.size() << " variants written to " << options.output.string() << std::endl;
+
+	} catch (const std::exception &e){
+		std::cerr << e.what() << std::endl;
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
\ No newline at end of file